@@ -207,6 +207,15 @@ static void uzlib_prepare(struct uzlib_uncomp *decomp, uint8_t *window,
   uzlib_uncompress_init(decomp, window, window ? UZLIB_WINDOW_SIZE : 0);
 }
 
+// Inflates the next len bytes of the stream into dest. Returns false if the
+// stream ends before that or is corrupted.
+static bool uzlib_fill(struct uzlib_uncomp *decomp, uint8_t *dest,
+                       uint32_t len) {
+  decomp->dest = dest;
+  decomp->dest_limit = dest + len;
+  return uzlib_uncompress(decomp) == TINF_OK;
+}
+
 void display_text_render_buffer(const char *text, int textlen, int font,
                                 buffer_text_t *buffer, int text_offset) {
   // determine text length if not provided
@@ -286,21 +295,30 @@ void display_image(int x, int y, int w, int h, const void *data,
 
   struct uzlib_uncomp decomp = {0};
   uint8_t decomp_window[UZLIB_WINDOW_SIZE] = {0};
-  uint8_t decomp_out[2] = {0};
-  uzlib_prepare(&decomp, decomp_window, data, datalen, decomp_out,
-                sizeof(decomp_out));
+  uint8_t row[LINE_BUFFER_16BPP_SIZE] = {0};
+  const int row_pixels = sizeof(row) / 2;
+  uzlib_prepare(&decomp, decomp_window, data, datalen, row, sizeof(row));
 
   PIXELDATA_DIRTY();
-  for (uint32_t pos = 0; pos < w * h; pos++) {
-    int st = uzlib_uncompress(&decomp);
-    if (st == TINF_DONE) break;  // all OK
-    if (st < 0) break;           // error
-    const int px = pos % w;
-    const int py = pos / w;
-    if (px >= x0 && px <= x1 && py >= y0 && py <= y1) {
-      PIXELDATA((decomp_out[1] << 8) | decomp_out[0]);
+  if (x1 < x0) {
+    return;
+  }
+  // Rows are inflated a buffer at a time; the ones above the window are only
+  // inflated, and the ones below it are not inflated at all.
+  for (int py = 0; py <= y1; py++) {
+    for (int px = 0; px < w; px += row_pixels) {
+      const int n = MIN(w - px, row_pixels);
+      if (!uzlib_fill(&decomp, row, n * 2)) {
+        return;
+      }
+      if (py < y0) {
+        continue;
+      }
+      const int end = MIN(x1 - px, n - 1);
+      for (int i = MAX(x0 - px, 0); i <= end; i++) {
+        PIXELDATA((row[2 * i + 1] << 8) | row[2 * i]);
+      }
     }
-    decomp.dest = (uint8_t *)&decomp_out;
   }
 #endif
 }
@@ -325,17 +343,23 @@ void display_image(int x, int y, int w, int h, const void *data,
 
   uzlib_prepare(&decomp, decomp_window, data, datalen, b1, w * 2);
 
+  if (x1 < x0) {
+    return;
+  }
+
   dma2d_setup_16bpp();
 
-  for (int32_t pos = 0; pos < h; pos++) {
-    int32_t pixels = w;
+  for (int32_t pos = 0; pos <= y1; pos++) {
     line_buffer_16bpp_t *next_buf = (pos % 2 == 1) ? b1 : b2;
-    decomp.dest = next_buf->buffer;
-    decomp.dest_limit = next_buf->buffer + w * 2;
-    int st = uzlib_uncompress(&decomp);
-    if (st < 0) break;  // error
+    if (!uzlib_fill(&decomp, next_buf->buffer, w * 2)) {
+      break;
+    }
+    if (pos < y0) {
+      continue;
+    }
     dma2d_wait_for_transfer();
-    dma2d_start(next_buf->buffer, (uint8_t *)DISPLAY_DATA_ADDRESS, pixels);
+    dma2d_start(next_buf->buffer + x0 * 2, (uint8_t *)DISPLAY_DATA_ADDRESS,
+                x1 - x0 + 1);
   }
   dma2d_wait_for_transfer();
 }
@@ -412,6 +436,7 @@ void display_icon(int x, int y, int w, int h, const void *data,
   x += DISPLAY_OFFSET.x;
   y += DISPLAY_OFFSET.y;
   x &= ~1;  // cannot draw at odd coordinate
+  w &= ~1;  // cannot draw odd-wide icons
   int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
   clamp_coords(x, y, w, h, &x0, &y0, &x1, &y1);
   display_set_window(x0, y0, x1, y1);
@@ -425,21 +450,28 @@ void display_icon(int x, int y, int w, int h, const void *data,
 
   struct uzlib_uncomp decomp = {0};
   uint8_t decomp_window[UZLIB_WINDOW_SIZE] = {0};
-  uint8_t decomp_out = 0;
-  uzlib_prepare(&decomp, decomp_window, data, datalen, &decomp_out,
-                sizeof(decomp_out));
-
-  for (uint32_t pos = 0; pos < w * h / 2; pos++) {
-    int st = uzlib_uncompress(&decomp);
-    if (st == TINF_DONE) break;  // all OK
-    if (st < 0) break;           // error
-    const int px = (pos * 2) % w;
-    const int py = (pos * 2) / w;
-    if (px >= x0 && px <= x1 && py >= y0 && py <= y1) {
-      PIXELDATA(colortable[decomp_out & 0x0F]);
-      PIXELDATA(colortable[decomp_out >> 4]);
+  uint8_t row[LINE_BUFFER_4BPP_SIZE] = {0};
+  const int row_bytes = w / 2;
+  uzlib_prepare(&decomp, decomp_window, data, datalen, row, sizeof(row));
+
+  // Two pixels per byte; x and w are even, so the window starts and ends on
+  // byte boundaries
+  for (int py = 0; py <= y1 && x0 <= x1; py++) {
+    for (int bx = 0; bx < row_bytes; bx += sizeof(row)) {
+      const int n = MIN(row_bytes - bx, (int)sizeof(row));
+      if (!uzlib_fill(&decomp, row, n)) {
+        PIXELDATA_DIRTY();
+        return;
+      }
+      if (py < y0) {
+        continue;
+      }
+      const int end = MIN(x1 / 2 - bx, n - 1);
+      for (int i = MAX(x0 / 2 - bx, 0); i <= end; i++) {
+        PIXELDATA(colortable[row[i] & 0x0F]);
+        PIXELDATA(colortable[row[i] >> 4]);
+      }
     }
-    decomp.dest = (uint8_t *)&decomp_out;
   }
   PIXELDATA_DIRTY();
 }
@@ -476,7 +508,7 @@ void display_icon(int x, int y, int w, int h, const void *data,
 
   int off_x = x < 0 ? -x : 0;
 
-  for (uint32_t pos = 0; pos < h; pos++) {
+  for (int pos = 0; pos <= y1; pos++) {
     line_buffer_4bpp_t *next_buf = (pos % 2 == 0) ? b1 : b2;
     decomp.dest = b;
     decomp.dest_limit = b + w / 2;
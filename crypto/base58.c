@@ -40,11 +40,14 @@ const int8_t b58digits_map[] = {
     49, 50, 51, 52, 53, 54, 55, 56, 57, -1, -1, -1, -1, -1,
 };
 
-typedef uint64_t b58_maxint_t;
-typedef uint32_t b58_almostmaxint_t;
-#define b58_almostmaxint_bits (sizeof(b58_almostmaxint_t) * 8)
-static const b58_almostmaxint_t b58_almostmaxint_mask =
-    ((((b58_maxint_t)1) << b58_almostmaxint_bits) - 1);
+// Both conversions work on 32-bit limbs. b58tobin() accumulates the number in
+// limbs of 2^32, five digits at a time, and b58enc() in limbs of 58^5, the
+// largest power of 58 below 2^32, four bytes at a time. Compared to going
+// digit by digit or byte by byte, this makes far fewer passes over the number.
+#define B58_POW5 656356768U  // 58^5
+#define B58_BIN_LIMBS ((B58_MAX_BINSZ + 3) / 4)
+// 58^5 > 2^29, so 29 bits per limb of 58^5 are a safe estimate.
+#define B58_ENC_LIMBS (B58_MAX_BINSZ * 8 / 29 + 1)
 
 // Decodes a null-terminated Base58 string `b58` to binary and writes the result
 // at the end of the buffer `bin` of size `*binszp`. On success `*binszp` is set
@@ -58,72 +61,62 @@ bool b58tobin(void *bin, size_t *binszp, const char *b58) {
 
   const unsigned char *b58u = (const unsigned char *)b58;
   unsigned char *binu = bin;
-  size_t outisz =
-      (binsz + sizeof(b58_almostmaxint_t) - 1) / sizeof(b58_almostmaxint_t);
-  b58_almostmaxint_t outi[outisz];
-  b58_maxint_t t = 0;
-  b58_almostmaxint_t c = 0;
-  size_t i = 0, j = 0;
-  uint8_t bytesleft = binsz % sizeof(b58_almostmaxint_t);
-  b58_almostmaxint_t zeromask =
-      bytesleft ? (b58_almostmaxint_mask << (bytesleft * 8)) : 0;
+  uint32_t limbs[B58_BIN_LIMBS] = {0};  // little-endian
+  size_t used = 0;
+  size_t i = 0;
   unsigned zerocount = 0;
 
   size_t b58sz = strlen(b58);
 
-  memzero(outi, sizeof(outi));
-
   // Leading zeros, just count
   for (i = 0; i < b58sz && b58u[i] == '1'; ++i) ++zerocount;
 
-  for (; i < b58sz; ++i) {
-    if (b58u[i] & 0x80)
-      // High-bit set on invalid digit
-      return false;
-    if (b58digits_map[b58u[i]] == -1)
-      // Invalid base58 digit
-      return false;
-    c = (unsigned)b58digits_map[b58u[i]];
-    for (j = outisz; j--;) {
-      t = ((b58_maxint_t)outi[j]) * 58 + c;
-      c = t >> b58_almostmaxint_bits;
-      outi[j] = t & b58_almostmaxint_mask;
+  while (i < b58sz) {
+    uint32_t chunk = 0;
+    uint32_t mul = 1;
+    for (size_t k = 0; k < 5 && i < b58sz; ++k, ++i) {
+      if ((b58u[i] & 0x80) || b58digits_map[b58u[i]] == -1) {
+        // Invalid base58 digit
+        memzero(limbs, sizeof(limbs));
+        return false;
+      }
+      chunk = chunk * 58 + (uint32_t)b58digits_map[b58u[i]];
+      mul *= 58;
     }
-    if (c)
-      // Output number too big (carry to the next int32)
-      return false;
-    if (outi[0] & zeromask)
-      // Output number too big (last int32 filled too far)
-      return false;
-  }
 
-  j = 0;
-  if (bytesleft) {
-    for (i = bytesleft; i > 0; --i) {
-      *(binu++) = (outi[0] >> (8 * (i - 1))) & 0xff;
+    uint64_t carry = chunk;
+    for (size_t j = 0; j < used; ++j) {
+      uint64_t t = (uint64_t)limbs[j] * mul + carry;
+      limbs[j] = (uint32_t)t;
+      carry = t >> 32;
     }
-    ++j;
-  }
-
-  for (; j < outisz; ++j) {
-    for (i = sizeof(*outi); i > 0; --i) {
-      *(binu++) = (outi[j] >> (8 * (i - 1))) & 0xff;
+    if (carry) {
+      if (used == B58_BIN_LIMBS) {
+        // Output number too big
+        memzero(limbs, sizeof(limbs));
+        return false;
+      }
+      limbs[used++] = (uint32_t)carry;
     }
   }
 
   // locate the most significant byte
-  binu = bin;
-  for (i = 0; i < binsz; ++i) {
-    if (binu[i]) break;
-  }
+  size_t len = used ? 4 * (used - 1) : 0;
+  for (uint32_t top = used ? limbs[used - 1] : 0; top; top >>= 8) ++len;
 
-  // prepend the correct number of null-bytes
-  if (zerocount > i) {
-    /* result too large */
+  // the number has to fit along with the correct number of null-bytes
+  if (len > binsz || zerocount > binsz - len) {
+    memzero(limbs, sizeof(limbs));
     return false;
   }
-  *binszp = binsz - i + zerocount;
 
+  memset(binu, 0, binsz - len);
+  for (size_t k = 0; k < len; ++k) {
+    binu[binsz - 1 - k] = limbs[k / 4] >> (8 * (k % 4));
+  }
+  *binszp = len + zerocount;
+
+  memzero(limbs, sizeof(limbs));
   return true;
 }
 
@@ -147,41 +140,57 @@ int b58check(const void *bin, size_t binsz, HasherType hasher_type,
 
 bool b58enc(char *b58, size_t *b58sz, const void *data, size_t binsz) {
   const uint8_t *bin = data;
-  int carry = 0;
-  size_t i = 0, j = 0, high = 0, zcount = 0;
-  size_t size = 0;
+  size_t i = 0, j = 0, zcount = 0;
 
   while (zcount < binsz && !bin[zcount]) ++zcount;
 
-  size = (binsz - zcount) * 138 / 100 + 1;
-  uint8_t buf[size];
-  memzero(buf, size);
-
-  for (i = zcount, high = size - 1; i < binsz; ++i, high = j) {
-    for (carry = bin[i], j = size - 1; (j > high) || carry; --j) {
-      carry += 256 * buf[j];
-      buf[j] = carry % 58;
-      carry /= 58;
-      if (!j) {
-        // Otherwise j wraps to maxint which is > high
-        break;
-      }
+  if (binsz - zcount > B58_MAX_BINSZ) {
+    return false;
+  }
+
+  uint32_t limbs[B58_ENC_LIMBS] = {0};  // little-endian
+  size_t used = 0;
+
+  for (i = zcount; i < binsz;) {
+    // The first word takes the bytes which do not make up a whole one.
+    size_t n = (binsz - i) % 4 ? (binsz - i) % 4 : 4;
+    uint64_t carry = 0;
+    for (size_t k = 0; k < n; ++k) {
+      carry = (carry << 8) | bin[i++];
+    }
+    for (j = 0; j < used; ++j) {
+      uint64_t t = ((uint64_t)limbs[j] << (8 * n)) + carry;
+      limbs[j] = t % B58_POW5;
+      carry = t / B58_POW5;
+    }
+    while (carry) {
+      limbs[used++] = carry % B58_POW5;
+      carry /= B58_POW5;
     }
   }
 
-  for (j = 0; j < size && !buf[j]; ++j)
-    ;
+  // All limbs but the most significant one make five digits.
+  size_t digits = used ? 5 * (used - 1) : 0;
+  for (uint32_t top = used ? limbs[used - 1] : 0; top; top /= 58) ++digits;
 
-  if (*b58sz <= zcount + size - j) {
-    *b58sz = zcount + size - j + 1;
+  if (*b58sz <= zcount + digits) {
+    *b58sz = zcount + digits + 1;
+    memzero(limbs, sizeof(limbs));
     return false;
   }
 
   if (zcount) memset(b58, '1', zcount);
-  for (i = zcount; j < size; ++i, ++j) b58[i] = b58digits_ordered[buf[j]];
-  b58[i] = '\0';
-  *b58sz = i + 1;
+  char *p = b58 + zcount + digits;
+  *p = '\0';
+  for (j = 0; j < used; ++j) {
+    uint32_t limb = limbs[j];
+    for (int k = 0; k < 5 && p > b58 + zcount; ++k, limb /= 58) {
+      *--p = b58digits_ordered[limb % 58];
+    }
+  }
+  *b58sz = zcount + digits + 1;
 
+  memzero(limbs, sizeof(limbs));
   return true;
 }
 
@@ -39,6 +39,9 @@ int base58_decode_check(const char *str, HasherType hasher_type, uint8_t *data,
 int base58_encode(const uint8_t *data, int len, char *str, int strsize);
 
 // Private
+// b58tobin() and b58enc() handle numbers of up to B58_MAX_BINSZ bytes, not
+// counting leading zero bytes.
+#define B58_MAX_BINSZ 256
 bool b58tobin(void *bin, size_t *binszp, const char *b58);
 int b58check(const void *bin, size_t binsz, HasherType hasher_type,
              const char *base58str);
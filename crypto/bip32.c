@@ -246,6 +246,7 @@ int hdnode_public_ckd_cp(const ecdsa_curve *curve, const curve_point *parent,
 }
 
 int hdnode_public_ckd(HDNode *inout, uint32_t i) {
+  CRYPTO_PROFILE_SCOPE(PROFILE_ECC);
   curve_point parent = {0}, child = {0};
 
   if (!ecdsa_read_pubkey(inout->curve->params, inout->public_key, &parent)) {
@@ -877,6 +878,7 @@ int hdnode_private_ckd_bip32(HDNode *inout, uint32_t i) {
 }
 
 int hdnode_private_ckd(HDNode *inout, uint32_t i) {
+  CRYPTO_PROFILE_SCOPE(PROFILE_ECC);
 #if USE_CARDANO
   if (inout->curve == &ed25519_cardano_info ||
       inout->curve == &ed25519_polkadot_info) {
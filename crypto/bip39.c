@@ -251,14 +251,92 @@ int mnemonic_find_word(const char *word) {
   return -1;
 }
 
-const char *mnemonic_complete_word(const char *prefix, int len) {
-  // we need to perform linear search,
-  // because we want to return the first match
-  for (int i = 0; i < BIP39_WORD_COUNT; i++) {
-    if (strncmp(BIP39_WORDLIST_ENGLISH[i], prefix, len) == 0) {
-      return BIP39_WORDLIST_ENGLISH[i];
+// The wordlist is sorted, so the words starting with a prefix form a range.
+// It is narrowed to the block of the first letter and then found by binary
+// search, so each lookup costs O(len * log(BIP39_WORD_COUNT)).
+static void mnemonic_prefix_range(const char *prefix, int len, int *first,
+                                  int *last) {
+  int lo = 0, hi = BIP39_WORD_COUNT;
+  if (len <= 0) {
+    *first = lo;
+    *last = hi;
+    return;
+  }
+  if (prefix[0] < 'a' || prefix[0] > 'z') {
+    *first = *last = 0;
+    return;
+  }
+  lo = wordlist_letters_offset[prefix[0] - 'a'];
+  hi = wordlist_letters_offset[prefix[0] - 'a' + 1];
+
+  // first word not below the prefix
+  int l = lo, h = hi;
+  while (l < h) {
+    int mid = l + (h - l) / 2;
+    if (strncmp(BIP39_WORDLIST_ENGLISH[mid], prefix, len) < 0) {
+      l = mid + 1;
+    } else {
+      h = mid;
     }
   }
+  *first = l;
+
+  // first word above the prefix
+  h = hi;
+  while (l < h) {
+    int mid = l + (h - l) / 2;
+    if (strncmp(BIP39_WORDLIST_ENGLISH[mid], prefix, len) <= 0) {
+      l = mid + 1;
+    } else {
+      h = mid;
+    }
+  }
+  *last = l;
+}
+
+// Returns the first word in [lo, hi) whose letter at pos is above c. The
+// words in the range share their first pos letters, so the letters at pos
+// are sorted.
+static int mnemonic_letter_bound(int lo, int hi, int pos, char c) {
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (BIP39_WORDLIST_ENGLISH[mid][pos] <= c) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+// Stores the distinct letters following the prefix in order and returns
+// their count. Each letter skips over its whole range, rather than over
+// every word.
+static int mnemonic_next_letters(const char *prefix, int len,
+                                 char letters[26]) {
+  int first = 0, last = 0;
+  int count = 0;
+  if (len < 0) {
+    len = 0;
+  }
+  mnemonic_prefix_range(prefix, len, &first, &last);
+  while (first < last) {
+    char c = BIP39_WORDLIST_ENGLISH[first][len];
+    if (c >= 'a' && c <= 'z') {
+      letters[count++] = c;
+    }
+    first = mnemonic_letter_bound(first, last, len, c);
+  }
+  return count;
+}
+
+const char *mnemonic_complete_word(const char *prefix, int len) {
+  // the first match is the start of the prefix range
+  int first = 0, last = 0;
+  mnemonic_prefix_range(prefix, len, &first, &last);
+  if (first < last) {
+    return BIP39_WORDLIST_ENGLISH[first];
+  }
   return NULL;
 }
 
@@ -274,41 +352,20 @@ uint32_t mnemonic_word_completion_mask(const char *prefix, int len) {
   if (len <= 0) {
     return 0x3ffffff;  // all letters (bits 1-26 set)
   }
+  char letters[26] = {0};
+  int count = mnemonic_next_letters(prefix, len, letters);
   uint32_t res = 0;
-  for (int i = 0; i < BIP39_WORD_COUNT; i++) {
-    const char *word = BIP39_WORDLIST_ENGLISH[i];
-    if (strncmp(word, prefix, len) == 0 && word[len] >= 'a' &&
-        word[len] <= 'z') {
-      res |= 1 << (word[len] - 'a');
-    }
+  for (int i = 0; i < count; i++) {
+    res |= 1 << (letters[i] - 'a');
   }
   return res;
 }
 
 uint32_t mnemonic_count_with_prefix(char *prefix, uint8_t prefix_len) {
   if (prefix == 0) return 25;
-  uint8_t index = prefix[0] - 'a';
-  uint32_t start = wordlist_letters_offset[index];
-  uint32_t end = wordlist_letters_offset[index + 1];
-  uint32_t count = 0;
-
-  if (prefix_len == 1) {
-    return end - start;
-  } else {
-    for (uint32_t i = 0; i < end - start; i++) {
-      uint32_t j = 0;
-      while (j < strlen(BIP39_WORDLIST_ENGLISH[start + i]) && j < prefix_len &&
-             BIP39_WORDLIST_ENGLISH[start + i][j] == prefix[j]) {
-        j++;
-      }
-      if (j == prefix_len) {
-        count++;
-      } else if (count) {
-        break;
-      }
-    }
-  }
-  return count;
+  int first = 0, last = 0;
+  mnemonic_prefix_range(prefix, prefix_len, &first, &last);
+  return last - first;
 }
 
 uint32_t mnemonic_next_letter_with_prefix(char *prefix, uint8_t prefix_len,
@@ -324,31 +381,12 @@ uint32_t mnemonic_next_letter_with_prefix(char *prefix, uint8_t prefix_len,
     return 25;
   }
 
-  uint8_t index = prefix[0] - 'a';
-  uint32_t start = wordlist_letters_offset[index];
-  uint32_t end = wordlist_letters_offset[index + 1];
-  uint32_t count = 0;
-
-  for (uint32_t i = 0; i < end - start; i++) {
-    uint32_t j = 0;
-    while (j < strlen(BIP39_WORDLIST_ENGLISH[start + i]) && j < prefix_len &&
-           BIP39_WORDLIST_ENGLISH[start + i][j] == prefix[j]) {
-      j++;
-    }
-    if (j == prefix_len) {
-      if (j < strlen(BIP39_WORDLIST_ENGLISH[start + i])) {
-        if (count == 0) {
-          *letters = BIP39_WORDLIST_ENGLISH[start + i][j];
-          count++;
-        } else if (*letters != BIP39_WORDLIST_ENGLISH[start + i][j]) {
-          letters++;
-          *letters++ = 0;
-          *letters = BIP39_WORDLIST_ENGLISH[start + i][j];
-          count++;
-        }
-      }
-    } else if (count) {
-      break;
+  char next[26] = {0};
+  int count = mnemonic_next_letters(prefix, prefix_len, next);
+  for (int i = 0; i < count; i++) {
+    letters[2 * i] = next[i];
+    if (i + 1 < count) {
+      letters[2 * i + 1] = 0;  // insert \x0
     }
   }
   return count;
@@ -357,19 +395,10 @@ uint32_t mnemonic_next_letter_with_prefix(char *prefix, uint8_t prefix_len,
 uint32_t mnemonic_word_index_with_prefix(char *prefix, uint8_t prefix_len) {
   if (prefix_len == 0) return 2048;
 
-  uint8_t index = prefix[0] - 'a';
-  uint32_t start = wordlist_letters_offset[index];
-  uint32_t end = wordlist_letters_offset[index + 1];
-
-  for (uint32_t i = 0; i < end - start; i++) {
-    uint32_t j = 0;
-    while (j < strlen(BIP39_WORDLIST_ENGLISH[start + i]) && j < prefix_len &&
-           BIP39_WORDLIST_ENGLISH[start + i][j] == prefix[j]) {
-      j++;
-    }
-    if (j == prefix_len) {
-      return start + i;
-    }
+  int first = 0, last = 0;
+  mnemonic_prefix_range(prefix, prefix_len, &first, &last);
+  if (first < last) {
+    return first;
   }
   return 2048;
 }
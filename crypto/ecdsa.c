@@ -406,6 +406,7 @@ void point_jacobian_double(jacobian_curve_point *p, const ecdsa_curve *curve) {
 // returns 0 on success
 int point_multiply(const ecdsa_curve *curve, const bignum256 *k,
                    const curve_point *p, curve_point *res) {
+  CRYPTO_PROFILE_SCOPE(PROFILE_ECC);
   // this algorithm is loosely based on
   //  Katsuyuki Okeya and Tsuyoshi Takagi, The Width-w NAF Method Provides
   //  Small Memory and Fast Elliptic Scalar Multiplications Secure against
@@ -536,6 +537,7 @@ int point_multiply(const ecdsa_curve *curve, const bignum256 *k,
 // returns 0 on success
 int scalar_multiply(const ecdsa_curve *curve, const bignum256 *k,
                     curve_point *res) {
+  CRYPTO_PROFILE_SCOPE(PROFILE_ECC);
   if (!bn_is_less(k, &curve->order)) {
     return 1;
   }
@@ -632,6 +634,148 @@ int scalar_multiply(const ecdsa_curve *curve, const bignum256 *k,
 
 #endif
 
+#if USE_ECDSA_SHAMIR
+
+// number of odd multiples (1, 3, ..., 2^(w-1) - 1) precomputed per point
+#define ECDSA_WNAF_TABLE_SIZE (1 << (ECDSA_WNAF_WINDOW - 2))
+
+#if ECDSA_WNAF_WINDOW < 2 || ECDSA_WNAF_WINDOW > 5
+#error ECDSA_WNAF_WINDOW must be between 2 and 5
+#endif
+
+// write k (0 <= k < 2^256) in width-w non-adjacent form:
+// k = sum_{i=0..256} naf[i] 2^i, where every nonzero naf[i] is odd,
+// |naf[i]| < 2^(w-1) and any w consecutive digits contain at most one
+// nonzero digit.  This runs in variable time; k must not be secret.
+static void wnaf_encode(const bignum256 *k, int8_t naf[257]) {
+  uint8_t bytes[32] = {0};
+  int bit = 0, carry = 0;
+
+  bn_write_le(k, bytes);
+  memzero(naf, 257);
+  while (bit < 256) {
+    if (((bytes[bit >> 3] >> (bit & 7)) & 1) == carry) {
+      bit++;
+      continue;
+    }
+    int now = ECDSA_WNAF_WINDOW;
+    if (now > 256 - bit) {
+      now = 256 - bit;
+    }
+    int word = carry;
+    for (int i = 0; i < now; i++) {
+      word += ((bytes[(bit + i) >> 3] >> ((bit + i) & 7)) & 1) << i;
+    }
+    carry = (word >> (ECDSA_WNAF_WINDOW - 1)) & 1;
+    naf[bit] = word - (carry << ECDSA_WNAF_WINDOW);
+    bit += now;
+  }
+  naf[256] = carry;
+}
+
+// table[i] = (2*i+1) * p
+static void wnaf_precompute(const ecdsa_curve *curve, const curve_point *p,
+                            curve_point table[ECDSA_WNAF_TABLE_SIZE]) {
+  curve_point p2 = *p;
+  point_double(curve, &p2);
+  table[0] = *p;
+  for (int i = 1; i < ECDSA_WNAF_TABLE_SIZE; i++) {
+    table[i] = p2;
+    point_add(curve, &table[i - 1], &table[i]);
+  }
+}
+
+// jres += digit * table, keeping track of the point at infinity, which
+// point_jacobian_add cannot represent as an input.
+static void wnaf_add(const ecdsa_curve *curve, const curve_point *table,
+                     int digit, jacobian_curve_point *jres, int *is_infinity) {
+  curve_point p = table[(digit < 0 ? -digit : digit) >> 1];
+  bignum256 z = {0};
+
+  if (digit < 0) {
+    bn_subtract(&curve->prime, &p.y, &p.y);
+  }
+  if (*is_infinity) {
+    jres->x = p.x;
+    jres->y = p.y;
+    bn_one(&jres->z);
+    *is_infinity = 0;
+    return;
+  }
+  // point_jacobian_add handles p == jres, and yields z == 0 for p == -jres.
+  point_jacobian_add(&p, jres, curve);
+  z = jres->z;
+  bn_mod(&z, &curve->prime);
+  *is_infinity = bn_is_zero(&z);
+}
+
+// res = k1 * G + k2 * p
+// Both products are accumulated in a single chain of doublings (Shamir's
+// trick) using wNAF digits.  This runs in variable time and must only be
+// used with public scalars, e.g. for signature verification.
+// k1 and k2 must be normalized numbers with 0 <= k < curve->order
+// returns 0 on success
+int double_scalar_multiply(const ecdsa_curve *curve, const bignum256 *k1,
+                           const bignum256 *k2, const curve_point *p,
+                           curve_point *res) {
+  if (!bn_is_less(k1, &curve->order) || !bn_is_less(k2, &curve->order)) {
+    return 1;
+  }
+
+  int8_t naf1[257] = {0}, naf2[257] = {0};
+  curve_point ptable[ECDSA_WNAF_TABLE_SIZE] = {0};
+#if USE_PRECOMPUTED_CP
+  // curve->cp[0][j] = (2*j+1) * G
+  const curve_point *gtable = curve->cp[0];
+#else
+  curve_point gtable[ECDSA_WNAF_TABLE_SIZE] = {0};
+  wnaf_precompute(curve, &curve->G, gtable);
+#endif
+  jacobian_curve_point jres = {0};
+  int is_infinity = 1;
+
+  wnaf_encode(k1, naf1);
+  wnaf_encode(k2, naf2);
+  wnaf_precompute(curve, p, ptable);
+
+  for (int i = 256; i >= 0; i--) {
+    if (!is_infinity) {
+      point_jacobian_double(&jres, curve);
+    }
+    if (naf1[i] != 0) {
+      wnaf_add(curve, gtable, naf1[i], &jres, &is_infinity);
+    }
+    if (naf2[i] != 0) {
+      wnaf_add(curve, ptable, naf2[i], &jres, &is_infinity);
+    }
+  }
+
+  if (is_infinity) {
+    point_set_infinity(res);
+  } else {
+    jacobian_to_curve(&jres, res, &curve->prime);
+  }
+  return 0;
+}
+
+#else
+
+int double_scalar_multiply(const ecdsa_curve *curve, const bignum256 *k1,
+                           const bignum256 *k2, const curve_point *p,
+                           curve_point *res) {
+  if (!bn_is_less(k1, &curve->order) || !bn_is_less(k2, &curve->order)) {
+    return 1;
+  }
+
+  curve_point tmp = {0};
+  point_multiply(curve, k2, p, &tmp);  // tmp = k2 * p
+  scalar_multiply(curve, k1, res);     // res = k1 * G
+  point_add(curve, &tmp, res);         // res = tmp + res
+  return 0;
+}
+
+#endif
+
 int ecdh_multiply(const ecdsa_curve *curve, const uint8_t *priv_key,
                   const uint8_t *pub_key, uint8_t *session_key) {
   curve_point point = {0};
@@ -679,6 +823,7 @@ int ecdsa_sign(const ecdsa_curve *curve, HasherType hasher_sign,
 int ecdsa_sign_digest(const ecdsa_curve *curve, const uint8_t *priv_key,
                       const uint8_t *digest, uint8_t *sig, uint8_t *pby,
                       int (*is_canonical)(uint8_t by, uint8_t sig[64])) {
+  CRYPTO_PROFILE_SCOPE(PROFILE_ECC);
   int i = 0;
   curve_point R = {0};
   bignum256 k = {0}, z = {0}, randk = {0};
@@ -1023,7 +1168,7 @@ int ecdsa_recover_pub_from_sig(const ecdsa_curve *curve, uint8_t *pub_key,
                                const uint8_t *sig, const uint8_t *digest,
                                int recid) {
   bignum256 r = {0}, s = {0}, e = {0};
-  curve_point cp = {0}, cp2 = {0};
+  curve_point cp = {0};
 
   // read r and s
   bn_read_be(sig, &r);
@@ -1059,12 +1204,9 @@ int ecdsa_recover_pub_from_sig(const ecdsa_curve *curve, uint8_t *pub_key,
   // s = s * r^-1
   bn_multiply(&r, &s, &curve->order);
   bn_mod(&s, &curve->order);
-  // cp = s * r^-1 * k * G
-  point_multiply(curve, &s, &cp, &cp);
-  // cp2 = -digest * r^-1 * G
-  scalar_multiply(curve, &e, &cp2);
-  // cp = (s * r^-1 * k - digest * r^-1) * G = Pub
-  point_add(curve, &cp2, &cp);
+  // cp = -digest * r^-1 * G + s * r^-1 * k * G
+  //    = (s * r^-1 * k - digest * r^-1) * G = Pub
+  double_scalar_multiply(curve, &e, &s, &cp, &cp);
   // The point at infinity is not considered to be a valid public key.
   if (point_is_infinity(&cp)) {
     return 1;
@@ -1078,6 +1220,7 @@ int ecdsa_recover_pub_from_sig(const ecdsa_curve *curve, uint8_t *pub_key,
 // returns 0 if verification succeeded
 int ecdsa_verify_digest(const ecdsa_curve *curve, const uint8_t *pub_key,
                         const uint8_t *sig, const uint8_t *digest) {
+  CRYPTO_PROFILE_SCOPE(PROFILE_ECC);
   curve_point pub = {0}, res = {0};
   bignum256 r = {0}, s = {0}, z = {0};
   int result = 0;
@@ -1114,9 +1257,8 @@ int ecdsa_verify_digest(const ecdsa_curve *curve, const uint8_t *pub_key,
   if (result == 0) {
     bn_multiply(&r, &s, &curve->order);  // s = r * s  [u2 = r * s^-1 mod n]
     bn_mod(&s, &curve->order);
-    scalar_multiply(curve, &z, &res);       // res = z * G    [= u1 * G]
-    point_multiply(curve, &s, &pub, &pub);  // pub = s * pub  [= u2 * Q]
-    point_add(curve, &pub, &res);  // res = pub + res  [R = u1 * G + u2 * Q]
+    // res = z * G + s * pub  [R = u1 * G + u2 * Q]
+    double_scalar_multiply(curve, &z, &s, &pub, &res);
     if (point_is_infinity(&res)) {
       // R == Infinity
       result = 4;
@@ -73,6 +73,9 @@ int point_is_equal(const curve_point *p, const curve_point *q);
 int point_is_negative_of(const curve_point *p, const curve_point *q);
 int scalar_multiply(const ecdsa_curve *curve, const bignum256 *k,
                     curve_point *res);
+int double_scalar_multiply(const ecdsa_curve *curve, const bignum256 *k1,
+                           const bignum256 *k2, const curve_point *p,
+                           curve_point *res);
 int ecdh_multiply(const ecdsa_curve *curve, const uint8_t *priv_key,
                   const uint8_t *pub_key, uint8_t *session_key);
 void compress_coords(const curve_point *cp, uint8_t *compressed);
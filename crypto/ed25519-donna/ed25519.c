@@ -44,6 +44,7 @@ ed25519_hram(hash_512bits hram, const ed25519_public_key R, const ed25519_public
 
 void
 ED25519_FN(ed25519_publickey) (const ed25519_secret_key sk, ed25519_public_key pk) {
+	CRYPTO_PROFILE_SCOPE(PROFILE_ECC);
 	hash_512bits extsk = {0};
 	ed25519_extsk(extsk, sk);
 	ed25519_publickey_ext(extsk, pk);
@@ -153,6 +154,7 @@ ED25519_FN(ed25519_sign_ext) (const unsigned char *m, size_t mlen, const ed25519
 
 void
 ED25519_FN(ed25519_sign) (const unsigned char *m, size_t mlen, const ed25519_secret_key sk, ed25519_signature RS) {
+	CRYPTO_PROFILE_SCOPE(PROFILE_ECC);
 	hash_512bits extsk = {0};
 	ed25519_extsk(extsk, sk);
 	ED25519_FN(ed25519_sign_ext)(m, mlen, extsk, extsk + 32, RS);
@@ -161,6 +163,7 @@ ED25519_FN(ed25519_sign) (const unsigned char *m, size_t mlen, const ed25519_sec
 
 int
 ED25519_FN(ed25519_sign_open) (const unsigned char *m, size_t mlen, const ed25519_public_key pk, const ed25519_signature RS) {
+	CRYPTO_PROFILE_SCOPE(PROFILE_ECC);
 	ge25519 ALIGN(16) R = {0}, A = {0};
 	hash_512bits hash = {0};
 	bignum256modm hram = {0}, S = {0};
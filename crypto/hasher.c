@@ -21,6 +21,7 @@
  */
 
 #include "hasher.h"
+#include "options.h"
 #include "ripemd160.h"
 
 const uint32_t sha256_initial_tapsighash_state[8] = {
@@ -76,6 +77,7 @@ void hasher_Reset(Hasher *hasher) {
 }
 
 void hasher_Update(Hasher *hasher, const uint8_t *data, size_t length) {
+  CRYPTO_PROFILE_SCOPE(PROFILE_HASH);
   switch (hasher->type) {
     case HASHER_SHA2:
     case HASHER_SHA2D:
@@ -105,6 +107,7 @@ void hasher_Update(Hasher *hasher, const uint8_t *data, size_t length) {
 }
 
 void hasher_Final(Hasher *hasher, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+  CRYPTO_PROFILE_SCOPE(PROFILE_HASH);
   switch (hasher->type) {
     case HASHER_SHA2:
     case HASHER_SHA2_TAPSIGHASH:
@@ -28,6 +28,18 @@
 #define USE_PRECOMPUTED_CP 1
 #endif
 
+// compute u1 * G + u2 * Q in ECDSA verification and public key recovery
+// with a single wNAF chain (Shamir's trick); variable time, public data only
+#ifndef USE_ECDSA_SHAMIR
+#define USE_ECDSA_SHAMIR 1
+#endif
+
+// wNAF window width (2..5) for USE_ECDSA_SHAMIR, each multiplied point
+// needs a table of 2^(w-2) odd multiples on the stack
+#ifndef ECDSA_WNAF_WINDOW
+#define ECDSA_WNAF_WINDOW 5
+#endif
+
 // use fast inverse method
 #ifndef USE_INVERSE_FAST
 #define USE_INVERSE_FAST 1
@@ -86,6 +98,12 @@
 #define USE_KECCAK 1
 #endif
 
+// time the enclosing block in profiling builds, the platform defines it
+// (see legacy/profile.h)
+#ifndef CRYPTO_PROFILE_SCOPE
+#define CRYPTO_PROFILE_SCOPE(section)
+#endif
+
 // add way how to mark confidential data
 #ifndef CONFIDENTIAL
 #define CONFIDENTIAL
@@ -138,13 +138,15 @@ uint16_t slip39_word_completion_mask(uint16_t prefix) {
   divider /= 10;
 
   // Determine the range we will be searching in words_button_seq[].
-  min = find_sequence(min);
-  max = find_sequence(max);
+  uint16_t i = find_sequence(min);
+  uint16_t end = find_sequence(max);
 
+  // Jump over the sequences of each digit instead of visiting every word.
   uint16_t bitmap = 0;
-  for (uint16_t i = min; i < max; ++i) {
+  while (i < end) {
     uint8_t digit = (words_button_seq[i].sequence / divider) % 10;
     bitmap |= 1 << (digit - 1);
+    i = find_sequence(min + (digit + 1) * divider);
   }
 
   return bitmap;
@@ -1202,6 +1202,78 @@ START_TEST(test_base58) {
 }
 END_TEST
 
+// Inputs of the sizes of public keys, signatures and serialized extended keys,
+// with and without leading zeros
+START_TEST(test_base58_plain) {
+  static const struct {
+    const char *raw;
+    const char *str;
+  } vectors[] = {
+      {"", ""},
+      {"00", "1"},
+      {"39", "z"},
+      {"000001", "112"},
+      {"0000000000000000000000000000000000000000000000000000000000000000",
+       "11111111111111111111111111111111"},
+      {"00004e1195df020de59e0d65a33a4279f1183e7ae4e5d980e309f8b55adff2e6",
+       "11GeHaiXN7AHuhEigwjYRnzLiuM99wb8mjx4nfcsfgy"},
+      {"c02c0b965e023abee808f2b548d8d5193a8b5229be6f3121a6f16e2d41a449b3",
+       "DwAESrgXgVq2mKRnbRjLNLqPdFdPr9W5E5jAXzuK2sox"},
+      {"122c597083bd438b7f6d72af75d025948899647711b806bdd2cd82fa69713db3d0f631"
+       "ca1ddba8db3bcfcb9e057cdc98d0379f1bee00e75a545147a27dadd982",
+       "N5HF2yg2EzCbjXDPoaBdtZiD8SGRwpEdDA5j5mk6LWXEtAFQM4ApPGtqKxV2uKw4Xryy"
+       "GCrY59GuB1RBe3cjAJd"},
+      {"000ad52e338662c923b15fd45a73c6e97336efccf28a7aef9449443cc6dd7415fb8b53"
+       "639f152c8fc6ef30802fde462ba0be9cf085f7580dc69efd72e002abbb",
+       "13r4ytPeXxKsWmZ6k3sLVCYgZS92zmnz4shyEZZ63YUzxH6Dzy6RG2k8PxksskW1Z6fN"
+       "s4fGMQBM6rhWX7Y1nHQ"},
+      {"5c88e7a226e11ad1204cb8d30cd5d6ff6cba69bc32da73134928e17c90c540868b5cc4"
+       "df7eec7d32a7814eca4af047ae33b2d52342667715682e19c25b0b9faaac0f09c0f8bf"
+       "5e7a4b063d863255f16d8ce9",
+       "LeNBEDUcmG4rzhcBxVc4yqyYLgU4WhcwC77fQCTtvdz1YWXDoAuxvGaWW9QaRSwR77UV"
+       "6kExhSCvR5rCDke6ub6GyTdZyiRfRCL8y57hF2Et3WqN"},
+      {"ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"
+       "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"
+       "ffffffffffffffffffffffffffff",
+       "wM5uZKgAEWV3d2KFsEasjJ3Byvgres8dt47MCeoDY6ajLJcgrdH74PGchrvUgqMfc6wX"
+       "GNRPh9zhuCNFJwZqoCkT5P3TaX8j8yrURVdipdixYcMc"},
+  };
+  uint8_t rawn[82];
+  uint8_t bin[90];
+  char strn[120];
+  for (size_t i = 0; i < sizeof(vectors) / sizeof(*vectors); i++) {
+    size_t len = strlen(vectors[i].raw) / 2;
+    size_t str_len = strlen(vectors[i].str);
+    memcpy(rawn, fromhex(vectors[i].raw), len);
+
+    size_t res = sizeof(strn);
+    ck_assert(b58enc(strn, &res, rawn, len));
+    ck_assert_uint_eq(res, str_len + 1);
+    ck_assert_str_eq(strn, vectors[i].str);
+
+    // a buffer without room for the terminator reports the size needed
+    res = str_len;
+    ck_assert(!b58enc(strn, &res, rawn, len));
+    ck_assert_uint_eq(res, str_len + 1);
+
+    res = sizeof(bin);
+    ck_assert(b58tobin(bin, &res, vectors[i].str));
+    ck_assert_uint_eq(res, len);
+    ck_assert_mem_eq(bin + sizeof(bin) - len, rawn, len);
+
+    // the result has to fit exactly, including the leading zeros
+    if (len > 0) {
+      res = len;
+      ck_assert(b58tobin(bin, &res, vectors[i].str));
+      ck_assert_uint_eq(res, len);
+      ck_assert_mem_eq(bin, rawn, len);
+      res = len - 1;
+      ck_assert(!b58tobin(bin, &res, vectors[i].str));
+    }
+  }
+}
+END_TEST
+
 START_TEST(test_bignum_divmod) {
   uint32_t r;
   int i;
@@ -5640,6 +5712,94 @@ START_TEST(test_mnemonic_find_word) {
 }
 END_TEST
 
+// Linear reference for the prefix lookups, as they were before the
+// prefix range search.
+static uint32_t mnemonic_prefix_reference(const char *prefix, int len,
+                                          uint32_t *mask, int *first) {
+  uint32_t count = 0;
+  *mask = 0;
+  *first = -1;
+  for (int i = 0; i < BIP39_WORD_COUNT; i++) {
+    const char *word = mnemonic_get_word(i);
+    if (strncmp(word, prefix, len) != 0) {
+      continue;
+    }
+    if (*first < 0) {
+      *first = i;
+    }
+    if (word[len] != 0) {
+      *mask |= 1 << (word[len] - 'a');
+    }
+    count++;
+  }
+  return count;
+}
+
+static void check_mnemonic_prefix(char *prefix, int len) {
+  uint32_t mask = 0;
+  int first = 0;
+  uint32_t count = mnemonic_prefix_reference(prefix, len, &mask, &first);
+
+  ck_assert_uint_eq(mnemonic_word_completion_mask(prefix, len), mask);
+  ck_assert_uint_eq(mnemonic_count_with_prefix(prefix, len), count);
+  ck_assert_uint_eq(mnemonic_word_index_with_prefix(prefix, len),
+                    first < 0 ? BIP39_WORD_COUNT : (uint32_t)first);
+  const char *word = mnemonic_complete_word(prefix, len);
+  if (first < 0) {
+    ck_assert_ptr_eq(word, NULL);
+  } else {
+    ck_assert_str_eq(word, mnemonic_get_word(first));
+  }
+
+  char letters[52] = {0};
+  char expected[52] = {0};
+  uint32_t letter_count = 0;
+  for (int c = 0; c < 26; c++) {
+    if (mask & (1 << c)) {
+      expected[2 * letter_count++] = 'a' + c;
+    }
+  }
+  ck_assert_uint_eq(mnemonic_next_letter_with_prefix(prefix, len, letters),
+                    letter_count);
+  ck_assert_mem_eq(letters, expected, sizeof(letters));
+}
+
+START_TEST(test_mnemonic_prefix) {
+  char prefix[10] = {0};
+
+  // every prefix of every word, and every letter appended to the word
+  for (int i = 0; i < BIP39_WORD_COUNT; i++) {
+    const char *word = mnemonic_get_word(i);
+    size_t word_len = strlen(word);
+    for (size_t len = 1; len <= word_len; len++) {
+      memcpy(prefix, word, len);
+      check_mnemonic_prefix(prefix, len);
+    }
+    for (char c = 'a'; c <= 'z'; c++) {
+      prefix[word_len] = c;
+      check_mnemonic_prefix(prefix, word_len + 1);
+    }
+    memzero(prefix, sizeof(prefix));
+  }
+
+  // every prefix of up to three letters
+  for (char a = 'a'; a <= 'z'; a++) {
+    prefix[0] = a;
+    prefix[1] = 0;
+    check_mnemonic_prefix(prefix, 1);
+    for (char b = 'a'; b <= 'z'; b++) {
+      prefix[1] = b;
+      prefix[2] = 0;
+      check_mnemonic_prefix(prefix, 2);
+      for (char c = 'a'; c <= 'z'; c++) {
+        prefix[2] = c;
+        check_mnemonic_prefix(prefix, 3);
+      }
+    }
+  }
+}
+END_TEST
+
 START_TEST(test_slip39_get_word) {
   static const struct {
     const int index;
@@ -5704,6 +5864,29 @@ START_TEST(test_slip39_word_completion_mask) {
 }
 END_TEST
 
+START_TEST(test_slip39_word_completion_mask_all) {
+  // compare every prefix of up to three buttons with a linear scan
+  for (uint16_t prefix = 0; prefix < 1000; prefix++) {
+    uint16_t min = prefix, max = prefix + 1, divider = 1;
+    while (max <= 1000) {
+      min *= 10;
+      max *= 10;
+      divider *= 10;
+    }
+    divider /= 10;
+
+    uint16_t expected = 0;
+    for (size_t i = 0; i < WORDS_COUNT; i++) {
+      uint16_t sequence = words_button_seq[i].sequence;
+      if (sequence >= min && sequence < max) {
+        expected |= 1 << ((sequence / divider) % 10 - 1);
+      }
+    }
+    ck_assert_uint_eq(slip39_word_completion_mask(prefix), expected);
+  }
+}
+END_TEST
+
 START_TEST(test_slip39_sequence_to_word) {
   static const struct {
     const uint16_t prefix;
@@ -6545,6 +6728,58 @@ START_TEST(test_scalar_point_mult_nist256p1) {
 }
 END_TEST
 
+static void test_double_mult_curve(const ecdsa_curve *curve) {
+  int i;
+  // get two "random" numbers and a "random" point
+  bignum256 a = curve->G.x;
+  bignum256 b = curve->G.y;
+  curve_point p = curve->G;
+  curve_point p1, p2;
+  for (i = 0; i < 200; i++) {
+    /* test against the separate products: aG + bP */
+    bn_mod(&a, &curve->order);
+    bn_mod(&b, &curve->order);
+    ck_assert_int_eq(double_scalar_multiply(curve, &a, &b, &p, &p1), 0);
+    ck_assert_int_eq(scalar_multiply(curve, &a, &p2), 0);
+    ck_assert_int_eq(point_multiply(curve, &b, &p, &p), 0);
+    point_add(curve, &p, &p2);
+    ck_assert_mem_eq(&p1, &p2, sizeof(curve_point));
+    // new "random" numbers and a "random" point
+    a = p1.x;
+    b = p.y;
+    p = p1;
+  }
+
+  // border cases with P = G and P = -G
+  curve_point neg_g = curve->G;
+  bn_subtract(&curve->prime, &neg_g.y, &neg_g.y);
+  for (i = 1; i < 40; i++) {
+    bn_read_uint32(i, &a);
+    bn_subtract(&curve->order, &a, &b);  // a + b == 0
+    ck_assert_int_eq(double_scalar_multiply(curve, &a, &b, &curve->G, &p1), 0);
+    ck_assert(point_is_infinity(&p1));
+    ck_assert_int_eq(double_scalar_multiply(curve, &a, &a, &neg_g, &p1), 0);
+    ck_assert(point_is_infinity(&p1));
+
+    bn_read_uint32(2 * i, &b);  // aG + aG == 2aG
+    ck_assert_int_eq(double_scalar_multiply(curve, &a, &a, &curve->G, &p1), 0);
+    ck_assert_int_eq(scalar_multiply(curve, &b, &p2), 0);
+    ck_assert_mem_eq(&p1, &p2, sizeof(curve_point));
+
+    bn_zero(&b);  // aG + 0P == 0G + aG
+    ck_assert_int_eq(double_scalar_multiply(curve, &a, &b, &p, &p1), 0);
+    ck_assert_int_eq(double_scalar_multiply(curve, &b, &a, &curve->G, &p2), 0);
+    ck_assert_mem_eq(&p1, &p2, sizeof(curve_point));
+    ck_assert_int_eq(double_scalar_multiply(curve, &b, &b, &p, &p1), 0);
+    ck_assert(point_is_infinity(&p1));
+  }
+}
+
+START_TEST(test_double_mult_secp256k1) { test_double_mult_curve(&secp256k1); }
+END_TEST
+START_TEST(test_double_mult_nist256p1) { test_double_mult_curve(&nist256p1); }
+END_TEST
+
 START_TEST(test_ed25519) {
   // test vectors from
   // https://github.com/torproject/tor/blob/master/src/test/ed25519_vectors.inc
@@ -9483,6 +9718,7 @@ Suite *test_suite(void) {
 
   tc = tcase_create("base58");
   tcase_add_test(tc, test_base58);
+  tcase_add_test(tc, test_base58_plain);
   suite_add_tcase(s, tc);
 
   tc = tcase_create("bignum_divmod");
@@ -9611,12 +9847,14 @@ Suite *test_suite(void) {
   tcase_add_test(tc, test_mnemonic_check);
   tcase_add_test(tc, test_mnemonic_to_bits);
   tcase_add_test(tc, test_mnemonic_find_word);
+  tcase_add_test(tc, test_mnemonic_prefix);
   suite_add_tcase(s, tc);
 
   tc = tcase_create("slip39");
   tcase_add_test(tc, test_slip39_get_word);
   tcase_add_test(tc, test_slip39_word_index);
   tcase_add_test(tc, test_slip39_word_completion_mask);
+  tcase_add_test(tc, test_slip39_word_completion_mask_all);
   tcase_add_test(tc, test_slip39_sequence_to_word);
   tcase_add_test(tc, test_slip39_word_completion);
   suite_add_tcase(s, tc);
@@ -9658,6 +9896,11 @@ Suite *test_suite(void) {
   tcase_add_test(tc, test_scalar_point_mult_nist256p1);
   suite_add_tcase(s, tc);
 
+  tc = tcase_create("double_mult");
+  tcase_add_test(tc, test_double_mult_secp256k1);
+  tcase_add_test(tc, test_double_mult_nist256p1);
+  suite_add_tcase(s, tc);
+
   tc = tcase_create("ed25519");
   tcase_add_test(tc, test_ed25519);
   suite_add_tcase(s, tc);
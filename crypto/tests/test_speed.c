@@ -1,15 +1,30 @@
-#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
+#include "aes/aes.h"
+#include "base58.h"
+#include "bignum.h"
 #include "bip32.h"
+#include "cash_addr.h"
+#include "chacha20poly1305/rfc7539.h"
 #include "curves.h"
 #include "ecdsa.h"
 #include "ed25519-donna/ed25519.h"
 #include "hasher.h"
+#include "hmac.h"
 #include "nist256p1.h"
+#include "pbkdf2.h"
 #include "secp256k1.h"
+#include "segwit_addr.h"
+#include "zkp_bip340.h"
+#include "zkp_context.h"
+#include "zkp_ecdsa.h"
 
 static uint8_t msg[256];
 
@@ -148,6 +163,51 @@ void bench_verify_ed25519(int iterations) {
   }
 }
 
+static bignum256 scalar1, scalar2;
+static curve_point point;
+
+void prepare_scalars(void) {
+  bn_read_be(msg, &scalar1);
+  bn_mod(&scalar1, &secp256k1.order);
+  bn_read_be(msg + 32, &scalar2);
+  bn_mod(&scalar2, &secp256k1.order);
+  scalar_multiply(&secp256k1, &scalar2, &point);
+}
+
+void bench_multiply_base_secp256k1(int iterations) {
+  curve_point res;
+
+  for (int i = 0; i < iterations; i++) {
+    scalar_multiply(&secp256k1, &scalar1, &res);
+  }
+}
+
+void bench_multiply_point_secp256k1(int iterations) {
+  curve_point res;
+
+  for (int i = 0; i < iterations; i++) {
+    point_multiply(&secp256k1, &scalar1, &point, &res);
+  }
+}
+
+void bench_multiply_double_secp256k1(int iterations) {
+  curve_point res;
+
+  for (int i = 0; i < iterations; i++) {
+    double_scalar_multiply(&secp256k1, &scalar1, &scalar2, &point, &res);
+  }
+}
+
+void bench_multiply_separate_secp256k1(int iterations) {
+  curve_point res, tmp;
+
+  for (int i = 0; i < iterations; i++) {
+    scalar_multiply(&secp256k1, &scalar1, &res);
+    point_multiply(&secp256k1, &scalar2, &point, &tmp);
+    point_add(&secp256k1, &tmp, &res);
+  }
+}
+
 void bench_multiply_curve25519(int iterations) {
   uint8_t result[32];
   uint8_t secret[32];
@@ -197,35 +257,590 @@ void bench_ckd_optimized(int iterations) {
   }
 }
 
-void bench(void (*func)(int), const char *name, int iterations) {
-  clock_t t = clock();
-  func(iterations);
-  float speed = iterations / ((float)(clock() - t) / CLOCKS_PER_SEC);
-  printf("%25s: %8.2f ops/s\n", name, speed);
+void bench_ckd_private(int iterations) {
+  HDNode node;
+  for (int i = 0; i < iterations; i++) {
+    memcpy(&node, &root, sizeof(HDNode));
+    hdnode_private_ckd_prime(&node, i);
+  }
 }
 
-#define BENCH(FUNC, ITER) bench(FUNC, #FUNC, ITER)
+static HDNode root_ed25519;
 
-int main(void) {
-  prepare_msg();
+void prepare_node_ed25519(void) {
+  hdnode_from_seed((uint8_t *)"NothingToSeeHere", 16, ED25519_NAME,
+                   &root_ed25519);
+}
+
+void bench_ckd_ed25519(int iterations) {
+  HDNode node;
+  for (int i = 0; i < iterations; i++) {
+    memcpy(&node, &root_ed25519, sizeof(HDNode));
+    hdnode_private_ckd_prime(&node, i);
+    hdnode_fill_public_key(&node);
+  }
+}
+
+void bench_hasher(HasherType type, int iterations) {
+  uint8_t hash[HASHER_DIGEST_LENGTH];
+  Hasher hasher;
+
+  for (int i = 0; i < iterations; i++) {
+    hasher_InitParam(&hasher, type, "ZcashPrevoutHash", 16);
+    hasher_Update(&hasher, msg, sizeof(msg));
+    hasher_Final(&hasher, hash);
+  }
+}
+
+#define BENCH_HASHER(NAME, TYPE) \
+  void bench_hash_##NAME(int iterations) { bench_hasher(TYPE, iterations); }
+
+BENCH_HASHER(sha2, HASHER_SHA2)
+BENCH_HASHER(sha2d, HASHER_SHA2D)
+BENCH_HASHER(sha2_ripemd, HASHER_SHA2_RIPEMD)
+BENCH_HASHER(sha2_tapsighash, HASHER_SHA2_TAPSIGHASH)
+BENCH_HASHER(sha3, HASHER_SHA3)
+#if USE_KECCAK
+BENCH_HASHER(sha3k, HASHER_SHA3K)
+#endif
+BENCH_HASHER(blake, HASHER_BLAKE)
+BENCH_HASHER(blaked, HASHER_BLAKED)
+BENCH_HASHER(blake_ripemd, HASHER_BLAKE_RIPEMD)
+BENCH_HASHER(groestld_trunc, HASHER_GROESTLD_TRUNC)
+BENCH_HASHER(blake2b, HASHER_BLAKE2B)
+BENCH_HASHER(blake2b_personal, HASHER_BLAKE2B_PERSONAL)
+
+void bench_hmac_sha256(int iterations) {
+  uint8_t mac[SHA256_DIGEST_LENGTH];
+  for (int i = 0; i < iterations; i++) {
+    hmac_sha256(msg, 32, msg, sizeof(msg), mac);
+  }
+}
+
+void bench_hmac_sha512(int iterations) {
+  uint8_t mac[SHA512_DIGEST_LENGTH];
+  for (int i = 0; i < iterations; i++) {
+    hmac_sha512(msg, 32, msg, sizeof(msg), mac);
+  }
+}
+
+// One operation is a whole derivation, 2048 rounds as in BIP-39.
+void bench_pbkdf2_hmac_sha256(int iterations) {
+  uint8_t key[32];
+  for (int i = 0; i < iterations; i++) {
+    pbkdf2_hmac_sha256(msg, 32, msg + 32, 16, 2048, key, sizeof(key));
+  }
+}
+
+void bench_pbkdf2_hmac_sha512(int iterations) {
+  uint8_t key[64];
+  for (int i = 0; i < iterations; i++) {
+    pbkdf2_hmac_sha512(msg, 32, msg + 32, 16, 2048, key, sizeof(key));
+  }
+}
+
+void bench_bn_multiply(int iterations) {
+  bignum256 x = scalar1;
+  for (int i = 0; i < iterations; i++) {
+    bn_multiply(&scalar2, &x, &secp256k1.prime);
+  }
+}
+
+void bench_bn_inverse(int iterations) {
+  bignum256 x;
+  for (int i = 0; i < iterations; i++) {
+    x = scalar1;
+    bn_inverse(&x, &secp256k1.prime);
+  }
+}
+
+void bench_bn_sqrt(int iterations) {
+  bignum256 x;
+  for (int i = 0; i < iterations; i++) {
+    x = scalar1;
+    bn_sqrt(&x, &secp256k1.prime);
+  }
+}
+
+static const uint8_t *bench_priv = (const uint8_t *)
+    "\xc5\x5e\xce\x85\x8b\x0d\xdd\x52\x63\xf9\x68\x10\xfe\x14\x43\x7c\xd3"
+    "\xb5\xe1\xfb\xd7\xc6\xa2\xec\x1e\x03\x1f\x05\xe8\x6d\x8b\xd5";
+
+void bench_zkp_sign_secp256k1(int iterations) {
+  uint8_t sig[64], pby;
+  for (int i = 0; i < iterations; i++) {
+    zkp_ecdsa_sign_digest(&secp256k1, bench_priv, msg, sig, &pby, NULL);
+  }
+}
+
+// Signed before any threads start, because signing needs the writable zkp
+// context, while the verify benchmarks may run in parallel.
+static uint8_t zkp_ecdsa_pub[33], zkp_ecdsa_sig[64];
+static uint8_t zkp_bip340_pub[32], zkp_bip340_sig[64];
+
+bool prepare_zkp(void) {
+  uint8_t pby;
+  return zkp_ecdsa_get_public_key33(&secp256k1, bench_priv, zkp_ecdsa_pub) ==
+             0 &&
+         zkp_ecdsa_sign_digest(&secp256k1, bench_priv, msg, zkp_ecdsa_sig,
+                               &pby, NULL) == 0 &&
+         zkp_ecdsa_verify_digest(&secp256k1, zkp_ecdsa_pub, zkp_ecdsa_sig,
+                                 msg) == 0 &&
+         zkp_bip340_get_public_key(bench_priv, zkp_bip340_pub) == 0 &&
+         zkp_bip340_sign_digest(bench_priv, msg, zkp_bip340_sig, NULL) == 0 &&
+         zkp_bip340_verify_digest(zkp_bip340_pub, zkp_bip340_sig, msg) == 0;
+}
+
+void bench_zkp_verify_secp256k1(int iterations) {
+  for (int i = 0; i < iterations; i++) {
+    if (zkp_ecdsa_verify_digest(&secp256k1, zkp_ecdsa_pub, zkp_ecdsa_sig,
+                                msg) != 0) {
+      fprintf(stderr, "zkp_ecdsa_verify_digest failed\n");
+      exit(1);
+    }
+  }
+}
+
+void bench_bip340_sign(int iterations) {
+  uint8_t sig[64];
+  for (int i = 0; i < iterations; i++) {
+    zkp_bip340_sign_digest(bench_priv, msg, sig, NULL);
+  }
+}
 
-  BENCH(bench_sign_secp256k1, 500);
-  BENCH(bench_verify_secp256k1_33, 500);
-  BENCH(bench_verify_secp256k1_65, 500);
+void bench_bip340_verify(int iterations) {
+  for (int i = 0; i < iterations; i++) {
+    if (zkp_bip340_verify_digest(zkp_bip340_pub, zkp_bip340_sig, msg) != 0) {
+      fprintf(stderr, "zkp_bip340_verify_digest failed\n");
+      exit(1);
+    }
+  }
+}
 
-  BENCH(bench_sign_nist256p1, 500);
-  BENCH(bench_verify_nist256p1_33, 500);
-  BENCH(bench_verify_nist256p1_65, 500);
+void bench_aes256_cbc_encrypt(int iterations) {
+  aes_encrypt_ctx ctx;
+  uint8_t iv[AES_BLOCK_SIZE], out[sizeof(msg)];
+  aes_encrypt_key256(bench_priv, &ctx);
+  for (int i = 0; i < iterations; i++) {
+    memcpy(iv, msg, sizeof(iv));
+    aes_cbc_encrypt(msg, out, sizeof(msg), iv, &ctx);
+  }
+}
 
-  BENCH(bench_sign_ed25519, 4000);
-  BENCH(bench_verify_ed25519, 4000);
+void bench_aes256_cbc_decrypt(int iterations) {
+  aes_decrypt_ctx ctx;
+  uint8_t iv[AES_BLOCK_SIZE], out[sizeof(msg)];
+  aes_decrypt_key256(bench_priv, &ctx);
+  for (int i = 0; i < iterations; i++) {
+    memcpy(iv, msg, sizeof(iv));
+    aes_cbc_decrypt(msg, out, sizeof(msg), iv, &ctx);
+  }
+}
 
-  BENCH(bench_multiply_curve25519, 4000);
+void bench_chacha20poly1305(int iterations) {
+  chacha20poly1305_ctx ctx;
+  uint8_t out[sizeof(msg)], mac[16];
+  for (int i = 0; i < iterations; i++) {
+    rfc7539_init(&ctx, bench_priv, msg);
+    rfc7539_auth(&ctx, msg, 32);
+    chacha20poly1305_encrypt(&ctx, msg, out, sizeof(msg));
+    rfc7539_finish(&ctx, 32, sizeof(msg), mac);
+  }
+}
+
+void bench_base58_encode_check(int iterations) {
+  char str[128];
+  for (int i = 0; i < iterations; i++) {
+    base58_encode_check(msg, 78, HASHER_SHA2D, str, sizeof(str));
+  }
+}
+
+void bench_base58_decode_check(int iterations) {
+  char str[128];
+  uint8_t data[78];
+  base58_encode_check(msg, 78, HASHER_SHA2D, str, sizeof(str));
+  for (int i = 0; i < iterations; i++) {
+    base58_decode_check(str, HASHER_SHA2D, data, sizeof(data));
+  }
+}
+
+// msg + 1 skips the zero byte at the start of msg
+static void bench_b58enc(int iterations, size_t len) {
+  char str[128];
+  for (int i = 0; i < iterations; i++) {
+    size_t res = sizeof(str);
+    b58enc(str, &res, msg + 1, len);
+  }
+}
+
+static void bench_b58tobin(int iterations, size_t len) {
+  char str[128];
+  uint8_t data[82];
+  size_t res = sizeof(str);
+  b58enc(str, &res, msg + 1, len);
+  for (int i = 0; i < iterations; i++) {
+    res = len;
+    b58tobin(data, &res, str);
+  }
+}
+
+void bench_b58enc_32(int iterations) { bench_b58enc(iterations, 32); }
+void bench_b58enc_64(int iterations) { bench_b58enc(iterations, 64); }
+void bench_b58enc_82(int iterations) { bench_b58enc(iterations, 82); }
+void bench_b58tobin_32(int iterations) { bench_b58tobin(iterations, 32); }
+void bench_b58tobin_64(int iterations) { bench_b58tobin(iterations, 64); }
+void bench_b58tobin_82(int iterations) { bench_b58tobin(iterations, 82); }
+
+void bench_segwit_addr_encode(int iterations) {
+  char addr[MAX_ADDR_SIZE];
+  for (int i = 0; i < iterations; i++) {
+    segwit_addr_encode(addr, "bc", 0, msg, 20);
+  }
+}
+
+void bench_cash_addr_encode(int iterations) {
+  char addr[MAX_ADDR_SIZE];
+  uint8_t prog[21] = {0};
+  memcpy(prog + 1, msg, 20);
+  for (int i = 0; i < iterations; i++) {
+    cash_addr_encode(addr, "bitcoincash", prog, sizeof(prog));
+  }
+}
 
+typedef struct {
+  const char *name;
+  void (*func)(int);
+  int iterations;
+  // uses the writable zkp context, which cannot be shared between threads
+  bool serial;
+} benchmark;
+
+#define BENCH(FUNC, ITER) {#FUNC, FUNC, ITER, false}
+#define BENCH_SERIAL(FUNC, ITER) {#FUNC, FUNC, ITER, true}
+
+static const benchmark benchmarks[] = {
+    BENCH(bench_hash_sha2, 50000),
+    BENCH(bench_hash_sha2d, 50000),
+    BENCH(bench_hash_sha2_ripemd, 50000),
+    BENCH(bench_hash_sha2_tapsighash, 50000),
+    BENCH(bench_hash_sha3, 50000),
+#if USE_KECCAK
+    BENCH(bench_hash_sha3k, 50000),
+#endif
+    BENCH(bench_hash_blake, 50000),
+    BENCH(bench_hash_blaked, 50000),
+    BENCH(bench_hash_blake_ripemd, 50000),
+    BENCH(bench_hash_groestld_trunc, 10000),
+    BENCH(bench_hash_blake2b, 200000),
+    BENCH(bench_hash_blake2b_personal, 200000),
+
+    BENCH(bench_hmac_sha256, 50000),
+    BENCH(bench_hmac_sha512, 50000),
+    BENCH(bench_pbkdf2_hmac_sha256, 50),
+    BENCH(bench_pbkdf2_hmac_sha512, 50),
+
+    BENCH(bench_bn_multiply, 500000),
+    BENCH(bench_bn_inverse, 20000),
+    BENCH(bench_bn_sqrt, 5000),
+
+    BENCH(bench_sign_secp256k1, 500),
+    BENCH(bench_verify_secp256k1_33, 500),
+    BENCH(bench_verify_secp256k1_65, 500),
+
+    BENCH(bench_sign_nist256p1, 500),
+    BENCH(bench_verify_nist256p1_33, 500),
+    BENCH(bench_verify_nist256p1_65, 500),
+
+    BENCH(bench_multiply_base_secp256k1, 500),
+    BENCH(bench_multiply_point_secp256k1, 500),
+    BENCH(bench_multiply_double_secp256k1, 500),
+    BENCH(bench_multiply_separate_secp256k1, 500),
+
+    BENCH_SERIAL(bench_zkp_sign_secp256k1, 2000),
+    BENCH(bench_zkp_verify_secp256k1, 2000),
+    BENCH_SERIAL(bench_bip340_sign, 2000),
+    BENCH(bench_bip340_verify, 2000),
+
+    BENCH(bench_sign_ed25519, 4000),
+    BENCH(bench_verify_ed25519, 4000),
+
+    BENCH(bench_multiply_curve25519, 4000),
+
+    BENCH(bench_aes256_cbc_encrypt, 100000),
+    BENCH(bench_aes256_cbc_decrypt, 100000),
+    BENCH(bench_chacha20poly1305, 200000),
+
+    BENCH(bench_base58_encode_check, 20000),
+    BENCH(bench_base58_decode_check, 50000),
+    BENCH(bench_b58enc_32, 50000),
+    BENCH(bench_b58enc_64, 20000),
+    BENCH(bench_b58enc_82, 20000),
+    BENCH(bench_b58tobin_32, 100000),
+    BENCH(bench_b58tobin_64, 50000),
+    BENCH(bench_b58tobin_82, 50000),
+    BENCH(bench_segwit_addr_encode, 500000),
+    BENCH(bench_cash_addr_encode, 500000),
+
+    BENCH(bench_ckd_normal, 1000),
+    BENCH(bench_ckd_optimized, 1000),
+    BENCH(bench_ckd_private, 50000),
+    BENCH(bench_ckd_ed25519, 10000),
+};
+
+#define BENCHMARK_COUNT (sizeof(benchmarks) / sizeof(*benchmarks))
+#define MAX_REPETITIONS 100
+#define MAX_THREADS 256
+
+typedef struct {
+  const benchmark *bench;
+  pthread_barrier_t *barrier;
+} worker_args;
+
+static void *worker(void *arg) {
+  const worker_args *args = arg;
+  pthread_barrier_wait(args->barrier);
+  args->bench->func(args->bench->iterations);
+  return NULL;
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Runs the benchmark once on each of `threads` threads and returns the
+// combined speed in ops/s, measured on the wall clock.
+static double run(const benchmark *bench, int threads) {
+  if (threads == 1) {
+    double t = now();
+    bench->func(bench->iterations);
+    return bench->iterations / (now() - t);
+  }
+
+  pthread_t tids[MAX_THREADS];
+  pthread_barrier_t barrier;
+  worker_args args = {bench, &barrier};
+
+  pthread_barrier_init(&barrier, NULL, threads + 1);
+  for (int i = 0; i < threads; i++) {
+    pthread_create(&tids[i], NULL, worker, &args);
+  }
+  pthread_barrier_wait(&barrier);
+  double t = now();
+  for (int i = 0; i < threads; i++) {
+    pthread_join(tids[i], NULL);
+  }
+  t = now() - t;
+  pthread_barrier_destroy(&barrier);
+
+  return (double)threads * bench->iterations / t;
+}
+
+static int compare_double(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+typedef struct {
+  double min, median, mean, stddev;
+} summary;
+
+static summary summarize(double *speeds, int count) {
+  summary res = {0};
+
+  qsort(speeds, count, sizeof(*speeds), compare_double);
+  res.min = speeds[0];
+  res.median = count % 2 ? speeds[count / 2]
+                         : (speeds[count / 2 - 1] + speeds[count / 2]) / 2;
+  for (int i = 0; i < count; i++) {
+    res.mean += speeds[i];
+  }
+  res.mean /= count;
+  for (int i = 0; i < count; i++) {
+    res.stddev += (speeds[i] - res.mean) * (speeds[i] - res.mean);
+  }
+  res.stddev = count > 1 ? sqrt(res.stddev / (count - 1)) : 0;
+
+  return res;
+}
+
+// Reads the median speed of the benchmark and the number of threads it ran
+// on from a file written by -J. Each benchmark is on its own line, so a line
+// search is enough.
+static bool baseline_median(FILE *f, const char *name, double *median,
+                            int *threads) {
+  char line[512], key[128];
+  snprintf(key, sizeof(key), "\"name\": \"%s\",", name);
+
+  rewind(f);
+  while (fgets(line, sizeof(line), f)) {
+    if (!strstr(line, key)) {
+      continue;
+    }
+    const char *value = strstr(line, "\"median\": ");
+    const char *count = strstr(line, "\"threads\": ");
+    return value && sscanf(value, "\"median\": %lf", median) == 1 &&
+           count && sscanf(count, "\"threads\": %d", threads) == 1;
+  }
+  return false;
+}
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s [-j threads] [-r repetitions] [-f filter] [-J]\n"
+          "       [-b baseline.json] [-t threshold]\n"
+          "  -j  run each benchmark on this many threads at once\n"
+          "  -r  timed repetitions after one warmup run (default 5)\n"
+          "  -f  only run benchmarks whose name contains filter\n"
+          "  -J  print JSON instead of text\n"
+          "  -b  compare the medians with a file written by -J\n"
+          "  -t  regression threshold in percent (default 5)\n",
+          argv0);
+}
+
+int main(int argc, char **argv) {
+  int threads = 1, repetitions = 5;
+  const char *filter = NULL, *baseline_path = NULL;
+  bool json = false;
+  double threshold = 5;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "j:r:f:Jb:t:h")) != -1) {
+    switch (opt) {
+      case 'j':
+        threads = atoi(optarg);
+        break;
+      case 'r':
+        repetitions = atoi(optarg);
+        break;
+      case 'f':
+        filter = optarg;
+        break;
+      case 'J':
+        json = true;
+        break;
+      case 'b':
+        baseline_path = optarg;
+        break;
+      case 't':
+        threshold = atof(optarg);
+        break;
+      default:
+        usage(argv[0]);
+        return opt == 'h' ? 0 : 2;
+    }
+  }
+  if (threads < 1 || threads > MAX_THREADS || repetitions < 1 ||
+      repetitions > MAX_REPETITIONS) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  FILE *baseline = NULL;
+  if (baseline_path) {
+    baseline = fopen(baseline_path, "r");
+    if (!baseline) {
+      perror(baseline_path);
+      return 2;
+    }
+  }
+
+  if (zkp_context_init() != 0) {
+    fprintf(stderr, "zkp_context_init failed\n");
+    return 2;
+  }
+  prepare_msg();
+  prepare_scalars();
   prepare_node();
+  prepare_node_ed25519();
+  if (!prepare_zkp()) {
+    fprintf(stderr, "prepare_zkp failed\n");
+    return 2;
+  }
+
+  if (json) {
+    printf("{\"threads\": %d, \"repetitions\": %d, \"benchmarks\": [\n",
+           threads, repetitions);
+  } else {
+#if USE_PRECOMPUTED_CP
+    printf("%32s: %8u bytes per curve\n", "precomputed_cp",
+           (unsigned)sizeof(secp256k1.cp));
+#else
+    printf("%32s: %8s\n", "precomputed_cp", "disabled");
+#endif
+#if USE_ECDSA_SHAMIR
+    printf("%32s: %8d\n", "wnaf_window", ECDSA_WNAF_WINDOW);
+#endif
+  }
+
+  int regressions = 0;
+  bool first = true;
+  for (size_t i = 0; i < BENCHMARK_COUNT; i++) {
+    const benchmark *bench = &benchmarks[i];
+    if (filter && !strstr(bench->name, filter)) {
+      continue;
+    }
+    int n = bench->serial ? 1 : threads;
+    double speeds[MAX_REPETITIONS];
+
+    run(bench, n);  // warmup
+    for (int r = 0; r < repetitions; r++) {
+      speeds[r] = run(bench, n);
+    }
+    summary sum = summarize(speeds, repetitions);
+
+    double base = 0, change = 0;
+    int base_threads = 0;
+    bool has_base = baseline && baseline_median(baseline, bench->name, &base,
+                                                &base_threads);
+    if (has_base && base_threads != n) {
+      // ops/s of a different number of threads are not comparable
+      fprintf(stderr, "%s: baseline ran on %d thread(s), not %d, skipped\n",
+              bench->name, base_threads, n);
+      has_base = false;
+    }
+    bool regressed = false;
+    if (has_base && base > 0) {
+      change = (sum.median - base) / base * 100;
+      regressed = change < -threshold;
+      regressions += regressed;
+    }
+
+    if (json) {
+      printf("%s  {\"name\": \"%s\", \"threads\": %d, \"iterations\": %d, "
+             "\"min\": %.2f, \"median\": %.2f, \"mean\": %.2f, "
+             "\"stddev\": %.2f",
+             first ? "" : ",\n", bench->name, n, bench->iterations, sum.min,
+             sum.median, sum.mean, sum.stddev);
+      if (has_base) {
+        printf(", \"baseline\": %.2f, \"change\": %.2f, \"regression\": %s",
+               base, change, regressed ? "true" : "false");
+      }
+      printf("}");
+    } else {
+      printf("%32s: %12.2f ops/s (+-%5.2f%%)", bench->name, sum.median,
+             sum.mean > 0 ? sum.stddev / sum.mean * 100 : 0);
+      if (n > 1) {
+        printf(" x%d", n);
+      }
+      if (has_base) {
+        printf(" %+7.2f%%%s", change, regressed ? " REGRESSION" : "");
+      }
+      printf("\n");
+    }
+    first = false;
+  }
 
-  BENCH(bench_ckd_normal, 1000);
-  BENCH(bench_ckd_optimized, 1000);
+  if (json) {
+    printf("\n]}\n");
+  } else if (baseline) {
+    printf("%d regression(s) beyond %.2f%%\n", regressions, threshold);
+  }
+  if (baseline) {
+    fclose(baseline);
+  }
 
-  return 0;
+  zkp_context_destroy();
+  return regressions ? 1 : 0;
 }
@@ -136,7 +136,7 @@ int main(void) {
                                      // unpredictable stack protection check
     buttonsIrqInit();
     timer_init();
-    register_timer("button", timer1s / 2, buttonsTimer);
+    register_timer(timer1s / 2, buttonsTimer, true);
     mpu_config_bootloader();
   } else {
 #ifndef APPVER
@@ -151,7 +151,7 @@ int main(void) {
     sys_poweron();
     buttonsIrqInit();
     timer_init();
-    register_timer("button", timer1s / 2, buttonsTimer);
+    register_timer(timer1s / 2, buttonsTimer, true);
 #endif
     mpu_config_bootloader();
 #ifndef APPVER
@@ -315,7 +315,7 @@ void buttonUpdate(void) {
 #if !EMULATOR
   if (button.YesUp || button.NoUp || button.UpUp || button.DownUp) {
     timer_sleep_start_reset();
-    unregister_timer("poweroff");
+    unregister_timer(&auto_poweroff_handle);
   }
 #endif
   last_state = state;
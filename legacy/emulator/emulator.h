@@ -24,6 +24,7 @@
 
 #include "strl.h"
 
+#include <stdbool.h>
 #include <stddef.h>
 
 void emulatorPoll(void);
@@ -32,6 +33,8 @@ void emulatorSocketInit(void);
 size_t emulatorSocketRead(int *iface, void *buffer, size_t size,
                           int timeout_ms);
 size_t emulatorSocketWrite(int iface, const void *buffer, size_t size);
+void emulatorSocketFlush(void);
+bool emulatorSocketIsStream(void);
 
 #endif
 
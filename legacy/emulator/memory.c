@@ -36,28 +36,18 @@ void flash_unlock_option_bytes(void) {}
 void flash_program_option_bytes(uint32_t data) { (void)data; }
 
 static ssize_t sector_to_offset(uint8_t sector) {
-  switch (sector) {
-    case 0:
-      return 0x0;
-    case 1:
-      return 0x4000;
-    case 2:
-      return 0x8000;
-    case 3:
-      return 0xC000;
-    case 4:
-      return 0x10000;
-    case 5:
-      return 0x20000;
-    case 6:
-      return 0x40000;
-    case 7:
-      return 0x60000;
-    case 8:
-      return 0x80000;
-    default:
-      return -1;
+  // same layout as FLASH_SECTOR_TABLE of the GD32 flash
+  static const uint32_t offsets[] = {
+      0x0,      0x4000,   0x8000,   0xC000,   0x10000,  0x20000,
+      0x40000,  0x60000,  0x80000,  0xA0000,  0xC0000,  0xE0000,
+      0x100000, 0x104000, 0x108000, 0x10C000, 0x110000, 0x120000,
+      0x140000, 0x160000, 0x180000, 0x1A0000, 0x1C0000, 0x1E0000,
+      0x200000, 0x240000, 0x280000, 0x2C0000, 0x300000,
+  };
+  if (sector >= sizeof(offsets) / sizeof(offsets[0])) {
+    return -1;
   }
+  return offsets[sector];
 }
 
 static void *sector_to_address(uint8_t sector) {
@@ -18,6 +18,7 @@
  */
 
 #include "oled.h"
+#include "profile.h"
 
 #include <SDL.h>
 
@@ -104,6 +105,8 @@ void oledInit(void) {
 }
 
 void oledRefresh(void) {
+  PROFILE_SCOPE(PROFILE_DISPLAY);
+
   /* Draw triangle in upper right corner */
   oledInvertDebugLink();
 
@@ -17,32 +17,115 @@
  * along with this library.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stddef.h>
 #include <time.h>
 
 #include "timer.h"
 
 void timer_init(void) {}
 
-static uint32_t timer_out_array[timer_out_null];
-static void timer_out_decrease(void) {
-  uint32_t i = timer_out_null;
-  while (i--) {
-    if (timer_out_array[i]) timer_out_array[i]--;
+static uint32_t clock_ms(void) {
+  struct timespec t = {0};
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000 + (t.tv_nsec / 1000000);
+}
+
+static bool deadline_reached(uint32_t now, uint32_t deadline) {
+  return (int32_t)(now - deadline) >= 0;
+}
+
+// There is no tick interrupt, so timers are run from timer_ms(), which all
+// wait loops call.
+#define TIMER_NUM 5
+typedef struct {
+  timer_func fp;
+  uint32_t deadline;
+  uint32_t cycle;  // 0 for a one-shot timer
+  uint8_t generation;
+} TimerDsec;
+
+static TimerDsec timer_array[TIMER_NUM];
+static uint32_t timer_next_deadline = 0;
+static bool timer_rescan = false;
+
+timer_handle register_timer(uint32_t cyc, timer_func fp, bool periodic) {
+  for (int i = 0; i < TIMER_NUM; i++) {
+    if (!timer_array[i].fp) {
+      timer_array[i].deadline = clock_ms() + cyc;
+      timer_array[i].cycle = periodic ? cyc : 0;
+      timer_array[i].generation++;
+      timer_array[i].fp = fp;
+      timer_rescan = true;
+      return (timer_array[i].generation << 8) | i;
+    }
   }
+  return TIMER_INVALID;
 }
-void timer_out_set(TimerOut type, uint32_t val) { timer_out_array[type] = val; }
-uint32_t timer_out_get(TimerOut type) { return timer_out_array[type]; }
 
-uint32_t timer_ms(void) {
-  static int counter = 0;
-  struct timespec t = {0};
-  counter++;
-  clock_gettime(CLOCK_MONOTONIC, &t);
+void unregister_timer(timer_handle *handle) {
+  if (*handle == TIMER_INVALID) {
+    return;
+  }
+  const uint32_t i = *handle & 0xFF;
+  if (i < TIMER_NUM && timer_array[i].generation == (uint8_t)(*handle >> 8)) {
+    timer_array[i].fp = NULL;
+  }
+  *handle = TIMER_INVALID;
+}
 
-  uint32_t msec = t.tv_sec * 1000 + (t.tv_nsec / 1000000);
-  if (counter > 1000) {
-    counter = 0;
-    timer_out_decrease();
+static void timer_dispatch(uint32_t now) {
+  static bool dispatching = false;
+  if (dispatching) {
+    return;
+  }
+  dispatching = true;
+  uint32_t next_in = UINT32_MAX >> 1;
+  timer_rescan = false;
+  for (int i = 0; i < TIMER_NUM; i++) {
+    timer_func fp = timer_array[i].fp;
+    if (!fp) {
+      continue;
+    }
+    if (deadline_reached(now, timer_array[i].deadline)) {
+      if (timer_array[i].cycle) {
+        timer_array[i].deadline = now + timer_array[i].cycle;
+      } else {
+        timer_array[i].fp = NULL;
+      }
+      fp();
+    }
+    if (timer_array[i].fp && timer_array[i].deadline - now < next_in) {
+      next_in = timer_array[i].deadline - now;
+    }
+  }
+  timer_next_deadline = now + next_in;
+  dispatching = false;
+}
+
+static uint32_t timer_out_deadline[timer_out_null];
+static bool timer_out_active[timer_out_null];
+
+void timer_out_set(TimerOut type, uint32_t val) {
+  timer_out_deadline[type] = clock_ms() + val;
+  timer_out_active[type] = val != 0;
+}
+
+uint32_t timer_out_get(TimerOut type) {
+  if (!timer_out_active[type]) {
+    return 0;
+  }
+  const uint32_t now = timer_ms();
+  if (deadline_reached(now, timer_out_deadline[type])) {
+    timer_out_active[type] = false;
+    return 0;
+  }
+  return timer_out_deadline[type] - now;
+}
+
+uint32_t timer_ms(void) {
+  const uint32_t msec = clock_ms();
+  if (timer_rescan || deadline_reached(msec, timer_next_deadline)) {
+    timer_dispatch(msec);
   }
   return msec;
 }
@@ -20,23 +20,67 @@
 #include <arpa/inet.h>
 #include <errno.h>
 #include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "emulator.h"
 
 #define TREZOR_UDP_PORT 54935
 
+// Selects the transport:
+//   udp (default)  64-byte datagrams on TREZOR_UDP_PORT and the next port
+//   tcp            whole messages over TCP on the same ports
+//   unix:PATH      whole messages over Unix sockets PATH and PATH.debug
+// The stream transports carry each message as "##" <msg_id:2> <len:4>
+// followed by the payload, without splitting it into 64-byte packets.
+#define ENV_TRANSPORT "TREZOR_TRANSPORT"
+
+#define PACKET_SIZE 64
+// datagrams received or sent with a single recvmmsg/sendmmsg call
+#define BATCH_SIZE 32
+// header "##" <msg_id:2> <len:4>
+#define FRAME_HEADER_SIZE 8
+#define STREAM_RX_SIZE (FRAME_HEADER_SIZE + 64 * 1024)
+#define STREAM_TX_SIZE (4 * 1024)
+
 struct usb_socket {
   int fd;
   struct sockaddr_in from;
   socklen_t fromlen;
+
+  // datagrams received but not handed to the firmware yet
+  uint8_t rx[BATCH_SIZE][PACKET_SIZE];
+  size_t rx_len[BATCH_SIZE];
+  struct sockaddr_in rx_from[BATCH_SIZE];
+  socklen_t rx_fromlen[BATCH_SIZE];
+  int rx_count;
+  int rx_pos;
+
+  // datagrams waiting for the next sendmmsg
+  uint8_t tx[BATCH_SIZE][PACKET_SIZE];
+  int tx_count;
+
+  // stream transports: connected peer, buffered input and output
+  int conn;
+  uint8_t *stream_rx;
+  size_t stream_rx_len;
+  uint8_t stream_tx[STREAM_TX_SIZE];
+  size_t stream_tx_len;
+  // bytes of the current outgoing message still expected in later packets
+  uint32_t stream_tx_remaining;
 };
 
 static struct usb_socket usb_main;
 static struct usb_socket usb_debug;
+static struct usb_socket *const usb_sockets[2] = {&usb_main, &usb_debug};
 
-static struct pollfd usb_fds[2];
+static bool stream_mode = false;
 
 static int socket_setup(int port) {
   int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
@@ -58,6 +102,78 @@ static int socket_setup(int port) {
   return fd;
 }
 
+static int stream_setup_tcp(int port) {
+  int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (fd < 0) {
+    perror("Failed to create socket");
+    exit(1);
+  }
+
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  struct sockaddr_in addr = {0};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+      listen(fd, 1) != 0) {
+    perror("Failed to bind socket");
+    exit(1);
+  }
+
+  return fd;
+}
+
+static int stream_setup_unix(const char *path) {
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    perror("Failed to create socket");
+    exit(1);
+  }
+
+  struct sockaddr_un addr = {0};
+  addr.sun_family = AF_UNIX;
+  if (strlcpy(addr.sun_path, path, sizeof(addr.sun_path)) >=
+      sizeof(addr.sun_path)) {
+    fprintf(stderr, "Socket path too long: %s\n", path);
+    exit(1);
+  }
+  unlink(path);
+
+  if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+      listen(fd, 1) != 0) {
+    perror("Failed to bind socket");
+    exit(1);
+  }
+
+  return fd;
+}
+
+static void socket_flush(struct usb_socket *sock) {
+  if (sock->tx_count == 0) {
+    return;
+  }
+  if (sock->fromlen > 0) {
+    struct mmsghdr msgs[BATCH_SIZE] = {0};
+    struct iovec iovs[BATCH_SIZE] = {0};
+    for (int i = 0; i < sock->tx_count; i++) {
+      iovs[i].iov_base = sock->tx[i];
+      iovs[i].iov_len = PACKET_SIZE;
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+      msgs[i].msg_hdr.msg_name = &sock->from;
+      msgs[i].msg_hdr.msg_namelen = sock->fromlen;
+    }
+    int n = sendmmsg(sock->fd, msgs, sock->tx_count, MSG_DONTWAIT);
+    if (n != sock->tx_count) {
+      perror("Failed to write socket");
+    }
+  }
+  sock->tx_count = 0;
+}
+
 static size_t socket_write(struct usb_socket *sock, const void *buffer,
                            size_t size) {
   if (sock->fromlen > 0) {
@@ -72,62 +188,322 @@ static size_t socket_write(struct usb_socket *sock, const void *buffer,
   return size;
 }
 
-static size_t socket_read(struct usb_socket *sock, void *buffer, size_t size) {
-  sock->fromlen = sizeof(sock->from);
-  ssize_t n = recvfrom(sock->fd, buffer, size, MSG_DONTWAIT,
-                       (struct sockaddr *)&sock->from, &sock->fromlen);
+static size_t socket_queue(struct usb_socket *sock, const void *buffer,
+                           size_t size) {
+  if (size != PACKET_SIZE) {
+    socket_flush(sock);
+    return socket_write(sock, buffer, size);
+  }
+  memcpy(sock->tx[sock->tx_count], buffer, PACKET_SIZE);
+  sock->tx_count++;
+  if (sock->tx_count == BATCH_SIZE) {
+    socket_flush(sock);
+  }
+  return size;
+}
 
+// Receive all datagrams that are ready with one recvmmsg call.
+static void socket_fill(struct usb_socket *sock) {
+  struct mmsghdr msgs[BATCH_SIZE] = {0};
+  struct iovec iovs[BATCH_SIZE] = {0};
+  for (int i = 0; i < BATCH_SIZE; i++) {
+    iovs[i].iov_base = sock->rx[i];
+    iovs[i].iov_len = PACKET_SIZE;
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    msgs[i].msg_hdr.msg_name = &sock->rx_from[i];
+    msgs[i].msg_hdr.msg_namelen = sizeof(sock->rx_from[i]);
+  }
+
+  int n = recvmmsg(sock->fd, msgs, BATCH_SIZE, MSG_DONTWAIT, NULL);
   if (n < 0) {
     if (errno != EAGAIN && errno != EWOULDBLOCK) {
       perror("Failed to read socket");
     }
-    return 0;
+    n = 0;
   }
+  for (int i = 0; i < n; i++) {
+    sock->rx_len[i] = msgs[i].msg_len;
+    sock->rx_fromlen[i] = msgs[i].msg_hdr.msg_namelen;
+  }
+  sock->rx_count = n;
+  sock->rx_pos = 0;
+}
 
+static size_t socket_read(struct usb_socket *sock, void *buffer, size_t size) {
   static const char msg_ping[] = {'P', 'I', 'N', 'G', 'P', 'I', 'N', 'G'};
   static const char msg_pong[] = {'P', 'O', 'N', 'G', 'P', 'O', 'N', 'G'};
 
-  if (n == sizeof(msg_ping) &&
-      memcmp(buffer, msg_ping, sizeof(msg_ping)) == 0) {
-    socket_write(sock, msg_pong, sizeof(msg_pong));
+  while (sock->rx_pos < sock->rx_count) {
+    int i = sock->rx_pos++;
+    sock->from = sock->rx_from[i];
+    sock->fromlen = sock->rx_fromlen[i];
+
+    size_t n = sock->rx_len[i];
+    if (n == sizeof(msg_ping) &&
+        memcmp(sock->rx[i], msg_ping, sizeof(msg_ping)) == 0) {
+      socket_flush(sock);
+      socket_write(sock, msg_pong, sizeof(msg_pong));
+      continue;
+    }
+
+    n = n < size ? n : size;
+    memcpy(buffer, sock->rx[i], n);
+    return n;
+  }
+
+  return 0;
+}
+
+static void stream_close(struct usb_socket *sock) {
+  if (sock->conn >= 0) {
+    close(sock->conn);
+  }
+  sock->conn = -1;
+  sock->stream_rx_len = 0;
+  sock->stream_tx_len = 0;
+  sock->stream_tx_remaining = 0;
+}
+
+static void stream_accept(struct usb_socket *sock) {
+  int conn = accept(sock->fd, NULL, NULL);
+  if (conn < 0) {
+    perror("Failed to accept connection");
+    return;
+  }
+  // a new host replaces the previous one
+  stream_close(sock);
+  sock->conn = conn;
+}
+
+static void stream_flush(struct usb_socket *sock) {
+  size_t pos = 0;
+  while (sock->conn >= 0 && pos < sock->stream_tx_len) {
+    ssize_t n = send(sock->conn, sock->stream_tx + pos,
+                     sock->stream_tx_len - pos, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      perror("Failed to write socket");
+      stream_close(sock);
+      return;
+    }
+    pos += n;
+  }
+  sock->stream_tx_len = 0;
+}
+
+static void stream_append(struct usb_socket *sock, const uint8_t *data,
+                          size_t size) {
+  if (sock->stream_tx_len + size > sizeof(sock->stream_tx)) {
+    stream_flush(sock);
+  }
+  memcpy(sock->stream_tx + sock->stream_tx_len, data, size);
+  sock->stream_tx_len += size;
+}
+
+// Turn 64-byte packets from the firmware back into whole messages: strip the
+// '?' report marker of every packet and the padding after the last one.
+static size_t stream_write(struct usb_socket *sock, const uint8_t *packet,
+                           size_t size) {
+  if (sock->conn < 0) {
+    return size;
+  }
+  if (size != PACKET_SIZE || packet[0] != '?') {
+    return 0;
+  }
+
+  const uint8_t *data = packet + 1;
+  uint32_t len = PACKET_SIZE - 1;
+  if (sock->stream_tx_remaining == 0) {
+    if (data[0] != '#' || data[1] != '#') {
+      return 0;
+    }
+    sock->stream_tx_remaining =
+        FRAME_HEADER_SIZE + (((uint32_t)data[4] << 24) | (data[5] << 16) |
+                             (data[6] << 8) | data[7]);
+  }
+  if (len > sock->stream_tx_remaining) {
+    len = sock->stream_tx_remaining;
+  }
+  stream_append(sock, data, len);
+  sock->stream_tx_remaining -= len;
+  return size;
+}
+
+// Hand out the first complete message in the receive buffer, if any.
+static size_t stream_take(struct usb_socket *sock, void *buffer, size_t size) {
+  if (sock->stream_rx_len < FRAME_HEADER_SIZE) {
+    return 0;
+  }
+  const uint8_t *rx = sock->stream_rx;
+  if (rx[0] != '#' || rx[1] != '#') {
+    fprintf(stderr, "Invalid message header, closing connection\n");
+    stream_close(sock);
+    return 0;
+  }
+  size_t len = FRAME_HEADER_SIZE + (((uint32_t)rx[4] << 24) | (rx[5] << 16) |
+                                    (rx[6] << 8) | rx[7]);
+  if (len > STREAM_RX_SIZE || len > size) {
+    fprintf(stderr, "Message too big, closing connection\n");
+    stream_close(sock);
+    return 0;
+  }
+  if (sock->stream_rx_len < len) {
+    return 0;
+  }
+  memcpy(buffer, rx, len);
+  sock->stream_rx_len -= len;
+  memmove(sock->stream_rx, sock->stream_rx + len, sock->stream_rx_len);
+  return len;
+}
+
+static void stream_fill(struct usb_socket *sock) {
+  ssize_t n = recv(sock->conn, sock->stream_rx + sock->stream_rx_len,
+                   STREAM_RX_SIZE - sock->stream_rx_len, MSG_DONTWAIT);
+  if (n == 0) {
+    // host disconnected
+    stream_close(sock);
+  } else if (n < 0) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+      perror("Failed to read socket");
+      stream_close(sock);
+    }
+  } else {
+    sock->stream_rx_len += n;
+  }
+}
+
+static size_t stream_read(int *iface, void *buffer, size_t size,
+                          int timeout_ms) {
+  for (int i = 0; i < 2; i++) {
+    size_t n = stream_take(usb_sockets[i], buffer, size);
+    if (n > 0) {
+      *iface = i;
+      return n;
+    }
+  }
+
+  struct pollfd fds[4] = {0};
+  for (int i = 0; i < 2; i++) {
+    fds[i].fd = usb_sockets[i]->fd;
+    fds[i].events = POLLIN;
+    // poll ignores negative descriptors
+    fds[2 + i].fd = usb_sockets[i]->conn;
+    fds[2 + i].events = POLLIN;
+  }
+  if (poll(fds, 4, timeout_ms) <= 0) {
     return 0;
   }
 
-  return n;
+  for (int i = 0; i < 2; i++) {
+    struct usb_socket *sock = usb_sockets[i];
+    if (fds[2 + i].revents & (POLLIN | POLLHUP | POLLERR)) {
+      stream_fill(sock);
+    }
+    if (fds[i].revents & POLLIN) {
+      stream_accept(sock);
+    }
+    size_t n = stream_take(sock, buffer, size);
+    if (n > 0) {
+      *iface = i;
+      return n;
+    }
+  }
+  return 0;
+}
+
+static void stream_init(struct usb_socket *sock, int fd) {
+  sock->fd = fd;
+  sock->conn = -1;
+  sock->stream_rx = malloc(STREAM_RX_SIZE);
+  if (sock->stream_rx == NULL) {
+    perror("Failed to allocate buffer");
+    exit(1);
+  }
 }
 
 void emulatorSocketInit(void) {
-  usb_main.fd = socket_setup(TREZOR_UDP_PORT);
-  usb_main.fromlen = 0;
-  usb_fds[0].fd = usb_main.fd;
-  usb_fds[0].events = POLLIN;
+  const char *transport = getenv(ENV_TRANSPORT);
 
-  usb_debug.fd = socket_setup(TREZOR_UDP_PORT + 1);
-  usb_debug.fromlen = 0;
-  usb_fds[1].fd = usb_debug.fd;
-  usb_fds[1].events = POLLIN;
+  if (transport == NULL || strcmp(transport, "udp") == 0) {
+    usb_main.fd = socket_setup(TREZOR_UDP_PORT);
+    usb_main.fromlen = 0;
+    usb_debug.fd = socket_setup(TREZOR_UDP_PORT + 1);
+    usb_debug.fromlen = 0;
+  } else if (strcmp(transport, "tcp") == 0) {
+    stream_mode = true;
+    stream_init(&usb_main, stream_setup_tcp(TREZOR_UDP_PORT));
+    stream_init(&usb_debug, stream_setup_tcp(TREZOR_UDP_PORT + 1));
+  } else if (strncmp(transport, "unix:", 5) == 0) {
+    char path[sizeof(((struct sockaddr_un *)0)->sun_path)] = {0};
+    stream_mode = true;
+    strlcpy(path, transport + 5, sizeof(path));
+    stream_init(&usb_main, stream_setup_unix(path));
+    strlcat(path, ".debug", sizeof(path));
+    stream_init(&usb_debug, stream_setup_unix(path));
+  } else {
+    fprintf(stderr, "Unknown %s: %s\n", ENV_TRANSPORT, transport);
+    exit(1);
+  }
 }
 
+bool emulatorSocketIsStream(void) { return stream_mode; }
+
 size_t emulatorSocketRead(int *iface, void *buffer, size_t size,
                           int timeout_ms) {
-  if (poll(usb_fds, 2, timeout_ms) > 0) {
-    if (usb_fds[0].revents & POLLIN) {
-      *iface = 0;
-      return socket_read(&usb_main, buffer, size);
-    } else if (usb_fds[1].revents & POLLIN) {
-      *iface = 1;
-      return socket_read(&usb_debug, buffer, size);
+  // the host may be waiting for these before it sends anything
+  emulatorSocketFlush();
+
+  if (stream_mode) {
+    return stream_read(iface, buffer, size, timeout_ms);
+  }
+
+  for (int i = 0; i < 2; i++) {
+    size_t n = socket_read(usb_sockets[i], buffer, size);
+    if (n > 0) {
+      *iface = i;
+      return n;
+    }
+  }
+
+  struct pollfd fds[2] = {0};
+  for (int i = 0; i < 2; i++) {
+    fds[i].fd = usb_sockets[i]->fd;
+    fds[i].events = POLLIN;
+  }
+  if (poll(fds, 2, timeout_ms) > 0) {
+    for (int i = 0; i < 2; i++) {
+      if (fds[i].revents & POLLIN) {
+        socket_fill(usb_sockets[i]);
+        size_t n = socket_read(usb_sockets[i], buffer, size);
+        if (n > 0) {
+          *iface = i;
+          return n;
+        }
+      }
     }
   }
   return 0;
 }
 
 size_t emulatorSocketWrite(int iface, const void *buffer, size_t size) {
-  if (iface == 0) {
-    return socket_write(&usb_main, buffer, size);
+  if (iface != 0 && iface != 1) {
+    return 0;
   }
-  if (iface == 1) {
-    return socket_write(&usb_debug, buffer, size);
+  if (stream_mode) {
+    return stream_write(usb_sockets[iface], buffer, size);
+  }
+  return socket_queue(usb_sockets[iface], buffer, size);
+}
+
+void emulatorSocketFlush(void) {
+  for (int i = 0; i < 2; i++) {
+    if (stream_mode) {
+      stream_flush(usb_sockets[i]);
+    } else {
+      socket_flush(usb_sockets[i]);
+    }
   }
-  return 0;
 }
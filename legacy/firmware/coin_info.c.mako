@@ -13,6 +13,13 @@ def defined(s):
 
 def hex(x):
 	return "0x{:08x}".format(c_int(x))
+
+def sorted_index(key):
+	# positions in coins[] ordered by key; equal keys keep their table order,
+	# so a lower bound search finds the same coin as a linear scan
+	return ", ".join(str(i) for i, _ in sorted(enumerate(coins_list), key=lambda e: (key(e[1]), e[0])))
+
+coins_list = list(supported_on("trezor1", bitcoin))
 %>\
 // This file is automatically generated from coin_info.c.mako
 // DO NOT EDIT
@@ -23,7 +30,7 @@ def hex(x):
 #include "secp256k1.h"
 
 const CoinInfo coins[COINS_COUNT] = {
-% for c in supported_on("trezor1", bitcoin):
+% for c in coins_list:
 {
 	.coin_name = ${c_str(c.coin_name)},
 	.coin_shortcut = ${c_str(c.coin_shortcut)},
@@ -55,3 +62,9 @@ const CoinInfo coins[COINS_COUNT] = {
 },
 % endfor
 };
+
+const uint8_t coins_by_name[COINS_COUNT] = {${sorted_index(lambda c: c.coin_name.encode())}};
+
+const uint8_t coins_by_address_type[COINS_COUNT] = {${sorted_index(lambda c: c.address_type)}};
+
+const uint8_t coins_by_slip44[COINS_COUNT] = {${sorted_index(lambda c: c_int(c.slip44) | 0x80000000)}};
@@ -11,4 +11,10 @@
 
 extern const CoinInfo coins[COINS_COUNT];
 
+// Positions in coins[] sorted by coin_name (strcmp order), address_type and
+// coin_type. Coins with equal keys keep their order from coins[].
+extern const uint8_t coins_by_name[COINS_COUNT];
+extern const uint8_t coins_by_address_type[COINS_COUNT];
+extern const uint8_t coins_by_slip44[COINS_COUNT];
+
 #endif
@@ -23,23 +23,51 @@
 #include "base58.h"
 #include "ecdsa.h"
 
-const CoinInfo *coinByName(const char *name) {
-  if (!name) return 0;
-  for (int i = 0; i < COINS_COUNT; i++) {
-    if (strcmp(name, coins[i].coin_name) == 0) {
-      return &(coins[i]);
+_Static_assert(COINS_COUNT <= 256, "coin index does not fit in uint8_t");
+
+// Binary search in one of the coin indices from coin_info.c. Returns the
+// first coin with a matching key in coins[] order, like a linear scan would.
+static const CoinInfo *coinSearch(const uint8_t *index,
+                                  int (*compare)(const CoinInfo *coin,
+                                                 const void *key),
+                                  const void *key) {
+  size_t lo = 0, hi = COINS_COUNT;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (compare(&coins[index[mid]], key) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
     }
   }
+  if (lo < COINS_COUNT && compare(&coins[index[lo]], key) == 0) {
+    return &coins[index[lo]];
+  }
   return 0;
 }
 
+static int compareName(const CoinInfo *coin, const void *key) {
+  return strcmp(coin->coin_name, (const char *)key);
+}
+
+static int compareAddressType(const CoinInfo *coin, const void *key) {
+  uint32_t address_type = *(const uint32_t *)key;
+  return (coin->address_type > address_type) -
+         (coin->address_type < address_type);
+}
+
+static int compareSlip44(const CoinInfo *coin, const void *key) {
+  uint32_t coin_type = *(const uint32_t *)key;
+  return (coin->coin_type > coin_type) - (coin->coin_type < coin_type);
+}
+
+const CoinInfo *coinByName(const char *name) {
+  if (!name) return 0;
+  return coinSearch(coins_by_name, compareName, name);
+}
+
 const CoinInfo *coinByAddressType(uint32_t address_type) {
-  for (int i = 0; i < COINS_COUNT; i++) {
-    if (address_type == coins[i].address_type) {
-      return &(coins[i]);
-    }
-  }
-  return 0;
+  return coinSearch(coins_by_address_type, compareAddressType, &address_type);
 }
 
 const CoinInfo *coinBySlip44(uint32_t coin_type) {
@@ -49,12 +77,7 @@ const CoinInfo *coinBySlip44(uint32_t coin_type) {
     return coinByName("Testnet");
   }
 
-  for (int i = 0; i < COINS_COUNT; i++) {
-    if (coin_type == coins[i].coin_type) {
-      return &(coins[i]);
-    }
-  }
-  return 0;
+  return coinSearch(coins_by_slip44, compareSlip44, &coin_type);
 }
 
 bool coinExtractAddressType(const CoinInfo *coin, const char *addr,
@@ -30,6 +30,7 @@
 #include "cardano.h"
 #include "common.h"
 #include "config.h"
+#include "ethereum_definitions_store.h"
 
 #include "bip39.h"
 #include "firmware/algo/parser_txdef.h"
@@ -45,6 +46,7 @@
 #include "rng.h"
 #include "se_chip.h"
 #include "secbool.h"
+#include "signing.h"
 #include "usb.h"
 #include "util.h"
 
@@ -507,6 +509,8 @@ bool session_isUnlocked(void) {
 
 void session_clear(bool lock) {
   se_sessionClear();
+  fsm_clearPublicKeyCache();
+  signing_clear_prevout_cache();
 
   if (lock) {
     config_lockDevice();
@@ -643,6 +647,9 @@ void config_wipe(void) {
   session_clear(false);
   fsm_abortWorkflows();
   fsm_clearCosiNonce();
+#if !BITCOIN_ONLY
+  ethereum_definitions_store_wipe();
+#endif
   config_getLanguage(config_language, sizeof(config_language));
 
   change_ble_sta(BLE_ADV_ON);
@@ -33,6 +33,7 @@
 #include "config_emu.h"
 #include "curves.h"
 #include "debug.h"
+#include "ethereum_definitions_store.h"
 #include "font.h"
 #include "fsm.h"
 #include "gettext.h"
@@ -48,6 +49,7 @@
 #include "rng.h"
 #include "se_chip.h"
 #include "sha2.h"
+#include "signing.h"
 #include "storage.h"
 #include "supervise.h"
 #include "timer.h"
@@ -543,6 +545,8 @@ void session_clear(bool lock) {
     session_clearCache(sessionsCache + i);
   }
   activeSessionCache = NULL;
+  fsm_clearPublicKeyCache();
+  signing_clear_prevout_cache();
   if (lock) {
     config_lockDevice();
   }
@@ -1121,12 +1125,12 @@ bool config_unlock(const char *pin) {
   } else {
     char oldTiny = usbTiny(1);
 #if !EMULATOR
-    register_timer("usbpoll", timer1s / 30, usbPoll);
+    timer_handle usbpoll_timer = register_timer(timer1s / 30, usbPoll, true);
 #endif
     secbool ret =
         storage_unlock((const uint8_t *)pin, strnlen(pin, MAX_PIN_LEN), NULL);
 #if !EMULATOR
-    unregister_timer("usbpoll");
+    unregister_timer(&usbpoll_timer);
 #endif
     usbTiny(oldTiny);
     return sectrue == ret;
@@ -1415,6 +1419,9 @@ void config_wipe(void) {
   session_clear(false);
   fsm_abortWorkflows();
   fsm_clearCosiNonce();
+#if !BITCOIN_ONLY
+  ethereum_definitions_store_wipe();
+#endif
 
 #if USE_BIP32_CACHE
   bip32_cache_clear();
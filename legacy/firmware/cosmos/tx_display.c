@@ -4,6 +4,11 @@
 
 #define NUM_REQUIRED_ROOT_PAGES 7
 
+// Every displayed item is a leaf token, so there cannot be more items than
+// tokens. Keys repeat across messages and share one buffer.
+#define DISPLAY_ITEMS_MAX MAX_NUMBER_OF_TOKENS
+#define DISPLAY_ITEMS_KEYS_SIZE 384
+
 const char *get_required_root_item(root_item_e i) {
   switch (i) {
     case root_item_chain_id:
@@ -57,6 +62,16 @@ typedef struct {
   uint8_t root_item_number_subitems[NUM_REQUIRED_ROOT_PAGES];
 
   bool is_default_chain;
+
+  // key and value token of every display item, in display order. Items are
+  // recorded by tx_display_query as they are first looked up, and once all
+  // of them are recorded, queries no longer traverse the JSON tree.
+  uint8_t item_count;
+  uint16_t item_value_token_idx[DISPLAY_ITEMS_MAX];
+  uint16_t item_key_offset[DISPLAY_ITEMS_MAX];
+  char item_keys[DISPLAY_ITEMS_KEYS_SIZE];
+  uint16_t item_keys_len;
+  bool items_complete;
 } display_cache_t;
 
 display_cache_t display_cache;
@@ -372,12 +387,54 @@ parser_error_t tx_display_numItems(uint8_t *num_items) {
   return parser_ok;
 }
 
+static void record_display_item(uint16_t displayIdx, uint8_t num_items,
+                                const char *key, uint16_t value_token_index) {
+  if (display_cache.items_complete || displayIdx != display_cache.item_count) {
+    return;
+  }
+
+  // Reuse the key if an earlier item has the same one
+  uint16_t key_offset = 0;
+  while (key_offset < display_cache.item_keys_len &&
+         strcmp(display_cache.item_keys + key_offset, key) != 0) {
+    key_offset += strlen(display_cache.item_keys + key_offset) + 1;
+  }
+  if (key_offset >= display_cache.item_keys_len) {
+    const size_t key_size = strlen(key) + 1;
+    if (display_cache.item_keys_len + key_size > DISPLAY_ITEMS_KEYS_SIZE) {
+      return;
+    }
+    memcpy(display_cache.item_keys + key_offset, key, key_size);
+    display_cache.item_keys_len += key_size;
+  }
+
+  display_cache.item_key_offset[displayIdx] = key_offset;
+  display_cache.item_value_token_idx[displayIdx] = value_token_index;
+  display_cache.item_count++;
+  display_cache.items_complete = display_cache.item_count == num_items;
+}
+
 // This function assumes that the tx_ctx has been set properly
 parser_error_t tx_display_query(uint16_t displayIdx, char *outKey,
                                 uint16_t outKeyLen,
                                 uint16_t *ret_value_token_index) {
   CHECK_PARSER_ERR(tx_indexRootFields())
 
+  if (display_cache.items_complete) {
+    if (displayIdx >= display_cache.item_count) {
+      return parser_display_idx_out_of_range;
+    }
+
+    static char tmp_val[2];
+    INIT_QUERY_CONTEXT(outKey, outKeyLen, tmp_val, sizeof(tmp_val), 0, 0)
+    strncpy_s(outKey,
+              display_cache.item_keys +
+                  display_cache.item_key_offset[displayIdx],
+              outKeyLen);
+    *ret_value_token_index = display_cache.item_value_token_idx[displayIdx];
+    return parser_ok;
+  }
+
   uint8_t num_items;
   CHECK_PARSER_ERR(tx_display_numItems(&num_items))
 
@@ -407,6 +464,8 @@ parser_error_t tx_display_query(uint16_t displayIdx, char *outKey,
       tx_traverse_find(display_cache.root_item_start_token_idx[root_index],
                        ret_value_token_index))
 
+  record_display_item(displayIdx, num_items, outKey, *ret_value_token_index);
+
   return parser_ok;
 }
 
@@ -34,20 +34,62 @@ const CosmosNetworkType cosmos_networks[COSMOS_NETWORK_COUNT] = {
     {"celestia", "celestia", "Celestia", "TIA", "utia", 6},
 };
 
-const CosmosNetworkType *cosmosnetworkByChainId(const char *chain_id) {
-  for (int i = 0; i < COSMOS_NETWORK_COUNT; i++) {
-    if (memcmp(chain_id, cosmos_networks[i].chain_id, strlen(chain_id)) == 0) {
-      return &(cosmos_networks[i]);
+// Indices into cosmos_networks, sorted by chain_id and by hrp. Keep in sync
+// with the table above when adding a network; test_registries checks that
+// they list every network in order.
+static const uint8_t cosmos_networks_by_chain_id[COSMOS_NETWORK_COUNT] = {
+    14, 3,  18, 15, 29, 10, 0, 4,  13, 24, 28, 21, 25, 5,  8,
+    12, 16, 26, 1,  27, 9,  2, 11, 7,  6,  19, 17, 23, 22, 20,
+};
+
+static const uint8_t cosmos_networks_by_hrp[COSMOS_NETWORK_COUNT] = {
+    14, 3,  18, 15, 29, 7, 0,  4, 13, 24, 28, 21, 8,  25, 12,
+    16, 26, 1,  10, 27, 9, 2,  11, 6, 19, 5,  17, 23, 22, 20,
+};
+
+static const char *cosmosnetworkChainId(uint8_t i) {
+  return cosmos_networks[i].chain_id;
+}
+
+static const char *cosmosnetworkHrp(uint8_t i) {
+  return cosmos_networks[i].hrp;
+}
+
+// Returns the first network in table order whose key starts with prefix.
+// Keys sharing a prefix are adjacent in the sorted index, so only the run
+// starting at the lower bound needs to be looked at.
+static const CosmosNetworkType *cosmosnetworkSearch(
+    const uint8_t *index, const char *(*key)(uint8_t), const char *prefix) {
+  size_t len = strlen(prefix);
+  int lo = 0, hi = COSMOS_NETWORK_COUNT;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (strcmp(key(index[mid]), prefix) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
     }
   }
-  return NULL;
+  int found = COSMOS_NETWORK_COUNT;
+  for (; lo < COSMOS_NETWORK_COUNT; lo++) {
+    if (strncmp(key(index[lo]), prefix, len) != 0) {
+      break;
+    }
+    if (index[lo] < found) {
+      found = index[lo];
+    }
+  }
+  if (found == COSMOS_NETWORK_COUNT) {
+    return NULL;
+  }
+  return &(cosmos_networks[found]);
+}
+
+const CosmosNetworkType *cosmosnetworkByChainId(const char *chain_id) {
+  return cosmosnetworkSearch(cosmos_networks_by_chain_id, cosmosnetworkChainId,
+                             chain_id);
 }
 
 const CosmosNetworkType *cosmosnetworkByHrp(const char *hrp) {
-  for (int i = 0; i < COSMOS_NETWORK_COUNT; i++) {
-    if (memcmp(hrp, cosmos_networks[i].hrp, strlen(hrp)) == 0) {
-      return &(cosmos_networks[i]);
-    }
-  }
-  return NULL;
+  return cosmosnetworkSearch(cosmos_networks_by_hrp, cosmosnetworkHrp, hrp);
 }
@@ -26,6 +26,7 @@
 #include "coins.h"
 #include "curves.h"
 #include "hmac.h"
+#include "memzero.h"
 #include "layout.h"
 #include "pbkdf2.h"
 #include "secp256k1.h"
@@ -325,6 +326,75 @@ int cryptoMessageVerify(const CoinInfo *coin, const uint8_t *message,
   return 0;
 }
 
+// Public derivations of cosigner xpubs, shared by all inputs and change
+// outputs of a transaction. Parent nodes (all but the last path element) are
+// kept apart from the leaves, so that the leaves of every new input do not
+// evict the parents they are derived from.
+#define MULTISIG_CACHE_SIZE 16
+
+typedef struct {
+  bool set;
+  uint8_t id[SHA256_DIGEST_LENGTH];
+  uint32_t depth;
+  uint32_t child_num;
+  uint8_t chain_code[32];
+  uint8_t public_key[33];
+} MultisigCacheEntry;
+
+typedef struct {
+  MultisigCacheEntry entries[MULTISIG_CACHE_SIZE];
+  int index;
+} MultisigCache;
+
+static MultisigCache multisig_parent_cache;
+static MultisigCache multisig_leaf_cache;
+
+void cryptoMultisigCacheClear(void) {
+  memzero(&multisig_parent_cache, sizeof(multisig_parent_cache));
+  memzero(&multisig_leaf_cache, sizeof(multisig_leaf_cache));
+}
+
+static void multisig_cache_id(const char *curve_name, const HDNodeType *xpub,
+                              const uint32_t *address_n,
+                              uint32_t address_n_count, uint8_t *id) {
+  SHA256_CTX ctx = {0};
+  sha256_Init(&ctx);
+  sha256_Update(&ctx, (const uint8_t *)curve_name, strlen(curve_name) + 1);
+  sha256_Update(&ctx, (const uint8_t *)&(xpub->depth), sizeof(uint32_t));
+  sha256_Update(&ctx, (const uint8_t *)&(xpub->child_num), sizeof(uint32_t));
+  sha256_Update(&ctx, xpub->chain_code.bytes, 32);
+  sha256_Update(&ctx, xpub->public_key.bytes, 33);
+  sha256_Update(&ctx, (const uint8_t *)&address_n_count, sizeof(uint32_t));
+  sha256_Update(&ctx, (const uint8_t *)address_n,
+                address_n_count * sizeof(uint32_t));
+  sha256_Final(&ctx, id);
+}
+
+static bool multisig_cache_load(const MultisigCache *cache, const uint8_t *id,
+                                const char *curve_name, HDNode *node) {
+  for (int i = 0; i < MULTISIG_CACHE_SIZE; i++) {
+    const MultisigCacheEntry *entry = &(cache->entries[i]);
+    if (entry->set && memcmp(entry->id, id, sizeof(entry->id)) == 0) {
+      return hdnode_from_xpub(entry->depth, entry->child_num,
+                              entry->chain_code, entry->public_key,
+                              curve_name, node) == 1;
+    }
+  }
+  return false;
+}
+
+static void multisig_cache_store(MultisigCache *cache, const uint8_t *id,
+                                 const HDNode *node) {
+  MultisigCacheEntry *entry = &(cache->entries[cache->index]);
+  entry->set = true;
+  memcpy(entry->id, id, sizeof(entry->id));
+  entry->depth = node->depth;
+  entry->child_num = node->child_num;
+  memcpy(entry->chain_code, node->chain_code, 32);
+  memcpy(entry->public_key, node->public_key, 33);
+  cache->index = (cache->index + 1) % MULTISIG_CACHE_SIZE;
+}
+
 const HDNode *cryptoMultisigPubkey(const CoinInfo *coin,
                                    const MultisigRedeemScriptType *multisig,
                                    uint32_t index) {
@@ -351,18 +421,42 @@ const HDNode *cryptoMultisigPubkey(const CoinInfo *coin,
   if (node_ptr->chain_code.size != 32) return 0;
   if (node_ptr->public_key.size != 33) return 0;
   static HDNode node;
-  if (!hdnode_from_xpub(node_ptr->depth, node_ptr->child_num,
+
+  uint8_t leaf_id[SHA256_DIGEST_LENGTH] = {0};
+  multisig_cache_id(coin->curve_name, node_ptr, address_n, address_n_count,
+                    leaf_id);
+  if (multisig_cache_load(&multisig_leaf_cache, leaf_id, coin->curve_name,
+                          &node)) {
+    return &node;
+  }
+
+  uint8_t parent_id[SHA256_DIGEST_LENGTH] = {0};
+  uint32_t derived = 0;
+  if (address_n_count > 1) {
+    multisig_cache_id(coin->curve_name, node_ptr, address_n,
+                      address_n_count - 1, parent_id);
+    if (multisig_cache_load(&multisig_parent_cache, parent_id,
+                            coin->curve_name, &node)) {
+      derived = address_n_count - 1;
+    }
+  }
+  if (derived == 0 &&
+      !hdnode_from_xpub(node_ptr->depth, node_ptr->child_num,
                         node_ptr->chain_code.bytes, node_ptr->public_key.bytes,
                         coin->curve_name, &node)) {
     return 0;
   }
   // layoutProgressUpdate(true);
-  for (uint32_t i = 0; i < address_n_count; i++) {
+  for (uint32_t i = derived; i < address_n_count; i++) {
     if (!hdnode_public_ckd(&node, address_n[i])) {
       return 0;
     }
+    if (i + 2 == address_n_count) {
+      multisig_cache_store(&multisig_parent_cache, parent_id, &node);
+    }
     // layoutProgressUpdate(true);
   }
+  multisig_cache_store(&multisig_leaf_cache, leaf_id, &node);
   return &node;
 }
 
@@ -84,6 +84,9 @@ const HDNode *cryptoMultisigPubkey(const CoinInfo *coin,
 
 uint32_t cryptoMultisigPubkeyCount(const MultisigRedeemScriptType *multisig);
 
+// Forget the cosigner public keys derived by cryptoMultisigPubkey.
+void cryptoMultisigCacheClear(void);
+
 int cryptoMultisigPubkeyIndex(const CoinInfo *coin,
                               const MultisigRedeemScriptType *multisig,
                               const uint8_t *pubkey);
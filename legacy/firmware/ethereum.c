@@ -1120,9 +1120,9 @@ int ethereum_message_verify(const EthereumVerifyMessage *msg) {
  * EIP-712 hashes might have no message_hash if primaryType="EIP712Domain".
  * In this case, set has_message_hash=false.
  */
-static void ethereum_typed_hash(const uint8_t domain_separator_hash[32],
-                                const uint8_t message_hash[32],
-                                bool has_message_hash, uint8_t hash[32]) {
+void ethereum_typed_hash(const uint8_t domain_separator_hash[32],
+                         const uint8_t message_hash[32], bool has_message_hash,
+                         uint8_t hash[32]) {
   struct SHA3_CTX ctx = {0};
   sha3_256_Init(&ctx);
   sha3_Update(&ctx, (const uint8_t *)"\x19\x01", 2);
@@ -39,10 +39,14 @@ void ethereum_signing_txack(const EthereumTxAck *msg);
 void ethereum_message_sign(const EthereumSignMessage *msg, const HDNode *node,
                            EthereumMessageSignature *resp);
 int ethereum_message_verify(const EthereumVerifyMessage *msg);
+void ethereum_typed_hash(const uint8_t domain_separator_hash[32],
+                         const uint8_t message_hash[32], bool has_message_hash,
+                         uint8_t hash[32]);
 void ethereum_typed_hash_sign(const EthereumSignTypedHash *msg,
                               const HDNode *node,
                               EthereumTypedDataSignature *resp);
 bool ethereum_parse(const char *address, uint8_t pubkeyhash[20]);
+int ethereum_is_canonic(uint8_t v, uint8_t signature[64]);
 
 bool ethereum_path_check(uint32_t address_n_count, const uint32_t *address_n,
                          bool pubkey_export,
@@ -24,6 +24,7 @@
 #include "ethereum.h"
 #include "ethereum_definitions.h"
 #include "ethereum_definitions_constants.h"
+#include "ethereum_definitions_store.h"
 #include "ethereum_networks.h"
 #include "ethereum_tokens.h"
 #include "fsm.h"
@@ -60,6 +61,20 @@ const ed25519_public_key DEFS_PUBLIC_KEYS_DEV[DEFS_PUBLIC_KEYS_COUNT] = {
 };
 #endif
 
+void ethereum_definitions_key_id(uint8_t id[ETHEREUM_DEFINITIONS_KEY_ID_LEN]) {
+  uint8_t hash[SHA256_DIGEST_LENGTH] = {0};
+  SHA256_CTX context = {0};
+  sha256_Init(&context);
+  sha256_Update(&context, (const uint8_t *)DEFS_PUBLIC_KEYS,
+                sizeof(DEFS_PUBLIC_KEYS));
+#if DEBUG_LINK
+  sha256_Update(&context, (const uint8_t *)DEFS_PUBLIC_KEYS_DEV,
+                sizeof(DEFS_PUBLIC_KEYS_DEV));
+#endif
+  sha256_Final(&context, hash);
+  memcpy(id, hash, ETHEREUM_DEFINITIONS_KEY_ID_LEN);
+}
+
 struct EncodedDefinition {
   // prefix
   pb_byte_t format_version[FORMAT_VERSION_LENGTH];
@@ -125,34 +140,8 @@ static bool parse_encoded_definition(struct EncodedDefinition *const result,
   return true;
 }
 
-static bool decode_definition(const pb_size_t size, const pb_byte_t *bytes,
-                              const EthereumDefinitionType expected_type,
-                              void *definition) {
-  // parse received definition
-  static struct EncodedDefinition parsed_def;
-  const char *error_str = "Invalid Ethereum definition";
-
-  memzero(&parsed_def, sizeof(parsed_def));
-  if (!parse_encoded_definition(&parsed_def, size, bytes)) {
-    goto err;
-  }
-
-  // check definition fields
-  if (memcmp(FORMAT_VERSION, parsed_def.format_version,
-             FORMAT_VERSION_LENGTH)) {
-    goto err;
-  }
-
-  if (expected_type != parsed_def.definition_type) {
-    error_str = "Definition type mismatch";
-    goto err;
-  }
-
-  if (MIN_DATA_VERSION > parsed_def.data_version) {
-    error_str = "Definition is outdated";
-    goto err;
-  }
-
+static bool verify_definition(const pb_byte_t *bytes,
+                              const struct EncodedDefinition *parsed_def) {
   // compute Merkle tree root hash from proof
   uint8_t hash[SHA256_DIGEST_LENGTH] = {0};
   SHA256_CTX context = {0};
@@ -161,23 +150,24 @@ static bool decode_definition(const pb_size_t size, const pb_byte_t *bytes,
   // leaf hash = sha256('\x00' + leaf data)
   sha256_Update(&context, (uint8_t[]){0}, 1);
   // signed data is everything from start of `bytes` to the end of `payload`
-  const pb_byte_t *payload_end = parsed_def.payload + parsed_def.payload_length;
+  const pb_byte_t *payload_end =
+      parsed_def->payload + parsed_def->payload_length;
   size_t signed_data_size = payload_end - bytes;
   sha256_Update(&context, bytes, signed_data_size);
 
   sha256_Final(&context, hash);
 
   const uint8_t *min, *max;
-  for (uint8_t i = 0; i < parsed_def.proof_length; i++) {
+  for (uint8_t i = 0; i < parsed_def->proof_length; i++) {
     sha256_Init(&context);
     // node hash = sha256('\x01' + min(hash, next_proof) + max(hash,
     // next_proof))
     sha256_Update(&context, (uint8_t[]){1}, 1);
-    if (memcmp(hash, parsed_def.proof[i], SHA256_DIGEST_LENGTH) <= 0) {
+    if (memcmp(hash, parsed_def->proof[i], SHA256_DIGEST_LENGTH) <= 0) {
       min = hash;
-      max = parsed_def.proof[i];
+      max = parsed_def->proof[i];
     } else {
-      min = parsed_def.proof[i];
+      min = parsed_def->proof[i];
       max = hash;
     }
     sha256_Update(&context, min, SHA256_DIGEST_LENGTH);
@@ -186,16 +176,54 @@ static bool decode_definition(const pb_size_t size, const pb_byte_t *bytes,
   }
 
   // and verify its signature
-  if (!cryptoCosiVerify(parsed_def.signature, hash, sizeof(hash),
+  if (!cryptoCosiVerify(parsed_def->signature, hash, sizeof(hash),
                         SIGNATURE_THRESHOLD, DEFS_PUBLIC_KEYS,
-                        DEFS_PUBLIC_KEYS_COUNT, parsed_def.sigmask)
+                        DEFS_PUBLIC_KEYS_COUNT, parsed_def->sigmask)
 #if DEBUG_LINK
-      && !cryptoCosiVerify(parsed_def.signature, hash, sizeof(hash),
+      && !cryptoCosiVerify(parsed_def->signature, hash, sizeof(hash),
                            SIGNATURE_THRESHOLD, DEFS_PUBLIC_KEYS_DEV,
-                           DEFS_PUBLIC_KEYS_COUNT, parsed_def.sigmask)
+                           DEFS_PUBLIC_KEYS_COUNT, parsed_def->sigmask)
 #endif
   ) {
     // invalid signature
+    return false;
+  }
+  return true;
+}
+
+static bool decode_definition(const pb_size_t size, const pb_byte_t *bytes,
+                              const EthereumDefinitionType expected_type,
+                              void *definition) {
+  // parse received definition
+  static struct EncodedDefinition parsed_def;
+  const char *error_str = "Invalid Ethereum definition";
+
+  memzero(&parsed_def, sizeof(parsed_def));
+  if (!parse_encoded_definition(&parsed_def, size, bytes)) {
+    goto err;
+  }
+
+  // check definition fields
+  if (memcmp(FORMAT_VERSION, parsed_def.format_version,
+             FORMAT_VERSION_LENGTH)) {
+    goto err;
+  }
+
+  if (expected_type != parsed_def.definition_type) {
+    error_str = "Definition type mismatch";
+    goto err;
+  }
+
+  if (MIN_DATA_VERSION > parsed_def.data_version) {
+    error_str = "Definition is outdated";
+    goto err;
+  }
+
+  // a definition found in the store has been verified before
+  bool stored = ethereum_definitions_store_contains(
+      expected_type, parsed_def.data_version, parsed_def.payload,
+      parsed_def.payload_length);
+  if (!stored && !verify_definition(bytes, &parsed_def)) {
     error_str = "Invalid definition signature";
     goto err;
   }
@@ -208,6 +236,11 @@ static bool decode_definition(const pb_size_t size, const pb_byte_t *bytes,
       pb_istream_from_buffer(parsed_def.payload, parsed_def.payload_length);
   bool status = pb_decode(&stream, fields, definition);
   if (status) {
+    if (!stored) {
+      ethereum_definitions_store_put(expected_type, parsed_def.data_version,
+                                     parsed_def.payload,
+                                     parsed_def.payload_length, definition);
+    }
     return true;
   }
 
@@ -243,9 +276,18 @@ static const EthereumNetworkInfo *get_network(
     // match to the encoded definition, so just short-circuit here
     return &UNKNOWN_NETWORK;
   }
-  // if we found built-in definition, or if there's no data to decode, we are
-  // done
-  if (!is_unknown_network(network) || encoded_network == NULL) {
+  // if we found built-in definition we are done
+  if (!is_unknown_network(network)) {
+    return network;
+  }
+
+  // if there's no data to decode, try a definition received earlier
+  if (encoded_network == NULL) {
+    memzero(&decoded_network, sizeof(decoded_network));
+    if (ethereum_definitions_store_get_network(chain_id, slip44,
+                                               &decoded_network)) {
+      return &decoded_network;
+    }
     return network;
   }
 
@@ -292,8 +334,18 @@ static const EthereumTokenInfo *get_token(const EncodedToken *encoded_token,
   // try to get built-in definition
   const EthereumTokenInfo *token =
       ethereum_token_by_address(chain_id, address_bytes.bytes);
-  if (!is_unknown_token(token) || encoded_token == NULL) {
-    // if we found one, or if there's no data to decode, we are done
+  if (!is_unknown_token(token)) {
+    // if we found one, we are done
+    return token;
+  }
+
+  if (encoded_token == NULL) {
+    // if there's no data to decode, try a definition received earlier
+    memzero(&decoded_token, sizeof(decoded_token));
+    if (ethereum_definitions_store_get_token(chain_id, address_bytes.bytes,
+                                             &decoded_token)) {
+      return &decoded_token;
+    }
     return token;
   }
 
@@ -0,0 +1,391 @@
+/*
+ * This file is part of the Trezor project, https://trezor.io/
+ *
+ * Copyright (C) 2022 Martin Novak <martin.novak@satoshilabs.com>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "ethereum.h"
+#include "ethereum_definitions_constants.h"
+#include "ethereum_definitions_store.h"
+#include "flash.h"
+#include "memory.h"
+#include "memzero.h"
+#include "pb_decode.h"
+
+// The store is a log of records in the flash sector between the firmware code
+// and the font. Records are appended and deleted by clearing their state word.
+// When the sector is full, it is erased and the log starts over; the dropped
+// definitions are simply verified again the next time they are sent. Only up
+// to STORE_MAX_ENTRIES live records are kept; the oldest one is deleted to make
+// room for a new one.
+//
+// All live records have the same data version, i.e. come from the same
+// signing of the definitions. Storing a newer definition evicts all the older
+// ones, and a firmware with a newer MIN_DATA_VERSION drops them on load.
+//
+// The header names the keys the records were verified with. A firmware that
+// trusts other keys, e.g. a production firmware finding the store of a debug
+// build that also accepts development keys, erases the store on load.
+
+#define STORE_SECTOR FLASH_ETH_DEFS_SECTOR
+
+#define STORE_MAGIC 0x44485445  // "ETHD"
+#define STORE_FORMAT_VERSION 2
+// magic + format version + key id
+#define STORE_HEADER_LEN (8 + ETHEREUM_DEFINITIONS_KEY_ID_LEN)
+
+#define STORE_MAX_ENTRIES 32
+#define STORE_MAX_PAYLOAD 512
+
+#define RECORD_FREE 0xFFFFFFFF
+#define RECORD_VALID 0x5AA55AA5
+#define RECORD_DELETED 0x00000000
+
+typedef struct {
+  uint32_t state;
+  uint8_t type;
+  uint8_t reserved;
+  uint16_t payload_length;
+  uint32_t data_version;
+  uint32_t slip44;
+  uint64_t chain_id;
+  uint8_t address[20];
+} StoreRecord;  // followed by the payload, padded to a multiple of 4 bytes
+
+_Static_assert(sizeof(StoreRecord) % 4 == 0, "StoreRecord is not aligned");
+_Static_assert(STORE_HEADER_LEN % 4 == 0, "store header is not aligned");
+
+typedef struct {
+  uint64_t chain_id;
+  uint32_t offset;
+  uint8_t type;
+} StoreEntry;
+
+static bool store_loaded = false;
+static bool store_usable = false;
+static uint32_t store_end = 0;
+static uint32_t store_data_version = 0;
+static StoreEntry store_index[STORE_MAX_ENTRIES];
+static uint8_t store_count = 0;
+
+static uint32_t record_size(uint16_t payload_length) {
+  return sizeof(StoreRecord) + ((payload_length + 3) & ~3);
+}
+
+static bool read_record(uint32_t offset, StoreRecord *record) {
+  const void *data =
+      flash_get_address(STORE_SECTOR, offset, sizeof(StoreRecord));
+  if (data == NULL) {
+    return false;
+  }
+  memcpy(record, data, sizeof(StoreRecord));
+  return true;
+}
+
+static const uint8_t *record_payload(uint32_t offset,
+                                     uint16_t payload_length) {
+  return flash_get_address(STORE_SECTOR, offset + sizeof(StoreRecord),
+                           payload_length);
+}
+
+static bool read_header(const uint8_t key_id[ETHEREUM_DEFINITIONS_KEY_ID_LEN]) {
+  const uint32_t *header =
+      flash_get_address(STORE_SECTOR, 0, STORE_HEADER_LEN);
+  return header != NULL && header[0] == STORE_MAGIC &&
+         header[1] == STORE_FORMAT_VERSION &&
+         memcmp(&header[2], key_id, ETHEREUM_DEFINITIONS_KEY_ID_LEN) == 0;
+}
+
+static bool write_words(uint32_t offset, const void *data, uint32_t length) {
+  const uint8_t *bytes = data;
+  bool success = (flash_unlock_write() == sectrue);
+  for (uint32_t i = 0; success && i < length; i += 4) {
+    uint32_t word = 0xFFFFFFFF;
+    memcpy(&word, bytes + i, length - i < 4 ? length - i : 4);
+    success = (flash_write_word(STORE_SECTOR, offset + i, word) == sectrue);
+  }
+  return (flash_lock_write() == sectrue) && success;
+}
+
+// Erases the sector and starts an empty log.
+static bool store_reset(void) {
+  store_usable = false;
+  store_count = 0;
+  store_end = STORE_HEADER_LEN;
+
+  uint8_t key_id[ETHEREUM_DEFINITIONS_KEY_ID_LEN] = {0};
+  ethereum_definitions_key_id(key_id);
+  const uint32_t format = STORE_FORMAT_VERSION;
+  const uint32_t magic = STORE_MAGIC;
+  // the magic goes last, so that an interrupted reset leaves no valid header
+  if (flash_erase(STORE_SECTOR) != sectrue ||
+      !write_words(4, &format, sizeof(format)) ||
+      !write_words(8, key_id, sizeof(key_id)) ||
+      !write_words(0, &magic, sizeof(magic))) {
+    return false;
+  }
+  store_usable = true;
+  return true;
+}
+
+static void index_remove(uint8_t i) {
+  store_count--;
+  memmove(&store_index[i], &store_index[i + 1],
+          (store_count - i) * sizeof(StoreEntry));
+}
+
+static void delete_record(uint8_t i) {
+  const uint32_t state = RECORD_DELETED;
+  // if the write fails, the record is only dropped from the index and comes
+  // back on next load, which is harmless
+  write_words(store_index[i].offset, &state, sizeof(state));
+  index_remove(i);
+}
+
+static void delete_all_records(void) {
+  while (store_count > 0) {
+    delete_record(store_count - 1);
+  }
+}
+
+static void store_load(void) {
+  if (store_loaded) {
+    return;
+  }
+  store_loaded = true;
+
+  uint8_t key_id[ETHEREUM_DEFINITIONS_KEY_ID_LEN] = {0};
+  ethereum_definitions_key_id(key_id);
+  if (!read_header(key_id)) {
+    store_reset();
+    return;
+  }
+  store_usable = true;
+
+  // Scan the log. Anything that does not look like a record, e.g. one whose
+  // write was interrupted, ends it; the next append then fails and starts the
+  // log over.
+  const uint32_t sector_size = flash_sector_size(STORE_SECTOR);
+  uint32_t offset = STORE_HEADER_LEN;
+  StoreRecord record = {0};
+  while (read_record(offset, &record) && record.state != RECORD_FREE) {
+    if ((record.state != RECORD_VALID && record.state != RECORD_DELETED) ||
+        record.payload_length > STORE_MAX_PAYLOAD ||
+        offset + record_size(record.payload_length) > sector_size) {
+      break;
+    }
+    if (record.state == RECORD_VALID) {
+      if (record.data_version < MIN_DATA_VERSION ||
+          record.data_version < store_data_version) {
+        const uint32_t state = RECORD_DELETED;
+        write_words(offset, &state, sizeof(state));
+      } else {
+        if (record.data_version > store_data_version) {
+          delete_all_records();
+          store_data_version = record.data_version;
+        }
+        if (store_count == STORE_MAX_ENTRIES) {
+          delete_record(0);
+        }
+        store_index[store_count].chain_id = record.chain_id;
+        store_index[store_count].offset = offset;
+        store_index[store_count].type = record.type;
+        store_count++;
+      }
+    }
+    offset += record_size(record.payload_length);
+  }
+  store_end = offset;
+}
+
+static bool store_append(const StoreRecord *record, const uint8_t *payload) {
+  uint32_t size = record_size(record->payload_length);
+  if (store_end + size > flash_sector_size(STORE_SECTOR)) {
+    return false;
+  }
+
+  // the state word goes last, so that an interrupted write leaves no record
+  uint32_t offset = store_end;
+  store_end = flash_sector_size(STORE_SECTOR);
+  if (!write_words(offset + 4, (const uint8_t *)record + 4,
+                   sizeof(StoreRecord) - 4) ||
+      !write_words(offset + sizeof(StoreRecord), payload,
+                   record->payload_length) ||
+      !write_words(offset, &record->state, sizeof(record->state))) {
+    return false;
+  }
+  store_end = offset + size;
+
+  store_index[store_count].chain_id = record->chain_id;
+  store_index[store_count].offset = offset;
+  store_index[store_count].type = record->type;
+  store_count++;
+  return true;
+}
+
+static bool record_matches(uint8_t i, const StoreRecord *key) {
+  if (store_index[i].type != key->type ||
+      store_index[i].chain_id != key->chain_id) {
+    return false;
+  }
+  if (key->type != EthereumDefinitionType_TOKEN) {
+    return true;
+  }
+  StoreRecord record = {0};
+  return read_record(store_index[i].offset, &record) &&
+         memcmp(record.address, key->address, sizeof(record.address)) == 0;
+}
+
+bool ethereum_definitions_store_contains(EthereumDefinitionType type,
+                                         uint32_t data_version,
+                                         const uint8_t *payload,
+                                         uint16_t payload_length) {
+  store_load();
+  if (!store_usable || data_version != store_data_version) {
+    return false;
+  }
+  for (uint8_t i = 0; i < store_count; i++) {
+    StoreRecord record = {0};
+    if (store_index[i].type != type ||
+        !read_record(store_index[i].offset, &record) ||
+        record.payload_length != payload_length) {
+      continue;
+    }
+    const uint8_t *stored = record_payload(store_index[i].offset,
+                                           record.payload_length);
+    if (stored != NULL && memcmp(stored, payload, payload_length) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ethereum_definitions_store_put(EthereumDefinitionType type,
+                                    uint32_t data_version,
+                                    const uint8_t *payload,
+                                    uint16_t payload_length,
+                                    const void *definition) {
+  if (payload_length > STORE_MAX_PAYLOAD) {
+    return;
+  }
+  store_load();
+  if (!store_usable || data_version < store_data_version) {
+    return;
+  }
+  if (data_version > store_data_version) {
+    delete_all_records();
+    store_data_version = data_version;
+  }
+
+  StoreRecord record = {0};
+  memset(&record, 0xFF, sizeof(record));
+  record.state = RECORD_VALID;
+  record.type = type;
+  record.payload_length = payload_length;
+  record.data_version = data_version;
+  if (type == EthereumDefinitionType_NETWORK) {
+    const EthereumNetworkInfo *network = definition;
+    record.chain_id = network->chain_id;
+    record.slip44 = network->slip44;
+  } else {
+    const EthereumTokenInfo *token = definition;
+    if (token->address.size != sizeof(record.address)) {
+      return;
+    }
+    record.chain_id = token->chain_id;
+    memcpy(record.address, token->address.bytes, sizeof(record.address));
+  }
+
+  for (uint8_t i = 0; i < store_count; i++) {
+    if (record_matches(i, &record)) {
+      delete_record(i);
+      break;
+    }
+  }
+  if (store_count == STORE_MAX_ENTRIES) {
+    delete_record(0);
+  }
+  if (!store_append(&record, payload) && store_reset()) {
+    store_append(&record, payload);
+  }
+}
+
+static bool decode_record(uint8_t i, const pb_msgdesc_t *fields,
+                          void *definition) {
+  StoreRecord record = {0};
+  if (!read_record(store_index[i].offset, &record)) {
+    return false;
+  }
+  const uint8_t *payload =
+      record_payload(store_index[i].offset, record.payload_length);
+  if (payload == NULL) {
+    return false;
+  }
+  pb_istream_t stream = pb_istream_from_buffer(payload, record.payload_length);
+  return pb_decode(&stream, fields, definition);
+}
+
+bool ethereum_definitions_store_get_network(uint64_t chain_id, uint32_t slip44,
+                                            EthereumNetworkInfo *network) {
+  store_load();
+  for (uint8_t i = 0; store_usable && i < store_count; i++) {
+    if (store_index[i].type != EthereumDefinitionType_NETWORK) {
+      continue;
+    }
+    if (chain_id != CHAIN_ID_UNKNOWN) {
+      if (store_index[i].chain_id != chain_id) {
+        continue;
+      }
+    } else {
+      StoreRecord record = {0};
+      if (!read_record(store_index[i].offset, &record) ||
+          record.slip44 != slip44) {
+        continue;
+      }
+    }
+    memzero(network, sizeof(*network));
+    return decode_record(i, EthereumNetworkInfo_fields, network);
+  }
+  return false;
+}
+
+bool ethereum_definitions_store_get_token(uint64_t chain_id,
+                                          const uint8_t address[20],
+                                          EthereumTokenInfo *token) {
+  StoreRecord key = {0};
+  key.type = EthereumDefinitionType_TOKEN;
+  key.chain_id = chain_id;
+  memcpy(key.address, address, sizeof(key.address));
+
+  store_load();
+  for (uint8_t i = 0; store_usable && i < store_count; i++) {
+    if (record_matches(i, &key)) {
+      memzero(token, sizeof(*token));
+      return decode_record(i, EthereumTokenInfo_fields, token);
+    }
+  }
+  return false;
+}
+
+void ethereum_definitions_store_wipe(void) {
+  store_load();
+  if (store_usable) {
+    delete_all_records();
+  }
+  store_data_version = 0;
+}
@@ -0,0 +1,65 @@
+/*
+ * This file is part of the Trezor project, https://trezor.io/
+ *
+ * Copyright (C) 2022 Martin Novak <martin.novak@satoshilabs.com>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ETHEREUM_DEFINITIONS_STORE_H__
+#define __ETHEREUM_DEFINITIONS_STORE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "messages-ethereum-definitions.pb.h"
+
+// Flash store of definitions whose signature has already been verified, so
+// that a host may omit them from later requests, and a re-sent definition
+// does not have to be verified again.
+
+#define ETHEREUM_DEFINITIONS_KEY_ID_LEN 8
+
+// Identifies the set of keys definitions are verified with. Stored definitions
+// verified with another set are dropped. Implemented in ethereum_definitions.c.
+void ethereum_definitions_key_id(uint8_t id[ETHEREUM_DEFINITIONS_KEY_ID_LEN]);
+
+// Returns true if exactly this payload of this data version is stored.
+bool ethereum_definitions_store_contains(EthereumDefinitionType type,
+                                         uint32_t data_version,
+                                         const uint8_t *payload,
+                                         uint16_t payload_length);
+
+// Stores a verified definition. `definition` is the decoded payload, either
+// EthereumNetworkInfo or EthereumTokenInfo according to `type`.
+void ethereum_definitions_store_put(EthereumDefinitionType type,
+                                    uint32_t data_version,
+                                    const uint8_t *payload,
+                                    uint16_t payload_length,
+                                    const void *definition);
+
+// Decodes a stored network definition matching chain_id, or slip44 if
+// chain_id is CHAIN_ID_UNKNOWN.
+bool ethereum_definitions_store_get_network(uint64_t chain_id, uint32_t slip44,
+                                            EthereumNetworkInfo *network);
+
+// Decodes a stored token definition matching chain_id and address.
+bool ethereum_definitions_store_get_token(uint64_t chain_id,
+                                          const uint8_t address[20],
+                                          EthereumTokenInfo *token);
+
+// Deletes all stored definitions.
+void ethereum_definitions_store_wipe(void);
+
+#endif
@@ -0,0 +1,743 @@
+/*
+ * This file is part of the Trezor project, https://trezor.io/
+ *
+ * Copyright (C) 2016 Alex Beregszaszi <alex@rtfs.hu>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ethereum_typed_data.h"
+#include <stdio.h>
+#include <string.h>
+#include "ecdsa.h"
+#include "ethereum.h"
+#include "fsm.h"
+#include "gettext.h"
+#include "layout2.h"
+#include "memzero.h"
+#include "messages.h"
+#include "protect.h"
+#include "secp256k1.h"
+#include "sha3.h"
+#include "util.h"
+
+/*
+ * EIP-712 typed data is streamed from the host the same way as in core:
+ * the device first asks for every struct definition it needs
+ * (EthereumTypedDataStructRequest) and then for every atomic value by its
+ * member path (EthereumTypedDataValueRequest). Only the type definitions are
+ * kept. Values are hashed as they arrive into a stack of keccak contexts, one
+ * per struct or array that is being encoded, so the memory used does not
+ * depend on the length of the arrays or on the size of the document.
+ */
+
+#define TYPED_DATA_MAX_STRUCTS 16
+#define TYPED_DATA_MAX_MEMBERS 64
+// Longest member path the device asks for, the root index included.
+#define TYPED_DATA_MAX_DEPTH 8
+// Struct names and their "Name(type member,...)" encodings.
+#define TYPED_DATA_POOL_SIZE 1536
+
+#define TYPED_DATA_DOMAIN "EIP712Domain"
+
+_Static_assert(sizeof(((EthereumTypedDataValueRequest *)NULL)->member_path) ==
+                   TYPED_DATA_MAX_DEPTH * sizeof(uint32_t),
+               "member_path size mismatch");
+_Static_assert(TYPED_DATA_MAX_STRUCTS <= 32, "struct mask too small");
+
+typedef struct {
+  uint8_t data_type;
+  uint8_t size;  // integers and fixed bytes: size in bytes, otherwise 0
+  uint8_t entry_type;
+  uint8_t entry_size;
+  uint8_t struct_index;  // structs and arrays of structs
+  bool dynamic_array;
+  uint16_t array_size;
+} TypedMember;
+
+typedef struct {
+  uint16_t name;      // offset of the name in pool
+  uint16_t encoding;  // offset of the encodeType of this struct alone in pool
+  uint8_t first_member;
+  uint8_t member_count;
+  bool defined;
+  uint8_t type_hash[32];
+} TypedStruct;
+
+// A struct or an array being hashed. Structs inside arrays are encoded
+// straight into the array context when metamask_v4_compat is off, then out
+// points to the context of the enclosing array.
+typedef struct {
+  struct SHA3_CTX ctx;
+  struct SHA3_CTX *out;
+  bool is_array;
+  uint8_t struct_index;
+  uint8_t entry_type;
+  uint8_t entry_size;
+  uint16_t index;
+  uint16_t count;
+} TypedFrame;
+
+static bool typed_data_signing = false;
+static bool collecting;
+static bool metamask_v4_compat;
+static bool pending_array_length;
+static uint8_t requested_struct;
+static uint8_t primary_struct;
+static uint8_t root_index;
+static uint8_t domain_separator_hash[32];
+static uint8_t message_hash[32];
+static int domain_name_member;
+static char domain_name[33];
+static char signer_address[43];
+
+static TypedStruct structs[TYPED_DATA_MAX_STRUCTS];
+static uint8_t struct_count;
+static TypedMember members[TYPED_DATA_MAX_MEMBERS];
+static uint8_t member_count;
+static char pool[TYPED_DATA_POOL_SIZE];
+static uint16_t pool_used;
+static TypedFrame stack[TYPED_DATA_MAX_DEPTH - 1];
+static uint8_t depth;
+
+static CONFIDENTIAL HDNode *_node = NULL;
+#if EMULATOR
+static CONFIDENTIAL uint8_t privkey[32];
+#endif
+
+static void typed_data_fail(FailureType code, const char *text) {
+  fsm_sendFailure(code, text);
+  ethereum_typed_data_abort();
+}
+
+static bool pool_append(const char *str, size_t len) {
+  if (pool_used + len + 1 > sizeof(pool)) {
+    return false;
+  }
+  memcpy(pool + pool_used, str, len);
+  pool_used += len;
+  pool[pool_used] = 0;
+  return true;
+}
+
+static bool pool_append_str(const char *str) {
+  return pool_append(str, strlen(str));
+}
+
+static int typed_data_find_struct(const char *name) {
+  for (int i = 0; i < struct_count; i++) {
+    if (strcmp(pool + structs[i].name, name) == 0) {
+      return i;
+    }
+  }
+  if (struct_count == TYPED_DATA_MAX_STRUCTS) {
+    return -1;
+  }
+  uint16_t offset = pool_used;
+  if (!pool_append_str(name)) {
+    return -1;
+  }
+  pool_used++;  // keep the terminator
+  memzero(&structs[struct_count], sizeof(TypedStruct));
+  structs[struct_count].name = offset;
+  return struct_count++;
+}
+
+// Mirrors validate_field_type() in core/src/apps/ethereum/sign_typed_data.py.
+static bool typed_data_check_type(EthereumDataType data_type, bool has_size,
+                                  uint32_t size, bool has_struct_name) {
+  switch (data_type) {
+    case EthereumDataType_STRUCT:
+      return has_size && has_struct_name;
+    case EthereumDataType_BYTES:
+      return !has_struct_name && (!has_size || (size >= 1 && size <= 32));
+    case EthereumDataType_UINT:
+    case EthereumDataType_INT:
+      return !has_struct_name && has_size && size >= 1 && size <= 32;
+    case EthereumDataType_STRING:
+    case EthereumDataType_BOOL:
+    case EthereumDataType_ADDRESS:
+      return !has_struct_name && !has_size;
+    case EthereumDataType_ARRAY:
+      return !has_struct_name;
+    default:
+      return false;
+  }
+}
+
+static bool typed_data_append_type(EthereumDataType data_type, bool has_size,
+                                   uint32_t size, const char *struct_name) {
+  char buf[12] = {0};
+  switch (data_type) {
+    case EthereumDataType_UINT:
+      snprintf(buf, sizeof(buf), "uint%u", (unsigned)size * 8);
+      return pool_append_str(buf);
+    case EthereumDataType_INT:
+      snprintf(buf, sizeof(buf), "int%u", (unsigned)size * 8);
+      return pool_append_str(buf);
+    case EthereumDataType_BYTES:
+      if (has_size) {
+        snprintf(buf, sizeof(buf), "bytes%u", (unsigned)size);
+        return pool_append_str(buf);
+      }
+      return pool_append_str("bytes");
+    case EthereumDataType_STRING:
+      return pool_append_str("string");
+    case EthereumDataType_BOOL:
+      return pool_append_str("bool");
+    case EthereumDataType_ADDRESS:
+      return pool_append_str("address");
+    case EthereumDataType_STRUCT:
+      return pool_append_str(struct_name);
+    default:
+      return false;
+  }
+}
+
+// Adds a struct member to the member table and its "type name" to the
+// encoding that is being built in the pool.
+static const char *typed_data_add_member(const EthereumStructMember *msg) {
+  const EthereumFieldType *type = &msg->type;
+  if (!typed_data_check_type(type->data_type, type->has_size, type->size,
+                             type->has_struct_name)) {
+    return "Invalid field type";
+  }
+  if ((type->data_type == EthereumDataType_ARRAY) != type->has_entry_type) {
+    return "Invalid field type";
+  }
+  if (member_count == TYPED_DATA_MAX_MEMBERS) {
+    return "Too many struct members";
+  }
+
+  TypedMember *member = &members[member_count++];
+  memzero(member, sizeof(TypedMember));
+  member->data_type = type->data_type;
+  member->size = type->data_type == EthereumDataType_STRUCT ? 0 : type->size;
+
+  EthereumDataType data_type = type->data_type;
+  bool has_size = type->has_size;
+  uint32_t size = type->size;
+  const char *struct_name = type->struct_name;
+  if (data_type == EthereumDataType_ARRAY) {
+    const EthereumFieldEntryType *entry = &type->entry_type;
+    if (entry->data_type == EthereumDataType_ARRAY) {
+      return "Nested arrays are not supported";
+    }
+    if (!typed_data_check_type(entry->data_type, entry->has_size, entry->size,
+                               entry->has_struct_name)) {
+      return "Invalid field type";
+    }
+    if (type->has_size && type->size > UINT16_MAX) {
+      return "Array too long";
+    }
+    member->dynamic_array = !type->has_size;
+    member->array_size = type->size;
+    member->entry_type = entry->data_type;
+    member->entry_size =
+        entry->data_type == EthereumDataType_STRUCT ? 0 : entry->size;
+    data_type = entry->data_type;
+    has_size = entry->has_size;
+    size = entry->size;
+    struct_name = entry->struct_name;
+  }
+
+  if (data_type == EthereumDataType_STRUCT) {
+    int index = typed_data_find_struct(struct_name);
+    if (index < 0) {
+      return "Typed data too large";
+    }
+    member->struct_index = index;
+  }
+
+  if (!typed_data_append_type(data_type, has_size, size, struct_name)) {
+    return "Typed data too large";
+  }
+  if (member->data_type == EthereumDataType_ARRAY) {
+    char buf[8] = {0};
+    if (member->dynamic_array) {
+      buf[0] = '[';
+      buf[1] = ']';
+    } else {
+      snprintf(buf, sizeof(buf), "[%u]", (unsigned)member->array_size);
+    }
+    if (!pool_append_str(buf)) {
+      return "Typed data too large";
+    }
+  }
+  if (!pool_append_str(" ") || !pool_append_str(msg->name)) {
+    return "Typed data too large";
+  }
+  return NULL;
+}
+
+// Bitmask of the structs referenced by index, directly or not, index included.
+static uint32_t typed_data_dependencies(uint8_t index) {
+  uint32_t found = 1u << index;
+  uint32_t todo = found;
+  while (todo) {
+    uint8_t i = __builtin_ctz(todo);
+    todo &= todo - 1;
+    const TypedStruct *s = &structs[i];
+    for (int j = s->first_member; j < s->first_member + s->member_count; j++) {
+      const TypedMember *member = &members[j];
+      if (member->data_type != EthereumDataType_STRUCT &&
+          member->entry_type != EthereumDataType_STRUCT) {
+        continue;
+      }
+      uint32_t bit = 1u << member->struct_index;
+      if (!(found & bit)) {
+        found |= bit;
+        todo |= bit;
+      }
+    }
+  }
+  return found;
+}
+
+// typeHash = keccak256(encodeType), where encodeType is the struct itself
+// followed by all the structs it references, sorted by name.
+static void typed_data_type_hash(uint8_t index) {
+  struct SHA3_CTX ctx = {0};
+  sha3_256_Init(&ctx);
+  sha3_Update(&ctx, (const uint8_t *)pool + structs[index].encoding,
+              strlen(pool + structs[index].encoding));
+
+  uint32_t todo = typed_data_dependencies(index) & ~(1u << index);
+  while (todo) {
+    int next = -1;
+    for (int i = 0; i < struct_count; i++) {
+      if ((todo & (1u << i)) &&
+          (next < 0 ||
+           strcmp(pool + structs[i].name, pool + structs[next].name) < 0)) {
+        next = i;
+      }
+    }
+    todo &= ~(1u << next);
+    sha3_Update(&ctx, (const uint8_t *)pool + structs[next].encoding,
+                strlen(pool + structs[next].encoding));
+  }
+  keccak_Final(&ctx, structs[index].type_hash);
+}
+
+static bool typed_data_push_struct(uint8_t index, bool inline_encoding) {
+  if (depth == TYPED_DATA_MAX_DEPTH - 1) {
+    typed_data_fail(FailureType_Failure_DataError, "Typed data too deep");
+    return false;
+  }
+  TypedFrame *frame = &stack[depth++];
+  frame->is_array = false;
+  frame->struct_index = index;
+  frame->index = 0;
+  frame->count = structs[index].member_count;
+  if (inline_encoding) {
+    frame->out = stack[depth - 2].out;
+  } else {
+    sha3_256_Init(&frame->ctx);
+    frame->out = &frame->ctx;
+    sha3_Update(frame->out, structs[index].type_hash, 32);
+  }
+  return true;
+}
+
+static bool typed_data_push_array(const TypedMember *member, uint16_t count) {
+  if (depth == TYPED_DATA_MAX_DEPTH - 1) {
+    typed_data_fail(FailureType_Failure_DataError, "Typed data too deep");
+    return false;
+  }
+  TypedFrame *frame = &stack[depth++];
+  frame->is_array = true;
+  frame->struct_index = member->struct_index;
+  frame->entry_type = member->entry_type;
+  frame->entry_size = member->entry_size;
+  frame->index = 0;
+  frame->count = count;
+  sha3_256_Init(&frame->ctx);
+  frame->out = &frame->ctx;
+  return true;
+}
+
+// Finishes the struct or array on top of the stack and feeds its hash to the
+// parent. Returns the hash of the root struct once the stack is empty.
+static void typed_data_pop(uint8_t hash[32]) {
+  TypedFrame *frame = &stack[depth - 1];
+  bool inline_encoding = frame->out != &frame->ctx;
+  if (!inline_encoding) {
+    keccak_Final(&frame->ctx, hash);
+  }
+  depth--;
+  if (depth > 0) {
+    TypedFrame *parent = &stack[depth - 1];
+    if (!inline_encoding) {
+      sha3_Update(parent->out, hash, 32);
+    }
+    parent->index++;
+  }
+}
+
+static const TypedMember *typed_data_current_member(const TypedFrame *frame) {
+  return &members[structs[frame->struct_index].first_member + frame->index];
+}
+
+static void typed_data_request_value(void) {
+  EthereumTypedDataValueRequest req = {0};
+  req.member_path[0] = root_index;
+  for (int i = 0; i < depth; i++) {
+    req.member_path[i + 1] = stack[i].index;
+  }
+  req.member_path_count = depth + 1;
+  msg_write(MessageType_MessageType_EthereumTypedDataValueRequest, &req);
+}
+
+static void typed_data_sign(void) {
+  char domain_hash[65] = {0};
+  char msg_hash[65] = {0};
+  bool has_message_hash = primary_struct != 0;
+
+  if (domain_name[0]) {
+    layoutDialogSwipe(&bmp_icon_question, __("Cancel"), __("Confirm"), NULL,
+                      __("Typed data:"), pool + structs[primary_struct].name,
+                      __("Domain:"), domain_name, NULL, NULL);
+    if (!protectButton(ButtonRequestType_ButtonRequest_Other, false)) {
+      typed_data_fail(FailureType_Failure_ActionCancelled, NULL);
+      return;
+    }
+  }
+
+  data2hex(domain_separator_hash, 32, domain_hash);
+  if (has_message_hash) {
+    data2hex(message_hash, 32, msg_hash);
+  }
+  if (!fsm_layoutSignHash("Ethereum", signer_address, domain_hash,
+                          has_message_hash ? msg_hash : NULL, NULL)) {
+    typed_data_fail(FailureType_Failure_ActionCancelled, NULL);
+    return;
+  }
+
+  uint8_t hash[32] = {0};
+  ethereum_typed_hash(domain_separator_hash, message_hash, has_message_hash,
+                      hash);
+
+  EthereumTypedDataSignature resp = {0};
+  uint8_t v = 0;
+#if EMULATOR
+  if (ecdsa_sign_digest(&secp256k1, privkey, hash, resp.signature.bytes, &v,
+                        ethereum_is_canonic) != 0) {
+#else
+  if (hdnode_sign_digest(_node, hash, resp.signature.bytes, &v,
+                         ethereum_is_canonic) != 0) {
+#endif
+    typed_data_fail(FailureType_Failure_ProcessError, "Signing failed");
+    return;
+  }
+  resp.signature.bytes[64] = 27 + v;
+  resp.signature.size = 65;
+  strlcpy(resp.address, signer_address, sizeof(resp.address));
+  msg_write(MessageType_MessageType_EthereumTypedDataSignature, &resp);
+  ethereum_typed_data_abort();
+}
+
+// Walks the members until an atomic value or an array length is needed from
+// the host, pushing and popping frames on the way.
+static void typed_data_advance(void) {
+  for (;;) {
+    while (depth > 0) {
+      TypedFrame *frame = &stack[depth - 1];
+      if (frame->index == frame->count) {
+        uint8_t hash[32] = {0};
+        typed_data_pop(hash);
+        if (depth == 0) {
+          memcpy(root_index == 0 ? domain_separator_hash : message_hash, hash,
+                 32);
+        }
+        continue;
+      }
+      if (frame->is_array) {
+        if (frame->entry_type == EthereumDataType_STRUCT) {
+          if (!typed_data_push_struct(frame->struct_index,
+                                      !metamask_v4_compat)) {
+            return;
+          }
+          continue;
+        }
+        pending_array_length = false;
+      } else {
+        const TypedMember *member = typed_data_current_member(frame);
+        if (member->data_type == EthereumDataType_STRUCT) {
+          if (!typed_data_push_struct(member->struct_index, false)) {
+            return;
+          }
+          continue;
+        }
+        if (member->data_type == EthereumDataType_ARRAY &&
+            !member->dynamic_array) {
+          if (!typed_data_push_array(member, member->array_size)) {
+            return;
+          }
+          continue;
+        }
+        pending_array_length = member->data_type == EthereumDataType_ARRAY;
+      }
+      typed_data_request_value();
+      return;
+    }
+
+    if (root_index == 0 && primary_struct != 0) {
+      root_index = 1;
+      typed_data_push_struct(primary_struct, false);
+      continue;
+    }
+    typed_data_sign();
+    return;
+  }
+}
+
+static void typed_data_request_struct(void) {
+  for (int i = 0; i < struct_count; i++) {
+    if (!structs[i].defined) {
+      requested_struct = i;
+      EthereumTypedDataStructRequest req = {0};
+      strlcpy(req.name, pool + structs[i].name, sizeof(req.name));
+      msg_write(MessageType_MessageType_EthereumTypedDataStructRequest, &req);
+      return;
+    }
+  }
+
+  // All the types are known, start hashing the domain.
+  for (int i = 0; i < struct_count; i++) {
+    typed_data_type_hash(i);
+  }
+  collecting = false;
+  root_index = 0;
+  typed_data_push_struct(0, false);
+  typed_data_advance();
+}
+
+void ethereum_typed_data_init(const EthereumSignTypedData *msg,
+                              const HDNode *node, const char *address) {
+  ethereum_typed_data_abort();
+
+  memzero(structs, sizeof(structs));
+  struct_count = 0;
+  member_count = 0;
+  pool_used = 0;
+  depth = 0;
+  domain_name_member = -1;
+  memzero(domain_name, sizeof(domain_name));
+  metamask_v4_compat =
+      !msg->has_metamask_v4_compat || msg->metamask_v4_compat;
+
+  // The domain is always struct 0, so primary_struct is 0 when the domain
+  // itself is signed and there is no message hash.
+  if (typed_data_find_struct(TYPED_DATA_DOMAIN) != 0) {
+    fsm_sendFailure(FailureType_Failure_DataError, "Typed data too large");
+    layoutHome();
+    return;
+  }
+  int primary = typed_data_find_struct(msg->primary_type);
+  if (primary < 0) {
+    fsm_sendFailure(FailureType_Failure_DataError, "Typed data too large");
+    layoutHome();
+    return;
+  }
+  primary_struct = primary;
+
+  strlcpy(signer_address, address, sizeof(signer_address));
+  _node = (HDNode *)node;
+#if EMULATOR
+  memcpy(privkey, node->private_key, 32);
+#endif
+  typed_data_signing = true;
+  collecting = true;
+
+  layoutProgress(_(C__SIGNING), 0);
+  typed_data_request_struct();
+}
+
+void ethereum_typed_data_struct_ack(const EthereumTypedDataStructAck *msg) {
+  if (!typed_data_signing || !collecting) {
+    fsm_sendFailure(FailureType_Failure_UnexpectedMessage,
+                    "Not in Ethereum typed data signing mode");
+    layoutHome();
+    return;
+  }
+
+  // Register the referenced structs first, as that adds their names to the
+  // pool and the encoding of this struct is built there next.
+  for (int i = 0; i < msg->members_count; i++) {
+    const EthereumFieldType *type = &msg->members[i].type;
+    const char *struct_name = NULL;
+    if (type->data_type == EthereumDataType_STRUCT && type->has_struct_name) {
+      struct_name = type->struct_name;
+    } else if (type->data_type == EthereumDataType_ARRAY &&
+               type->has_entry_type &&
+               type->entry_type.data_type == EthereumDataType_STRUCT &&
+               type->entry_type.has_struct_name) {
+      struct_name = type->entry_type.struct_name;
+    }
+    if (struct_name && typed_data_find_struct(struct_name) < 0) {
+      typed_data_fail(FailureType_Failure_DataError, "Typed data too large");
+      return;
+    }
+  }
+
+  TypedStruct *s = &structs[requested_struct];
+  s->first_member = member_count;
+  s->member_count = msg->members_count;
+  s->encoding = pool_used;
+  if (!pool_append_str(pool + s->name) || !pool_append_str("(")) {
+    typed_data_fail(FailureType_Failure_DataError, "Typed data too large");
+    return;
+  }
+  for (int i = 0; i < msg->members_count; i++) {
+    if (i > 0 && !pool_append_str(",")) {
+      typed_data_fail(FailureType_Failure_DataError, "Typed data too large");
+      return;
+    }
+    const char *error = typed_data_add_member(&msg->members[i]);
+    if (error) {
+      typed_data_fail(FailureType_Failure_DataError, error);
+      return;
+    }
+    if (requested_struct == 0 &&
+        msg->members[i].type.data_type == EthereumDataType_STRING &&
+        strcmp(msg->members[i].name, "name") == 0) {
+      domain_name_member = i;
+    }
+  }
+  if (!pool_append_str(")")) {
+    typed_data_fail(FailureType_Failure_DataError, "Typed data too large");
+    return;
+  }
+  pool_used++;  // keep the terminator
+  s->defined = true;
+
+  typed_data_request_struct();
+}
+
+static void typed_data_write_padded(struct SHA3_CTX *ctx, const uint8_t *value,
+                                    size_t len, uint8_t pad, bool right) {
+  uint8_t padding[32] = {0};
+  memset(padding, pad, sizeof(padding));
+  if (right) {
+    sha3_Update(ctx, value, len);
+    sha3_Update(ctx, padding, 32 - len);
+  } else {
+    sha3_Update(ctx, padding, 32 - len);
+    sha3_Update(ctx, value, len);
+  }
+}
+
+// Mirrors validate_value() and encode_field() in
+// core/src/apps/ethereum/sign_typed_data.py.
+static const char *typed_data_encode_value(struct SHA3_CTX *ctx,
+                                           uint8_t data_type, uint8_t size,
+                                           const uint8_t *value, size_t len) {
+  if (size != 0 && len != size) {
+    return "Invalid length";
+  }
+  switch (data_type) {
+    case EthereumDataType_BYTES:
+      if (size != 0) {
+        typed_data_write_padded(ctx, value, len, 0, true);
+        return NULL;
+      }
+      // fall through
+    case EthereumDataType_STRING: {
+      uint8_t hash[32] = {0};
+      keccak_256(value, len, hash);
+      sha3_Update(ctx, hash, 32);
+      return NULL;
+    }
+    case EthereumDataType_INT:
+      typed_data_write_padded(ctx, value, len, (value[0] & 0x80) ? 0xff : 0,
+                              false);
+      return NULL;
+    case EthereumDataType_UINT:
+      typed_data_write_padded(ctx, value, len, 0, false);
+      return NULL;
+    case EthereumDataType_BOOL:
+      if (len != 1 || value[0] > 1) {
+        return "Invalid boolean value";
+      }
+      typed_data_write_padded(ctx, value, len, 0, false);
+      return NULL;
+    case EthereumDataType_ADDRESS:
+      if (len != 20) {
+        return "Invalid address";
+      }
+      typed_data_write_padded(ctx, value, len, 0, false);
+      return NULL;
+    default:
+      return "Invalid field type";
+  }
+}
+
+void ethereum_typed_data_value_ack(const EthereumTypedDataValueAck *msg) {
+  if (!typed_data_signing || collecting || depth == 0) {
+    fsm_sendFailure(FailureType_Failure_UnexpectedMessage,
+                    "Not in Ethereum typed data signing mode");
+    layoutHome();
+    return;
+  }
+
+  TypedFrame *frame = &stack[depth - 1];
+  if (pending_array_length) {
+    if (msg->value.size != 2) {
+      typed_data_fail(FailureType_Failure_DataError, "Invalid length");
+      return;
+    }
+    uint16_t count = (msg->value.bytes[0] << 8) | msg->value.bytes[1];
+    if (!typed_data_push_array(typed_data_current_member(frame), count)) {
+      return;
+    }
+  } else {
+    uint8_t data_type = 0, size = 0;
+    if (frame->is_array) {
+      data_type = frame->entry_type;
+      size = frame->entry_size;
+    } else {
+      const TypedMember *member = typed_data_current_member(frame);
+      data_type = member->data_type;
+      size = member->size;
+    }
+    const char *error = typed_data_encode_value(
+        frame->out, data_type, size, msg->value.bytes, msg->value.size);
+    if (error) {
+      typed_data_fail(FailureType_Failure_DataError, error);
+      return;
+    }
+    if (root_index == 0 && depth == 1 && frame->index == domain_name_member &&
+        is_valid_ascii(msg->value.bytes, msg->value.size)) {
+      size_t len = MIN(msg->value.size, sizeof(domain_name) - 1);
+      memcpy(domain_name, msg->value.bytes, len);
+      domain_name[len] = 0;
+    }
+    frame->index++;
+  }
+
+  typed_data_advance();
+}
+
+void ethereum_typed_data_abort(void) {
+  if (typed_data_signing) {
+    _node = NULL;
+#if EMULATOR
+    memzero(privkey, sizeof(privkey));
+#endif
+    memzero(stack, sizeof(stack));
+    depth = 0;
+    layoutHome();
+    typed_data_signing = false;
+  }
+}
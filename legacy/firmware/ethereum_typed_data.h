@@ -0,0 +1,32 @@
+/*
+ * This file is part of the Trezor project, https://trezor.io/
+ *
+ * Copyright (C) 2016 Alex Beregszaszi <alex@rtfs.hu>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ETHEREUM_TYPED_DATA_H__
+#define __ETHEREUM_TYPED_DATA_H__
+
+#include "bip32.h"
+#include "messages-ethereum-eip712.pb.h"
+
+void ethereum_typed_data_init(const EthereumSignTypedData *msg,
+                              const HDNode *node, const char *address);
+void ethereum_typed_data_struct_ack(const EthereumTypedDataStructAck *msg);
+void ethereum_typed_data_value_ack(const EthereumTypedDataValueAck *msg);
+void ethereum_typed_data_abort(void);
+
+#endif
@@ -1047,7 +1047,7 @@ refresh:
   uint32_t start_time = svc_timer_ms();
   bool yes_up = false;
   while (1) {
-    usbPoll();
+    usbPollWait(USB_POLL_WAIT_MS);
     buttonUpdate();
     if (button.YesUp) {
       yes_up = true;
@@ -1894,7 +1894,7 @@ uint8_t ctap_get_assertion(CborEncoder *encoder, uint8_t *request, int length) {
     uint32_t start_time = svc_timer_ms();
     bool yes_up = false;
     while (1) {
-      usbPoll();
+      usbPollWait(USB_POLL_WAIT_MS);
       buttonUpdate();
       if (button.YesUp) {
         getAssertionState.user_verified = true;
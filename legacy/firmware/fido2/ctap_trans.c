@@ -329,7 +329,7 @@ void u2fhid_read_start(const U2FHID_FRAME *f) {
       if (timer_ms() - dialog_manager.dialog_timer_start > CTAP_HID_TIMEOUT) {
         break;
       }
-      usbPoll();  // may trigger new request
+      usbPollWait(USB_POLL_WAIT_MS);  // may trigger new request
       buttonUpdate();
       if (button.YesUp && (dialog_manager.last_req_state == AUTH ||
                            dialog_manager.last_req_state == REG)) {
@@ -1138,11 +1138,15 @@ void ctap_hid_keepalive_process(void) {
   }
 }
 
+static timer_handle keepalive_timer = TIMER_INVALID;
+
 void ctap_hid_keepalive_register(void) {
   if (transport_type == TRANSPORT_BLE) {
     register_loop_callback(ctap_hid_keepalive_status, timer_ms(), timer1s / 12);
   } else {
-    register_timer("ctap_keepalive", timer1s / 12, ctap_hid_keepalive_status);
+    unregister_timer(&keepalive_timer);
+    keepalive_timer =
+        register_timer(timer1s / 12, ctap_hid_keepalive_status, true);
   }
 }
 
@@ -1150,7 +1154,7 @@ void ctap_hid_keepalive_unregister(void) {
   if (transport_type == TRANSPORT_BLE) {
     unregister_loop_callback();
   } else {
-    unregister_timer("ctap_keepalive");
+    unregister_timer(&keepalive_timer);
   }
 }
 
@@ -1399,7 +1403,7 @@ void u2f_register_ble(const APDU *a) {
 
   ble_cmd_nest++;
   while (1) {
-    usbPoll();
+    usbPollWait(USB_POLL_WAIT_MS);
     buttonUpdate();
     if (button.YesUp) {
       button_ret = true;
@@ -1553,7 +1557,7 @@ void u2f_authenticate_ble(const APDU *a) {
   uint32_t timer_start = timer_ms();
   bool button_ret = false;
   while (1) {
-    usbPoll();
+    usbPollWait(USB_POLL_WAIT_MS);
     buttonUpdate();
     if (button.YesUp) {
       button_ret = true;
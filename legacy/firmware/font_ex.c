@@ -1,11 +1,28 @@
 #include "font_ex.h"
+#include "memory.h"
 
 #include "dingmao.c"
 
-#define FONT_DATA_ADDR 0x08240000
+#define FONT_DATA_ADDR FLASH_FONT_START
 static FontHeader font_header;
 static bool has_font = false;
 
+// Section table, read once by font_init if it fits and is sorted by
+// codepoint. Otherwise each lookup reads the sections from the font.
+#define FONT_SECTIONS_MAX 16
+static FontSection font_sections[FONT_SECTIONS_MAX];
+static bool font_sections_cached = false;
+
+// Text is measured and then drawn one character at a time, so the glyph
+// info of recent codepoints is kept, direct-mapped by codepoint.
+#define GLYPH_CACHE_SIZE 32
+typedef struct {
+  uint32_t unicode;
+  FontInfo info;
+  bool found;
+} GlyphCacheEntry;
+static GlyphCacheEntry glyph_cache[GLYPH_CACHE_SIZE];
+
 int utf8_get_size(const uint8_t ch) {
   int n = 0;
 
@@ -89,6 +106,16 @@ static void font_data_read(void *buf, uint32_t offset, uint32_t len) {
   memcpy(buf, dingmao_buffer + offset, len);
 }
 
+static bool font_sections_sorted(void) {
+  for (int i = 0; i < font_header.sections; i++) {
+    if (font_sections[i].start > font_sections[i].end ||
+        (i > 0 && font_sections[i - 1].end >= font_sections[i].start)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void font_init(void) {
   uint8_t end_flag[4] = {0};
   font_data_read(&font_header, 0, FONT_HEADER_LEN);
@@ -96,6 +123,15 @@ void font_init(void) {
   if (memcmp(font_header.magic, "U3TP", 4) == 0) {
     font_data_read(&end_flag, font_header.total_len - 4, 4);
     if (memcmp(end_flag, "ENDU", 4) == 0) {
+      font_sections_cached = false;
+      if (font_header.sections <= FONT_SECTIONS_MAX) {
+        font_data_read(font_sections, FONT_HEADER_LEN,
+                       font_header.sections * FONT_SECTION_LEN);
+        font_sections_cached = font_sections_sorted();
+      }
+      for (int i = 0; i < GLYPH_CACHE_SIZE; i++) {
+        glyph_cache[i].unicode = UINT32_MAX;
+      }
       has_font = true;
     }
   }
@@ -106,29 +142,45 @@ bool font_imported(void) {
   return has_font;
 }
 
-static bool font_get_info(const uint8_t *ch, FontInfo *font_info) {
-  uint8_t i;
-  uint32_t unicode = 0;
-  uint32_t offset = 0;
+static bool font_find_section(uint32_t unicode, FontSection *font_section) {
+  if (!font_sections_cached) {
+    for (int i = 0; i < font_header.sections; i++) {
+      font_data_read(font_section, FONT_HEADER_LEN + i * FONT_SECTION_LEN,
+                     FONT_SECTION_LEN);
+      if (unicode >= font_section->start && unicode <= font_section->end) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  int lo = 0, hi = font_header.sections - 1;
+  while (lo <= hi) {
+    int mid = (lo + hi) / 2;
+    if (unicode < font_sections[mid].start) {
+      hi = mid - 1;
+    } else if (unicode > font_sections[mid].end) {
+      lo = mid + 1;
+    } else {
+      *font_section = font_sections[mid];
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool font_lookup(uint32_t unicode, FontInfo *font_info) {
   uint32_t data = 0;
   FontSection font_section = {0};
 
   font_info->width = 0;
   font_info->offset = 0;
 
-  utf8_to_unicode_char(ch, &unicode);
-  for (i = 0; i < font_header.sections; i++) {
-    font_data_read(&font_section, FONT_HEADER_LEN + i * FONT_SECTION_LEN,
-                   FONT_SECTION_LEN);
-    if (unicode >= font_section.start && unicode <= font_section.end) {
-      break;
-    }
-  }
-  if (i >= font_header.sections) {
+  if (!font_find_section(unicode, &font_section)) {
     return false;
   }
-  offset = font_section.offset + (unicode - font_section.start) * 4;
-  font_data_read(&data, offset, 4);
+  font_data_read(&data,
+                 font_section.offset + (unicode - font_section.start) * 4, 4);
   font_info->width = data >> 26;
   font_info->offset = data & 0x3ffffff;
   if (font_info->offset > font_header.total_len) {
@@ -137,6 +189,19 @@ static bool font_get_info(const uint8_t *ch, FontInfo *font_info) {
   return true;
 }
 
+static bool font_get_info(const uint8_t *ch, FontInfo *font_info) {
+  uint32_t unicode = 0;
+  utf8_to_unicode_char(ch, &unicode);
+
+  GlyphCacheEntry *entry = &glyph_cache[unicode % GLYPH_CACHE_SIZE];
+  if (entry->unicode != unicode) {
+    entry->unicode = unicode;
+    entry->found = font_lookup(unicode, &entry->info);
+  }
+  *font_info = entry->info;
+  return entry->found;
+}
+
 int font_get_width(const uint8_t *ch) {
   if (!has_font) {
     return 0;
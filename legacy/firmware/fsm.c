@@ -46,6 +46,7 @@
 #include "messages.pb.h"
 #include "oled.h"
 #include "pinmatrix.h"
+#include "profile.h"
 #include "protect.h"
 #include "recovery.h"
 #include "reset.h"
@@ -78,6 +79,7 @@
 #include "ethereum_definitions.h"
 #include "ethereum_networks.h"
 #include "ethereum_onekey.h"
+#include "ethereum_typed_data.h"
 #include "filecoin.h"
 #include "kaspa.h"
 #include "lnurl.h"
@@ -193,7 +195,7 @@ bool button_request(const ButtonRequestType code) {
   buttonUpdate();  // Clear button state
   msg_write(MessageType_MessageType_ButtonRequest, &resp);
   for (;;) {
-    usbPoll();
+    usbPollWait(USB_POLL_WAIT_MS);
 
     // check for ButtonAck
     if (msg_tiny_id == MessageType_MessageType_ButtonAck) {
@@ -402,6 +404,7 @@ static bool fsm_layoutAddress(const char *address, const char *address_type,
   if (multisig) {
     screens += cryptoMultisigPubkeyCount(multisig);
   }
+  layoutAddressCacheClear();
   if (!button_request(ButtonRequestType_ButtonRequest_Address)) {
     fsm_sendFailure(FailureType_Failure_ActionCancelled, NULL);
     return false;
@@ -622,7 +625,9 @@ void fsm_abortWorkflows(void) {
   unlock_path = 0;
 #if !BITCOIN_ONLY
   ethereum_signing_abort();
+  ethereum_typed_data_abort();
   stellar_signingAbort();
+  kaspa_signing_abort();
 #endif
 }
 
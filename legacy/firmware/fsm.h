@@ -31,6 +31,7 @@
 #include "messages-cosmos.pb.h"
 #include "messages-crypto.pb.h"
 #include "messages-debug.pb.h"
+#include "messages-ethereum-eip712.pb.h"
 #include "messages-ethereum-onekey.pb.h"
 #include "messages-ethereum.pb.h"
 #include "messages-filecoin.pb.h"
@@ -135,6 +136,7 @@ void fsm_msgDebugLinkMemoryWrite(const DebugLinkMemoryWrite *msg);
 void fsm_msgDebugLinkMemoryRead(const DebugLinkMemoryRead *msg);
 void fsm_msgDebugLinkFlashErase(const DebugLinkFlashErase *msg);
 void fsm_msgDebugLinkReseedRandom(const DebugLinkReseedRandom *msg);
+void fsm_msgDebugLinkGetProfile(const DebugLinkGetProfile *msg);
 #endif
 
 // ethereum
@@ -146,6 +148,9 @@ void fsm_msgEthereumTxAck(const EthereumTxAck *msg);
 void fsm_msgEthereumSignMessage(const EthereumSignMessage *msg);
 void fsm_msgEthereumVerifyMessage(const EthereumVerifyMessage *msg);
 void fsm_msgEthereumSignTypedHash(const EthereumSignTypedHash *msg);
+void fsm_msgEthereumSignTypedData(const EthereumSignTypedData *msg);
+void fsm_msgEthereumTypedDataStructAck(const EthereumTypedDataStructAck *msg);
+void fsm_msgEthereumTypedDataValueAck(const EthereumTypedDataValueAck *msg);
 
 // ethereum onekey
 void fsm_msgEthereumGetAddressOneKey(const EthereumGetAddressOneKey *msg);
@@ -215,6 +220,8 @@ void fsm_msgBixinMessageSE(const BixinMessageSE *msg);
 void fsm_msgBixinVerifyDeviceRequest(const BixinVerifyDeviceRequest *msg);
 
 void fsm_msgGetPublicKeyMultiple(const GetPublicKeyMultiple *msg);
+void fsm_clearPublicKeyCache(void);
+void fsm_setPublicKeyCacheSession(const uint8_t *session_id);
 
 bool fsm_layoutPathWarning(uint32_t address_n_count, const uint32_t *address_n);
 bool fsm_checkCoinPath(const CoinInfo *coin, InputScriptType script_type,
@@ -304,6 +311,9 @@ void fsm_msgCardanoSignMessage(CardanoSignMessage *msg);
 void fsm_msgKaspaGetAddress(const KaspaGetAddress *msg);
 void fsm_msgKaspaSignTx(const KaspaSignTx *msg);
 void fsm_msgKaspaTxInputAck(const KaspaTxInputAck *msg);
+void fsm_msgKaspaSignTxInit(const KaspaSignTxInit *msg);
+void fsm_msgKaspaTxAckInput(const KaspaTxAckInput *msg);
+void fsm_msgKaspaTxAckOutput(const KaspaTxAckOutput *msg);
 
 // Nexa
 void fsm_msgNexaGetAddress(const NexaGetAddress *msg);
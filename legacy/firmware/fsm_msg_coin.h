@@ -17,6 +17,129 @@
  * along with this library.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+// Public keys served by GetPublicKey and GetPublicKeyMultiple. Wallets ask for
+// the same accounts on every connection, and every request would otherwise
+// derive the node, the m/0' node for the root fingerprint, and serialize the
+// xpub. The entries are only valid for the session they were derived in.
+#define PUBLIC_KEY_CACHE_SIZE 16
+
+typedef struct {
+  bool set;
+  uint8_t id[SHA256_DIGEST_LENGTH];
+  uint32_t root_fingerprint;
+  uint32_t fingerprint;
+  uint32_t depth;
+  uint32_t child_num;
+  uint8_t chain_code[32];
+  uint8_t public_key[33];
+  char xpub[sizeof(((PublicKey *)NULL)->xpub)];
+} PublicKeyCacheEntry;
+
+static struct {
+  PublicKeyCacheEntry entries[PUBLIC_KEY_CACHE_SIZE];
+  int index;
+  uint8_t session_id[32];
+} public_key_cache;
+
+void fsm_clearPublicKeyCache(void) {
+  memzero(&public_key_cache, sizeof(public_key_cache));
+}
+
+void fsm_setPublicKeyCacheSession(const uint8_t *session_id) {
+  if (memcmp(public_key_cache.session_id, session_id,
+             sizeof(public_key_cache.session_id)) != 0) {
+    fsm_clearPublicKeyCache();
+    memcpy(public_key_cache.session_id, session_id,
+           sizeof(public_key_cache.session_id));
+  }
+}
+
+static uint32_t fsm_getXpubMagic(const CoinInfo *coin,
+                                 InputScriptType script_type,
+                                 bool ignore_xpub_magic) {
+  if (coin->xpub_magic && (script_type == InputScriptType_SPENDADDRESS ||
+                           script_type == InputScriptType_SPENDMULTISIG)) {
+    return coin->xpub_magic;
+  } else if (coin->has_segwit &&
+             script_type == InputScriptType_SPENDP2SHWITNESS &&
+             !ignore_xpub_magic && coin->xpub_magic_segwit_p2sh) {
+    return coin->xpub_magic_segwit_p2sh;
+  } else if (coin->has_segwit &&
+             script_type == InputScriptType_SPENDP2SHWITNESS &&
+             ignore_xpub_magic && coin->xpub_magic) {
+    return coin->xpub_magic;
+  } else if (coin->has_segwit && script_type == InputScriptType_SPENDWITNESS &&
+             !ignore_xpub_magic && coin->xpub_magic_segwit_native) {
+    return coin->xpub_magic_segwit_native;
+  } else if (coin->has_segwit && script_type == InputScriptType_SPENDWITNESS &&
+             ignore_xpub_magic && coin->xpub_magic) {
+    return coin->xpub_magic;
+  } else if (coin->has_taproot && script_type == InputScriptType_SPENDTAPROOT &&
+             coin->xpub_magic) {
+    return coin->xpub_magic;
+  }
+  return 0;
+}
+
+// Returns the public key for the path, derived or from the cache. On error
+// the failure is sent and NULL is returned.
+static const PublicKeyCacheEntry *fsm_getPublicKey(const CoinInfo *coin,
+                                                   const char *curve,
+                                                   uint32_t xpub_magic,
+                                                   const uint32_t *address_n,
+                                                   size_t address_n_count) {
+  uint8_t id[SHA256_DIGEST_LENGTH] = {0};
+  SHA256_CTX ctx = {0};
+  sha256_Init(&ctx);
+  sha256_Update(&ctx, (const uint8_t *)coin->coin_name,
+                strlen(coin->coin_name) + 1);
+  sha256_Update(&ctx, (const uint8_t *)curve, strlen(curve) + 1);
+  sha256_Update(&ctx, (const uint8_t *)&xpub_magic, sizeof(xpub_magic));
+  sha256_Update(&ctx, (const uint8_t *)address_n,
+                address_n_count * sizeof(uint32_t));
+  sha256_Final(&ctx, id);
+
+  for (int i = 0; i < PUBLIC_KEY_CACHE_SIZE; i++) {
+    const PublicKeyCacheEntry *entry = &public_key_cache.entries[i];
+    if (entry->set && memcmp(entry->id, id, sizeof(id)) == 0) {
+      return entry;
+    }
+  }
+
+  // derive m/0' to obtain root_fingerprint
+  uint32_t root_fingerprint;
+  uint32_t path[1] = {PATH_HARDENED | 0};
+  HDNode *node = fsm_getDerivedNode(curve, path, 1, &root_fingerprint);
+  if (!node) return NULL;
+
+  uint32_t fingerprint;
+  node = fsm_getDerivedNode(curve, address_n, address_n_count, &fingerprint);
+  if (!node) return NULL;
+
+  if (hdnode_fill_public_key(node) != 0) {
+    fsm_sendFailure(FailureType_Failure_ProcessError,
+                    "Failed to derive public key");
+    layoutHome();
+    return NULL;
+  }
+
+  PublicKeyCacheEntry *entry =
+      &public_key_cache.entries[public_key_cache.index];
+  memzero(entry, sizeof(PublicKeyCacheEntry));
+  memcpy(entry->id, id, sizeof(id));
+  entry->root_fingerprint = root_fingerprint;
+  entry->fingerprint = fingerprint;
+  entry->depth = node->depth;
+  entry->child_num = node->child_num;
+  memcpy(entry->chain_code, node->chain_code, 32);
+  memcpy(entry->public_key, node->public_key, 33);
+  hdnode_serialize_public(node, fingerprint, xpub_magic, entry->xpub,
+                          sizeof(entry->xpub));
+  entry->set = true;
+  public_key_cache.index = (public_key_cache.index + 1) % PUBLIC_KEY_CACHE_SIZE;
+  return entry;
+}
+
 void fsm_msgGetPublicKey(const GetPublicKey *msg) {
   RESP_INIT(PublicKey);
 
@@ -45,69 +168,32 @@ void fsm_msgGetPublicKey(const GetPublicKey *msg) {
     }
   }
 
-  // derive m/0' to obtain root_fingerprint
-  uint32_t root_fingerprint;
-  uint32_t path[1] = {PATH_HARDENED | 0};
-  HDNode *node = fsm_getDerivedNode(curve, path, 1, &root_fingerprint);
-  if (!node) return;
-
-  uint32_t fingerprint;
-  node = fsm_getDerivedNode(curve, msg->address_n, msg->address_n_count,
-                            &fingerprint);
-  if (!node) return;
-
-  if (hdnode_fill_public_key(node) != 0) {
-    fsm_sendFailure(FailureType_Failure_ProcessError,
-                    "Failed to derive public key");
+  uint32_t xpub_magic =
+      fsm_getXpubMagic(coin, script_type, msg->ignore_xpub_magic);
+  if (xpub_magic == 0) {
+    fsm_sendFailure(FailureType_Failure_DataError,
+                    "Invalid combination of coin and script_type");
     layoutHome();
     return;
   }
 
-  resp->node.depth = node->depth;
-  resp->node.fingerprint = fingerprint;
-  resp->node.child_num = node->child_num;
+  const PublicKeyCacheEntry *pubkey = fsm_getPublicKey(
+      coin, curve, xpub_magic, msg->address_n, msg->address_n_count);
+  if (!pubkey) return;
+
+  resp->node.depth = pubkey->depth;
+  resp->node.fingerprint = pubkey->fingerprint;
+  resp->node.child_num = pubkey->child_num;
   resp->node.chain_code.size = 32;
-  memcpy(resp->node.chain_code.bytes, node->chain_code, 32);
+  memcpy(resp->node.chain_code.bytes, pubkey->chain_code, 32);
   resp->node.has_private_key = false;
   resp->node.public_key.size = 33;
-  memcpy(resp->node.public_key.bytes, node->public_key, 33);
-  if (node->public_key[0] == 1) {
+  memcpy(resp->node.public_key.bytes, pubkey->public_key, 33);
+  if (pubkey->public_key[0] == 1) {
     /* ed25519 public key */
     resp->node.public_key.bytes[0] = 0;
   }
-
-  if (coin->xpub_magic && (script_type == InputScriptType_SPENDADDRESS ||
-                           script_type == InputScriptType_SPENDMULTISIG)) {
-    hdnode_serialize_public(node, fingerprint, coin->xpub_magic, resp->xpub,
-                            sizeof(resp->xpub));
-  } else if (coin->has_segwit &&
-             script_type == InputScriptType_SPENDP2SHWITNESS &&
-             !msg->ignore_xpub_magic && coin->xpub_magic_segwit_p2sh) {
-    hdnode_serialize_public(node, fingerprint, coin->xpub_magic_segwit_p2sh,
-                            resp->xpub, sizeof(resp->xpub));
-  } else if (coin->has_segwit &&
-             script_type == InputScriptType_SPENDP2SHWITNESS &&
-             msg->ignore_xpub_magic && coin->xpub_magic) {
-    hdnode_serialize_public(node, fingerprint, coin->xpub_magic, resp->xpub,
-                            sizeof(resp->xpub));
-  } else if (coin->has_segwit && script_type == InputScriptType_SPENDWITNESS &&
-             !msg->ignore_xpub_magic && coin->xpub_magic_segwit_native) {
-    hdnode_serialize_public(node, fingerprint, coin->xpub_magic_segwit_native,
-                            resp->xpub, sizeof(resp->xpub));
-  } else if (coin->has_segwit && script_type == InputScriptType_SPENDWITNESS &&
-             msg->ignore_xpub_magic && coin->xpub_magic) {
-    hdnode_serialize_public(node, fingerprint, coin->xpub_magic, resp->xpub,
-                            sizeof(resp->xpub));
-  } else if (coin->has_taproot && script_type == InputScriptType_SPENDTAPROOT &&
-             coin->xpub_magic) {
-    hdnode_serialize_public(node, fingerprint, coin->xpub_magic, resp->xpub,
-                            sizeof(resp->xpub));
-  } else {
-    fsm_sendFailure(FailureType_Failure_DataError,
-                    "Invalid combination of coin and script_type");
-    layoutHome();
-    return;
-  }
+  strlcpy(resp->xpub, pubkey->xpub, sizeof(resp->xpub));
 
   if (msg->has_show_display && msg->show_display) {
     if (!layoutXPUB(coin->coin_name, resp->xpub, msg->address_n,
@@ -120,7 +206,7 @@ void fsm_msgGetPublicKey(const GetPublicKey *msg) {
   }
 
   resp->has_root_fingerprint = true;
-  resp->root_fingerprint = root_fingerprint;
+  resp->root_fingerprint = pubkey->root_fingerprint;
 
   msg_write(MessageType_MessageType_PublicKey, resp);
   layoutHome();
@@ -875,50 +961,35 @@ void fsm_msgGetPublicKeyMultiple(const GetPublicKeyMultiple *msg) {
     curve = msg->ecdsa_curve_name;
   }
 
+  uint32_t xpub_magic =
+      fsm_getXpubMagic(coin, script_type, msg->ignore_xpub_magic);
+  if (xpub_magic == 0) {
+    fsm_sendFailure(FailureType_Failure_DataError,
+                    "Invalid combination of coin and script_type");
+    layoutHome();
+    return;
+  }
+
   for (int i = 0; i < msg->addresses_count; i++) {
-    uint32_t fingerprint = 0;
-    HDNode *node =
-        fsm_getDerivedNode(curve, msg->addresses->address_n,
-                           msg->addresses->address_n_count, &fingerprint);
-    if (!node) return;
-    hdnode_fill_public_key(node);
-
-    if (coin->xpub_magic && (script_type == InputScriptType_SPENDADDRESS ||
-                             script_type == InputScriptType_SPENDMULTISIG)) {
-      hdnode_serialize_public(node, fingerprint, coin->xpub_magic,
-                              resp->xpubs[i], sizeof(resp->xpubs[i]));
-    } else if (coin->has_segwit &&
-               script_type == InputScriptType_SPENDP2SHWITNESS &&
-               !msg->ignore_xpub_magic && coin->xpub_magic_segwit_p2sh) {
-      hdnode_serialize_public(node, fingerprint, coin->xpub_magic_segwit_p2sh,
-                              resp->xpubs[i], sizeof(resp->xpubs[i]));
-    } else if (coin->has_segwit &&
-               script_type == InputScriptType_SPENDP2SHWITNESS &&
-               msg->ignore_xpub_magic && coin->xpub_magic) {
-      hdnode_serialize_public(node, fingerprint, coin->xpub_magic,
-                              resp->xpubs[i], sizeof(resp->xpubs[i]));
-    } else if (coin->has_segwit &&
-               script_type == InputScriptType_SPENDWITNESS &&
-               !msg->ignore_xpub_magic && coin->xpub_magic_segwit_native) {
-      hdnode_serialize_public(node, fingerprint, coin->xpub_magic_segwit_native,
-                              resp->xpubs[i], sizeof(resp->xpubs[i]));
-    } else if (coin->has_segwit &&
-               script_type == InputScriptType_SPENDWITNESS &&
-               msg->ignore_xpub_magic && coin->xpub_magic) {
-      hdnode_serialize_public(node, fingerprint, coin->xpub_magic,
-                              resp->xpubs[i], sizeof(resp->xpubs[i]));
-    } else {
-      fsm_sendFailure(FailureType_Failure_DataError,
-                      "Invalid combination of coin and script_type");
+    const uint32_t *address_n = msg->addresses[i].address_n;
+    size_t address_n_count = msg->addresses[i].address_n_count;
+    // UnlockPath is required to access SLIP25 paths.
+    if (address_n_count > 0 && address_n[0] == PATH_SLIP25_PURPOSE &&
+        address_n[0] != unlock_path) {
+      fsm_sendFailure(FailureType_Failure_DataError, "Forbidden key path");
       layoutHome();
       return;
     }
 
+    const PublicKeyCacheEntry *pubkey =
+        fsm_getPublicKey(coin, curve, xpub_magic, address_n, address_n_count);
+    if (!pubkey) return;
+    strlcpy(resp->xpubs[i], pubkey->xpub, sizeof(resp->xpubs[i]));
+
     if (msg->has_show_display && msg->show_display) {
-      if (!layoutXPUB(coin->coin_name, resp->xpubs[i],
-                      msg->addresses->address_n,
-                      msg->addresses->address_n_count)) {
-        memzero(resp, sizeof(PublicKey));
+      if (!layoutXPUB(coin->coin_name, resp->xpubs[i], address_n,
+                      address_n_count)) {
+        memzero(resp, sizeof(PublicKeyMultiple));
         fsm_sendFailure(FailureType_Failure_ActionCancelled, NULL);
         layoutHome();
         return;
@@ -246,6 +246,8 @@ void fsm_msgInitialize(const Initialize *msg) {
     config_setDeriveCardano(false);
   }
 
+  fsm_setPublicKeyCacheSession(session_id);
+
   RESP_INIT(Features);
   get_features(resp);
 
@@ -600,6 +602,8 @@ bool fsm_getLang(const ApplySettings *msg) {
 void fsm_msgEndSession(const EndSession *msg) {
   (void)msg;
   session_endCurrentSession();
+  fsm_clearPublicKeyCache();
+  signing_clear_prevout_cache();
   fsm_sendSuccess("Session ended");
 }
 
@@ -64,6 +64,38 @@ void fsm_msgDebugLinkGetState(const DebugLinkGetState *msg) {
   resp.has_passphrase_protection =
       config_getPassphraseProtection(&(resp.passphrase_protection));
 
+  const SigningTimings *timings = signing_get_timings();
+  resp.has_signing_hash_ms = true;
+  resp.signing_hash_ms = timings->hash_ms;
+  resp.has_signing_confirm_ms = true;
+  resp.signing_confirm_ms = timings->confirm_ms;
+  resp.has_signing_check_ms = true;
+  resp.signing_check_ms = timings->check_ms;
+  resp.has_signing_sign_ms = true;
+  resp.signing_sign_ms = timings->sign_ms;
+  resp.has_signing_derivations = true;
+  resp.signing_derivations = timings->derivations;
+  resp.has_signing_derivations_reused = true;
+  resp.signing_derivations_reused = timings->derivations_reused;
+  resp.has_signing_prevtxs_reused = true;
+  resp.signing_prevtxs_reused = timings->prevtxs_reused;
+
+  const LayoutAddressStats *address_stats = layoutAddressGetStats();
+  resp.has_address_qr_encodes = true;
+  resp.address_qr_encodes = address_stats->encodes;
+  resp.has_address_qr_columns = true;
+  resp.address_qr_columns = address_stats->columns;
+
+  const MsgPacketStats *packets = msg_get_packet_stats();
+  resp.has_usb_packets_in = true;
+  resp.usb_packets_in = packets->packets_in;
+  resp.has_usb_packets_out = true;
+  resp.usb_packets_out = packets->packets_out;
+  resp.has_usb_packets_in_per_sec = true;
+  resp.usb_packets_in_per_sec = packets->packets_in_per_sec;
+  resp.has_usb_packets_out_per_sec = true;
+  resp.usb_packets_out_per_sec = packets->packets_out_per_sec;
+
   msg_debug_write(MessageType_MessageType_DebugLinkState, &resp);
 }
 
@@ -121,4 +153,51 @@ void fsm_msgDebugLinkReseedRandom(const DebugLinkReseedRandom *msg) {
   msg_debug_write(MessageType_MessageType_Failure, resp);
 #endif
 }
+
+void fsm_msgDebugLinkGetProfile(const DebugLinkGetProfile *msg) {
+  // Not in msg_resp, which may hold the response of the message being
+  // profiled, and too large for the stack.
+  static DebugLinkProfile resp;
+  memzero(&resp, sizeof(resp));
+  resp.cycles_per_us = profile_cycles_per_us();
+
+  const pb_size_t max_entries = sizeof(resp.entries) / sizeof(resp.entries[0]);
+  uint32_t skip = msg->has_offset ? msg->offset : 0;
+  const ProfileMessage *m = NULL;
+  for (int i = 0; (m = profile_get(i)) != NULL; i++) {
+    for (int s = 0; s < PROFILE_SECTIONS; s++) {
+      const ProfileHistogram *h = &m->sections[s];
+      if (h->count == 0) continue;
+      if (skip > 0) {
+        skip--;
+        continue;
+      }
+      if (resp.entries_count >= max_entries) {
+        resp.has_more = true;
+        resp.more = true;
+        break;
+      }
+      DebugLinkProfileEntry *e =
+          &resp.entries[resp.entries_count++];
+      e->message_type = m->msg_id;
+      e->section = (DebugLinkProfileSection)s;
+      e->count = h->count;
+      e->total_cycles = h->total;
+      e->max_cycles = h->max;
+      // trailing empty buckets are left out
+      for (int b = 0; b < PROFILE_BUCKETS; b++) {
+        if (h->buckets[b] != 0) e->histogram_count = b + 1;
+      }
+      for (int b = 0; b < e->histogram_count; b++) {
+        e->histogram[b] = h->buckets[b];
+      }
+    }
+    if (resp.more) break;
+  }
+
+  if (msg->has_reset && msg->reset && !resp.more) {
+    profile_reset();
+  }
+  msg_debug_write(MessageType_MessageType_DebugLinkProfile, &resp);
+}
 #endif
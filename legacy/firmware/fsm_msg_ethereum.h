@@ -393,3 +393,50 @@ void fsm_msgEthereumSignTypedHash(const EthereumSignTypedHash *msg) {
   ethereum_typed_hash_sign(msg, node, resp);
   layoutHome();
 }
+
+void fsm_msgEthereumSignTypedData(const EthereumSignTypedData *msg) {
+  CHECK_INITIALIZED
+
+  CHECK_PIN
+
+  uint32_t slip44 = (msg->address_n_count > 1)
+                        ? (msg->address_n[1] & PATH_UNHARDEN_MASK)
+                        : SLIP44_UNKNOWN;
+
+  const EthereumNetworkInfo *network = get_network_definition_only(
+      msg->has_definitions && msg->definitions.has_encoded_network,
+      &msg->definitions.encoded_network, slip44);
+
+  if (!network || !fsm_ethereumCheckPath(msg->address_n_count, msg->address_n,
+                                         false, network)) {
+    layoutHome();
+    return;
+  }
+
+  const HDNode *node = fsm_getDerivedNode(SECP256K1_NAME, msg->address_n,
+                                          msg->address_n_count, NULL);
+  if (!node) return;
+
+  uint8_t pubkeyhash[20] = {0};
+  if (!hdnode_get_ethereum_pubkeyhash(node, pubkeyhash)) {
+    layoutHome();
+    return;
+  }
+
+  char address[43] = {0};
+  ethereum_address_checksum(pubkeyhash, address, false, 0);
+
+  ethereum_typed_data_init(msg, node, address);
+}
+
+void fsm_msgEthereumTypedDataStructAck(const EthereumTypedDataStructAck *msg) {
+  CHECK_UNLOCKED
+
+  ethereum_typed_data_struct_ack(msg);
+}
+
+void fsm_msgEthereumTypedDataValueAck(const EthereumTypedDataValueAck *msg) {
+  CHECK_UNLOCKED
+
+  ethereum_typed_data_value_ack(msg);
+}
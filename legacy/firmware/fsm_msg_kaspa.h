@@ -94,3 +94,34 @@ void fsm_msgKaspaSignTx(const KaspaSignTx *msg) {
 }
 
 void fsm_msgKaspaTxInputAck(const KaspaTxInputAck *msg) { SIGN_DYNAMIC; }
+
+void fsm_msgKaspaSignTxInit(const KaspaSignTxInit *msg) {
+  CHECK_INITIALIZED
+
+  CHECK_PIN
+  CHECK_PARAM(msg->inputs_count >= 1, "Invalid input count");
+  CHECK_PARAM(msg->outputs_count >= 1, "Invalid output count");
+  CHECK_PARAM(msg->has_schema && (strcmp(msg->schema, "schnorr") == 0 ||
+                                  strcmp(msg->schema, "ecdsa") == 0),
+              "Invalid schema");
+  CHECK_PARAM(msg->version <= UINT16_MAX, "Invalid version");
+
+  kaspa_sign_tx_init(msg);
+}
+
+void fsm_msgKaspaTxAckInput(const KaspaTxAckInput *msg) {
+  CHECK_PARAM(fsm_common_path_check(msg->address_n, msg->address_n_count,
+                                    COIN_TYPE, SECP256K1_NAME, true),
+              "Invalid path");
+  CHECK_PARAM(msg->sig_op_count <= UINT8_MAX, "Invalid sig op count");
+  HDNode *node = fsm_getDerivedNode(SECP256K1_NAME, msg->address_n,
+                                    msg->address_n_count, NULL);
+  if (!node) return;
+  hdnode_fill_public_key(node);
+
+  kaspa_sign_tx_input(node, msg);
+}
+
+void fsm_msgKaspaTxAckOutput(const KaspaTxAckOutput *msg) {
+  kaspa_sign_tx_output(msg);
+}
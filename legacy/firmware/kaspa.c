@@ -1,11 +1,14 @@
 #include "kaspa.h"
 #include <stdint.h>
+#include "bignum.h"
 #include "blake2b.h"
 #include "cash_addr.h"
 #include "curves.h"
 #include "fsm.h"
+#include "gettext.h"
 #include "layout2.h"
 #include "memzero.h"
+#include "messages.h"
 #include "messages-common.pb.h"
 #include "secp256k1.h"
 #include "sha2.h"
@@ -14,7 +17,7 @@
 
 #define PUBKEY_VERSION 0
 #define PUBKEY_ECDSA_VERSION 1
-// #define SCRIP_HASH_VERSION 8
+#define SCRIPT_HASH_VERSION 8
 // schnorr pubkey is 32 bytes
 #define PUBKEY_LEN 32
 // ecdsa pubkey is 33 bytes
@@ -33,24 +36,142 @@ static char prefix[10] = {0};
 // "kaspadev"};
 static char previous_address[72] = {0};
 
-#define CALCULATE_SIGNING_HASH(pre_image, pre_image_len)           \
-  uint8_t schnorr_digest[32] = {0};                                \
-  BLAKE2B_CTX ctx;                                                 \
-  blake2b_InitKey(&ctx, 32, (uint8_t *)TRANSACTION_SIGNING_DOMAIN, \
-                  strlen(TRANSACTION_SIGNING_DOMAIN));             \
-  blake2b_Update(&ctx, pre_image, pre_image_len);                  \
-  blake2b_Final(&ctx, schnorr_digest, 32);
+#define SIGHASH_ALL 0x01
+// Outputs hash, lock time, subnetwork id, gas, payload hash and hash type.
+#define SIGHASH_SUFFIX_LEN (32 + 8 + 20 + 8 + 32 + 1)
+// OP_DATA_33 <ECDSA public key> OP_CHECKSIGECDSA is the longest script.
+#define SCRIPT_MAX_LEN 35
+
+typedef enum {
+  KASPA_STAGE_SIGHASH,  // KaspaSignTx: the host sends the sighash pre-images
+  KASPA_STAGE_INPUTS,
+  KASPA_STAGE_OUTPUTS,
+  KASPA_STAGE_SIGN,
+} KaspaStage;
+
+// State of KaspaSignTxInit. The input and output hashes are shared by every
+// input's sighash, so they are computed once while the transaction is
+// confirmed, and each input is then signed from a copy of the midstate.
+static struct {
+  KaspaStage stage;
+  uint32_t inputs_count;
+  uint32_t outputs_count;
+  uint32_t index;
+  uint16_t version;
+  uint64_t lock_time;
+  uint64_t total_in;
+  uint64_t total_out;
+  uint64_t authorized_in;
+  BLAKE2B_CTX prev_outputs;
+  BLAKE2B_CTX sequences;
+  BLAKE2B_CTX sig_op_counts;
+  BLAKE2B_CTX outputs;
+  BLAKE2B_CTX midstate;
+  uint8_t suffix[SIGHASH_SUFFIX_LEN];
+  char signer[72];
+} tx;
+
+static void signing_hash_init(BLAKE2B_CTX *ctx) {
+  blake2b_InitKey(ctx, 32, (const uint8_t *)TRANSACTION_SIGNING_DOMAIN,
+                  strlen(TRANSACTION_SIGNING_DOMAIN));
+}
+
+static void hash_le(BLAKE2B_CTX *ctx, uint64_t value, size_t size) {
+  uint8_t buf[8] = {0};
+  for (size_t i = 0; i < size; i++) {
+    buf[i] = value >> (8 * i);
+  }
+  blake2b_Update(ctx, buf, size);
+}
+
+static void hash_outpoint(BLAKE2B_CTX *ctx, const KaspaTxAckInput *input) {
+  blake2b_Update(ctx, input->prev_hash.bytes, 32);
+  hash_le(ctx, input->prev_index, 4);
+}
+
+static void hash_script_public_key(BLAKE2B_CTX *ctx, const uint8_t *script,
+                                   size_t script_len) {
+  hash_le(ctx, 0, 2);  // script version
+  hash_le(ctx, script_len, 8);
+  blake2b_Update(ctx, script, script_len);
+}
+
+// Returns the address payload of the node: the version byte followed by the
+// tweaked x-only key for schnorr, or the compressed key for ecdsa.
+static size_t node_payload(const HDNode *node, uint8_t *payload) {
+  if (strcmp(schema, "schnorr") == 0) {
+    payload[0] = PUBKEY_VERSION;
+    zkp_bip340_tweak_public_key(node->public_key + 1, NULL, payload + 1);
+    return PUBKEY_LEN + 1;
+  }
+  payload[0] = PUBKEY_ECDSA_VERSION;
+  memcpy(payload + 1, node->public_key, PUBKEY_ECDSA_LEN);
+  return PUBKEY_ECDSA_LEN + 1;
+}
 
-#define CALCULATE_SIGNING_HASH_ECDSA                                  \
-  uint8_t ecdsa_digest[32] = {0};                                     \
-  SHA256_CTX sha_ctx;                                                 \
-  sha256_Init(&sha_ctx);                                              \
-  sha256_Update(&sha_ctx, TRANSACTION_SIGNING_ECDSA_DOMAIN_HASH, 32); \
-  sha256_Update(&sha_ctx, schnorr_digest, 32);                        \
+// Returns the length of the script public key paying to an address payload,
+// or 0 if the address version is unknown.
+static size_t payload_to_script(const uint8_t *payload, size_t payload_len,
+                                uint8_t *script) {
+  if (payload[0] == PUBKEY_VERSION && payload_len == PUBKEY_LEN + 1) {
+    script[0] = 0x20;  // OP_DATA_32
+    memcpy(script + 1, payload + 1, PUBKEY_LEN);
+    script[PUBKEY_LEN + 1] = 0xac;  // OP_CHECKSIG
+    return PUBKEY_LEN + 2;
+  }
+  if (payload[0] == PUBKEY_ECDSA_VERSION &&
+      payload_len == PUBKEY_ECDSA_LEN + 1) {
+    script[0] = 0x21;  // OP_DATA_33
+    memcpy(script + 1, payload + 1, PUBKEY_ECDSA_LEN);
+    script[PUBKEY_ECDSA_LEN + 1] = 0xab;  // OP_CHECKSIGECDSA
+    return PUBKEY_ECDSA_LEN + 2;
+  }
+  if (payload[0] == SCRIPT_HASH_VERSION && payload_len == 33) {
+    script[0] = 0xaa;  // OP_BLAKE2B
+    script[1] = 0x20;  // OP_DATA_32
+    memcpy(script + 2, payload + 1, 32);
+    script[34] = 0x87;  // OP_EQUAL
+    return 35;
+  }
+  return 0;
+}
+
+static bool sign_digest(const HDNode *node, const uint8_t *schnorr_digest,
+                        uint8_t *signature, pb_size_t *signature_len) {
+  if (strcmp(schema, "schnorr") == 0) {
+#if EMULATOR
+    return tx_sign_bip340(node->private_key, schnorr_digest, signature,
+                          signature_len);
+#else
+    if (hdnode_bip340_sign_digest(node, schnorr_digest, signature) != 0) {
+      return false;
+    }
+    *signature_len = 64;
+    return true;
+#endif
+  }
+  uint8_t ecdsa_digest[32] = {0};
+  SHA256_CTX sha_ctx;
+  sha256_Init(&sha_ctx);
+  sha256_Update(&sha_ctx, TRANSACTION_SIGNING_ECDSA_DOMAIN_HASH, 32);
+  sha256_Update(&sha_ctx, schnorr_digest, 32);
   sha256_Final(&sha_ctx, ecdsa_digest);
+#if EMULATOR
+  return tx_sign_ecdsa(&secp256k1, node->private_key, ecdsa_digest, signature,
+                       signature_len);
+#else
+  uint8_t sig[64];
+  if (hdnode_sign_digest(node, ecdsa_digest, sig, NULL, NULL) != 0) {
+    return false;
+  }
+  *signature_len = ecdsa_sig_to_der(sig, signature);
+  return true;
+#endif
+}
 
 void kaspa_signing_init(const KaspaSignTx *msg) {
   kaspa_signing = true;
+  tx.stage = KASPA_STAGE_SIGHASH;
   input_count = msg->input_count;
   input_index = 1;
   memcpy(schema, msg->schema, sizeof(msg->schema));
@@ -65,6 +186,7 @@ void kaspa_signing_abort(void) {
     memzero(schema, sizeof(schema));
     memzero(prefix, sizeof(prefix));
     memzero(previous_address, sizeof(previous_address));
+    memzero(&tx, sizeof(tx));
     layoutHome();
   }
 }
@@ -96,7 +218,7 @@ void kaspa_get_address(uint8_t *pubkey, const uint8_t pubkey_len,
 void kaspa_sign_sighash(HDNode *node, const uint8_t *raw_message,
                         uint32_t raw_message_len, uint8_t *signature,
                         pb_size_t *signature_len) {
-  if (!kaspa_signing) {
+  if (!kaspa_signing || tx.stage != KASPA_STAGE_SIGHASH) {
     fsm_sendFailure(FailureType_Failure_UnexpectedMessage,
                     "Not in Kaspa signing mode");
     layoutHome();
@@ -120,35 +242,218 @@ void kaspa_sign_sighash(HDNode *node, const uint8_t *raw_message,
     }
   }
 
-  CALCULATE_SIGNING_HASH(raw_message, raw_message_len);
-  if (strcmp(schema, "schnorr") == 0) {
-#if EMULATOR
-    tx_sign_bip340(node->private_key, schnorr_digest, signature, signature_len);
-#else
-    int ret = hdnode_bip340_sign_digest(node, schnorr_digest, signature);
-    if (ret != 0) {
-      fsm_sendFailure(FailureType_Failure_ProcessError, "Signing failed");
-      kaspa_signing_abort();
+  uint8_t schnorr_digest[32] = {0};
+  BLAKE2B_CTX ctx;
+  signing_hash_init(&ctx);
+  blake2b_Update(&ctx, raw_message, raw_message_len);
+  blake2b_Final(&ctx, schnorr_digest, 32);
+  if (!sign_digest(node, schnorr_digest, signature, signature_len)) {
+    fsm_sendFailure(FailureType_Failure_ProcessError, "Signing failed");
+    kaspa_signing_abort();
+    return;
+  }
+}
+
+static void send_request(KaspaRequestType type, uint32_t index,
+                         const uint8_t *signature, pb_size_t signature_len) {
+  static KaspaTxRequest resp;
+  memzero(&resp, sizeof(resp));
+  resp.request_type = type;
+  if (type != KaspaRequestType_TXFINISHED) {
+    resp.has_request_index = true;
+    resp.request_index = index;
+  }
+  if (signature) {
+    resp.has_signature_index = true;
+    resp.signature_index = tx.index - 1;
+    resp.has_signature = true;
+    memcpy(resp.signature.bytes, signature, signature_len);
+    resp.signature.size = signature_len;
+  }
+  msg_write(MessageType_MessageType_KaspaTxRequest, &resp);
+}
+
+static void signing_fail(FailureType type, const char *message) {
+  fsm_sendFailure(type, message);
+  kaspa_signing_abort();
+}
+
+void kaspa_sign_tx_init(const KaspaSignTxInit *msg) {
+  kaspa_signing_abort();
+  kaspa_signing = true;
+  memcpy(schema, msg->schema, sizeof(msg->schema));
+  memcpy(prefix, msg->prefix, sizeof(msg->prefix));
+  tx.stage = KASPA_STAGE_INPUTS;
+  tx.inputs_count = msg->inputs_count;
+  tx.outputs_count = msg->outputs_count;
+  tx.version = msg->version;
+  tx.lock_time = msg->lock_time;
+  signing_hash_init(&tx.prev_outputs);
+  signing_hash_init(&tx.sequences);
+  signing_hash_init(&tx.sig_op_counts);
+  signing_hash_init(&tx.outputs);
+  send_request(KaspaRequestType_TXINPUT, 0, NULL, 0);
+}
+
+// Everything after the inputs is known once the outputs are confirmed, so the
+// input hashes are folded into one midstate and the rest of the pre-image is
+// kept as a fixed suffix.
+static void finish_tx_hashes(void) {
+  uint8_t hash[32] = {0};
+  signing_hash_init(&tx.midstate);
+  hash_le(&tx.midstate, tx.version, 2);
+  blake2b_Final(&tx.prev_outputs, hash, 32);
+  blake2b_Update(&tx.midstate, hash, 32);
+  blake2b_Final(&tx.sequences, hash, 32);
+  blake2b_Update(&tx.midstate, hash, 32);
+  blake2b_Final(&tx.sig_op_counts, hash, 32);
+  blake2b_Update(&tx.midstate, hash, 32);
+
+  memzero(tx.suffix, sizeof(tx.suffix));
+  uint8_t *p = tx.suffix;
+  blake2b_Final(&tx.outputs, p, 32);
+  p += 32;
+  for (int i = 0; i < 8; i++) {
+    *p++ = tx.lock_time >> (8 * i);
+  }
+  // Native subnetwork id, zero gas and the zero hash of an empty payload.
+  p += 20 + 8 + 32;
+  *p = SIGHASH_ALL;
+}
+
+void kaspa_sign_tx_input(const HDNode *node, const KaspaTxAckInput *msg) {
+  if (!kaspa_signing ||
+      (tx.stage != KASPA_STAGE_INPUTS && tx.stage != KASPA_STAGE_SIGN)) {
+    signing_fail(FailureType_Failure_UnexpectedMessage,
+                 "Not in Kaspa signing mode");
+    return;
+  }
+  if (msg->prev_hash.size != 32) {
+    signing_fail(FailureType_Failure_DataError, "Invalid previous tx hash");
+    return;
+  }
+
+  uint8_t payload[PUBKEY_ECDSA_LEN + 1] = {0};
+  size_t payload_len = node_payload(node, payload);
+
+  if (tx.stage == KASPA_STAGE_INPUTS) {
+    if (msg->amount > UINT64_MAX - tx.total_in) {
+      signing_fail(FailureType_Failure_DataError, "Value overflow");
       return;
     }
-    *signature_len = 64;
-#endif
-  } else {
-    // ecdsa sign
-#if EMULATOR
-    CALCULATE_SIGNING_HASH_ECDSA
-    tx_sign_ecdsa(&secp256k1, node->private_key, ecdsa_digest, signature,
-                  signature_len);
-#else
-    CALCULATE_SIGNING_HASH_ECDSA;
-    uint8_t sig[64];
-    int ret = hdnode_sign_digest(node, ecdsa_digest, sig, NULL, NULL);
-    if (ret != 0) {
-      fsm_sendFailure(FailureType_Failure_ProcessError, "Signing failed");
-      kaspa_signing_abort();
-      return;
+    tx.total_in += msg->amount;
+    hash_outpoint(&tx.prev_outputs, msg);
+    hash_le(&tx.sequences, msg->sequence, 8);
+    hash_le(&tx.sig_op_counts, msg->sig_op_count, 1);
+    if (tx.index == 0) {
+      cash_addr_encode(tx.signer, prefix, payload, payload_len);
     }
-    *signature_len = ecdsa_sig_to_der(sig, signature);
-#endif
+    tx.index++;
+    if (tx.index < tx.inputs_count) {
+      send_request(KaspaRequestType_TXINPUT, tx.index, NULL, 0);
+    } else {
+      tx.stage = KASPA_STAGE_OUTPUTS;
+      tx.index = 0;
+      send_request(KaspaRequestType_TXOUTPUT, 0, NULL, 0);
+    }
+    return;
+  }
+
+  // A sighash commits only to the amount of its own input, not to the other
+  // inputs, so signing no more than the confirmed total bounds the fee only
+  // for the signatures of this session. Signatures of the same inputs made in
+  // another session, with other amounts, can still be combined with these.
+  if (msg->amount > tx.authorized_in) {
+    signing_fail(FailureType_Failure_DataError,
+                 "Transaction has changed during signing");
+    return;
+  }
+  tx.authorized_in -= msg->amount;
+
+  uint8_t script[SCRIPT_MAX_LEN] = {0};
+  size_t script_len = payload_to_script(payload, payload_len, script);
+  uint8_t digest[32] = {0};
+  BLAKE2B_CTX ctx;
+  memcpy(&ctx, &tx.midstate, sizeof(ctx));
+  hash_outpoint(&ctx, msg);
+  hash_script_public_key(&ctx, script, script_len);
+  hash_le(&ctx, msg->amount, 8);
+  hash_le(&ctx, msg->sequence, 8);
+  hash_le(&ctx, msg->sig_op_count, 1);
+  blake2b_Update(&ctx, tx.suffix, sizeof(tx.suffix));
+  blake2b_Final(&ctx, digest, 32);
+
+  uint8_t signature[71] = {0};
+  pb_size_t signature_len = 0;
+  if (!sign_digest(node, digest, signature, &signature_len)) {
+    signing_fail(FailureType_Failure_ProcessError, "Signing failed");
+    return;
+  }
+  tx.index++;
+  if (tx.index < tx.inputs_count) {
+    send_request(KaspaRequestType_TXINPUT, tx.index, signature, signature_len);
+  } else {
+    send_request(KaspaRequestType_TXFINISHED, 0, signature, signature_len);
+    kaspa_signing_abort();
+  }
+}
+
+void kaspa_sign_tx_output(const KaspaTxAckOutput *msg) {
+  if (!kaspa_signing || tx.stage != KASPA_STAGE_OUTPUTS) {
+    signing_fail(FailureType_Failure_UnexpectedMessage,
+                 "Not in Kaspa signing mode");
+    return;
+  }
+  uint8_t payload[65] = {0};
+  size_t payload_len = 0;
+  uint8_t script[SCRIPT_MAX_LEN] = {0};
+  size_t script_len = 0;
+  if (cash_addr_decode(payload, &payload_len, prefix, msg->address)) {
+    script_len = payload_to_script(payload, payload_len, script);
+  }
+  if (script_len == 0) {
+    signing_fail(FailureType_Failure_DataError, "Invalid address");
+    return;
+  }
+  if (msg->amount > UINT64_MAX - tx.total_out) {
+    signing_fail(FailureType_Failure_DataError, "Value overflow");
+    return;
+  }
+  tx.total_out += msg->amount;
+  hash_le(&tx.outputs, msg->amount, 8);
+  hash_script_public_key(&tx.outputs, script, script_len);
+  tx.index++;
+
+  const bool last = tx.index == tx.outputs_count;
+  if (last && tx.total_out > tx.total_in) {
+    signing_fail(FailureType_Failure_DataError, "Not enough funds");
+    return;
+  }
+  char amount_str[32] = {0};
+  char fee_str[32] = {0};
+  bn_format_uint64(msg->amount, NULL, " KAS", 8, 0, false, ',', amount_str,
+                   sizeof(amount_str));
+  if (last) {
+    bn_format_uint64(tx.total_in - tx.total_out, NULL, " KAS", 8, 0, false,
+                     ',', fee_str, sizeof(fee_str));
+  }
+  if (!layoutTransactionSign("Kaspa", 0, false, amount_str, msg->address,
+                             tx.signer, NULL, NULL, NULL, 0,
+                             last ? _(I__FEE_COLON) : NULL,
+                             last ? fee_str : NULL, NULL, NULL, NULL, NULL,
+                             NULL, NULL)) {
+    signing_fail(FailureType_Failure_ActionCancelled,
+                 "Signing cancelled by user");
+    return;
+  }
+
+  if (!last) {
+    send_request(KaspaRequestType_TXOUTPUT, tx.index, NULL, 0);
+    return;
   }
+  finish_tx_hashes();
+  tx.authorized_in = tx.total_in;
+  tx.stage = KASPA_STAGE_SIGN;
+  tx.index = 0;
+  send_request(KaspaRequestType_TXINPUT, 0, NULL, 0);
 }
@@ -11,6 +11,9 @@ void kaspa_sign_sighash(HDNode *node, const uint8_t *raw_message,
                         pb_size_t *signature_len);
 void kaspa_signing_init(const KaspaSignTx *msg);
 void kaspa_signing_abort(void);
+void kaspa_sign_tx_init(const KaspaSignTxInit *msg);
+void kaspa_sign_tx_input(const HDNode *node, const KaspaTxAckInput *msg);
+void kaspa_sign_tx_output(const KaspaTxAckOutput *msg);
 
 extern uint16_t input_count;
 extern uint16_t input_index;
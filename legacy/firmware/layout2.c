@@ -1435,6 +1435,42 @@ void layoutResetWord(const char *word, int pass, int word_pos, bool last) {
 
 #define QR_MAX_VERSION 9
 
+// qrcodegen_Mask_AUTO (-1) scores all eight masks, build with QR_MASK=0..7
+// to use a fixed mask and skip the penalty evaluation
+#define QR_ENCODE_MASK ((enum qrcodegen_Mask)QR_MASK)
+
+// columns of the address QR code area, kept rendered while the address
+// dialog toggles between the text and the QR code screen
+#define QR_ADDRESS_X 32
+#define QR_ADDRESS_WIDTH 64
+
+static struct {
+  bool valid;
+  bool ignorecase;
+  char address[132];
+  uint8_t columns[QR_ADDRESS_WIDTH * OLED_HEIGHT / 8];
+} qr_address_cache;
+
+#if DEBUG_LINK
+static LayoutAddressStats qr_address_stats;
+
+const LayoutAddressStats *layoutAddressGetStats(void) {
+  return &qr_address_stats;
+}
+#endif
+
+void layoutAddressCacheClear(void) {
+  memzero(&qr_address_cache, sizeof(qr_address_cache));
+#if DEBUG_LINK
+  memzero(&qr_address_stats, sizeof(qr_address_stats));
+#endif
+}
+
+static bool layoutAddressCached(const char *address, bool ignorecase) {
+  return qr_address_cache.valid && qr_address_cache.ignorecase == ignorecase &&
+         strcmp(qr_address_cache.address, address) == 0;
+}
+
 uint8_t layoutAddress(const char *address, const char *address_type,
                       const char *desc, bool qrcode, bool path, bool ignorecase,
                       const uint32_t *address_n, size_t address_n_count,
@@ -1448,7 +1484,10 @@ uint8_t layoutAddress(const char *address, const char *address_type,
   uint8_t key = KEY_NULL;
 
   uint32_t addrlen = strlen(address);
-  if (qrcode) {
+  if (qrcode && layoutAddressCached(address, ignorecase)) {
+    oledBufferRestoreColumns(QR_ADDRESS_X, QR_ADDRESS_WIDTH,
+                             qr_address_cache.columns);
+  } else if (qrcode) {
     char address_upcase[addrlen + 1];
     memset(address_upcase, 0, sizeof(address_upcase));
     if (ignorecase) {
@@ -1464,18 +1503,35 @@ uint8_t layoutAddress(const char *address, const char *address_type,
     int side = 0;
     if (qrcodegen_encodeText(ignorecase ? address_upcase : address, tempdata,
                              codedata, qrcodegen_Ecc_LOW, 11, 11,
-                             qrcodegen_Mask_AUTO, true)) {
+                             QR_ENCODE_MASK, true)) {
       side = qrcodegen_getSize(codedata);
     }
 
     oledInvert(33, 1, 95, 63);
     int offset = 32 - (side / 2);
     for (int i = 0; i < side; i++) {
+      uint64_t column = 0;
       for (int j = 0; j < side; j++) {
         if (qrcodegen_getModule(codedata, i, j)) {
-          oledClearPixel(32 + offset + i, offset + j);
+          column |= (uint64_t)1 << (offset + j);
         }
       }
+      oledClearColumn(32 + offset + i, column);
+#if DEBUG_LINK
+      qr_address_stats.columns++;
+#endif
+    }
+#if DEBUG_LINK
+    qr_address_stats.encodes++;
+#endif
+
+    if (side && addrlen < sizeof(qr_address_cache.address)) {
+      oledBufferLoadColumns(QR_ADDRESS_X, QR_ADDRESS_WIDTH,
+                            qr_address_cache.columns);
+      strlcpy(qr_address_cache.address, address,
+              sizeof(qr_address_cache.address));
+      qr_address_cache.ignorecase = ignorecase;
+      qr_address_cache.valid = true;
     }
   } else if (path) {
     layoutHeader(desc);
@@ -1607,7 +1663,7 @@ void layoutQRCode(const char *index, const BITMAP *bmp_up,
   }
   if (qrcodegen_encodeText(text, tempdata, codedata, qrcodegen_Ecc_LOW,
                            qrcodegen_VERSION_MIN, QR_MAX_VERSION,
-                           qrcodegen_Mask_AUTO, true)) {
+                           QR_ENCODE_MASK, true)) {
     side = qrcodegen_getSize(codedata);
     times = h / side;
     int x = 64 - times * side / 2;
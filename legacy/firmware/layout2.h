@@ -95,6 +95,16 @@ uint8_t layoutAddress(const char *address, const char *address_type,
                       const char *desc, bool qrcode, bool path, bool ignorecase,
                       const uint32_t *address_n, size_t address_n_count,
                       bool address_is_account, bool is_multisig);
+void layoutAddressCacheClear(void);
+#if DEBUG_LINK
+typedef struct {
+  uint32_t encodes;  // QR codes encoded and drawn
+  uint32_t columns;  // display columns written while drawing them
+} LayoutAddressStats;
+
+// counts for the last address dialog
+const LayoutAddressStats *layoutAddressGetStats(void);
+#endif
 void layoutPublicKey(const uint8_t *pubkey);
 bool layoutXPUB(const char *coin_name, const char *xpub,
                 const uint32_t *address_n, size_t address_n_count);
@@ -24,7 +24,9 @@
 #include "gettext.h"
 #include "memzero.h"
 #include "messages.h"
+#include "profile.h"
 #include "si2c.h"
+#include "timer.h"
 #include "trezor.h"
 #include "util.h"
 
@@ -70,149 +72,201 @@ void MessageProcessFunc(char type, char dir, uint16_t msg_id, void *ptr) {
   }
 }
 
-// Buffer for outgoing USB packets.
-static uint32_t msg_out_start = 0;
-uint32_t msg_out_end = 0;
-static uint32_t msg_out_cur = 0;
+// Queue of outgoing USB packets.  Packets start..end-1 are complete and
+// waiting for the transport, packet end is being filled up to cur.  One
+// packet is always kept free so that a full queue is not mistaken for an
+// empty one.
+typedef struct {
+  uint8_t *buf;
+  uint32_t packets;
+  uint32_t start;
+  uint32_t end;
+  uint32_t cur;
+  char type;
+  // whether the transport may be asked to drain the queue while encoding
+  bool backpressure;
+  // whether packets of the message being encoded were already sent
+  bool flushed;
+} MsgOutQueue;
+
 uint8_t msg_out[MSG_OUT_BUFFER_SIZE];
 _Static_assert(MSG_OUT_BUFFER_SIZE % USB_PACKET_SIZE == 0,
                "MSG_OUT_BUFFER_SIZE");
+static MsgOutQueue msg_out_queue = {
+    .buf = msg_out,
+    .packets = MSG_OUT_BUFFER_SIZE / USB_PACKET_SIZE,
+    .type = 'n',
+};
 
 #if DEBUG_LINK
 
-static uint32_t msg_debug_out_start = 0;
-static uint32_t msg_debug_out_end = 0;
-static uint32_t msg_debug_out_cur = 0;
 static uint8_t msg_debug_out[MSG_DEBUG_OUT_BUFFER_SIZE];
 _Static_assert(MSG_DEBUG_OUT_BUFFER_SIZE % USB_PACKET_SIZE == 0,
                "MSG_DEBUG_OUT_BUFFER_SIZE");
+static MsgOutQueue msg_debug_out_queue = {
+    .buf = msg_debug_out,
+    .packets = MSG_DEBUG_OUT_BUFFER_SIZE / USB_PACKET_SIZE,
+    .type = 'd',
+};
 
 #endif
 
-static inline void msg_out_append(uint8_t c) {
-  if (msg_out_cur == 0) {
-    msg_out[msg_out_end * USB_PACKET_SIZE] = '?';
-    msg_out_cur = 1;
-  }
-  msg_out[msg_out_end * USB_PACKET_SIZE + msg_out_cur] = c;
-  msg_out_cur++;
-  if (msg_out_cur == USB_PACKET_SIZE) {
-    msg_out_cur = 0;
-    msg_out_end = (msg_out_end + 1) % (MSG_OUT_BUFFER_SIZE / USB_PACKET_SIZE);
+// Make sure packet q->end can be completed without overwriting packets that
+// were not sent yet.  If the queue is full, let the transport drain it.
+static bool msg_out_reserve(MsgOutQueue *q) {
+  while ((q->end + 1) % q->packets == q->start) {
+    if (!q->backpressure || !usbFlushPacket(q->type)) {
+      return false;
+    }
+    q->flushed = true;
   }
+  return true;
 }
 
-#if DEBUG_LINK
-
-static inline void msg_debug_out_append(uint8_t c) {
-  if (msg_debug_out_cur == 0) {
-    msg_debug_out[msg_debug_out_end * USB_PACKET_SIZE] = '?';
-    msg_debug_out_cur = 1;
-  }
-  msg_debug_out[msg_debug_out_end * USB_PACKET_SIZE + msg_debug_out_cur] = c;
-  msg_debug_out_cur++;
-  if (msg_debug_out_cur == USB_PACKET_SIZE) {
-    msg_debug_out_cur = 0;
-    msg_debug_out_end =
-        (msg_debug_out_end + 1) % (MSG_DEBUG_OUT_BUFFER_SIZE / USB_PACKET_SIZE);
+static bool msg_out_write(MsgOutQueue *q, const uint8_t *buf, size_t count) {
+  while (count > 0) {
+    uint8_t *packet = q->buf + q->end * USB_PACKET_SIZE;
+    if (q->cur == 0) {
+      if (!msg_out_reserve(q)) {
+        return false;
+      }
+      packet[0] = '?';
+      q->cur = 1;
+    }
+    size_t n = MIN(count, USB_PACKET_SIZE - q->cur);
+    memcpy(packet + q->cur, buf, n);
+    q->cur += n;
+    buf += n;
+    count -= n;
+    if (q->cur == USB_PACKET_SIZE) {
+      q->cur = 0;
+      q->end = (q->end + 1) % q->packets;
+    }
   }
+  return true;
 }
 
-#endif
-
-static inline void msg_out_pad(void) {
-  if (msg_out_cur == 0) return;
-  while (msg_out_cur < USB_PACKET_SIZE) {
-    msg_out[msg_out_end * USB_PACKET_SIZE + msg_out_cur] = 0;
-    msg_out_cur++;
-  }
-  msg_out_cur = 0;
-  msg_out_end = (msg_out_end + 1) % (MSG_OUT_BUFFER_SIZE / USB_PACKET_SIZE);
+static void msg_out_pad(MsgOutQueue *q) {
+  if (q->cur == 0) return;
+  memzero(q->buf + q->end * USB_PACKET_SIZE + q->cur,
+          USB_PACKET_SIZE - q->cur);
+  q->cur = 0;
+  q->end = (q->end + 1) % q->packets;
 }
 
 #if DEBUG_LINK
 
-static inline void msg_debug_out_pad(void) {
-  if (msg_debug_out_cur == 0) return;
-  while (msg_debug_out_cur < USB_PACKET_SIZE) {
-    msg_debug_out[msg_debug_out_end * USB_PACKET_SIZE + msg_debug_out_cur] = 0;
-    msg_debug_out_cur++;
+// Main interface packet counters, shared by all transports.
+static MsgPacketStats packet_stats;
+static uint32_t packet_stats_window_start;
+static uint32_t packet_stats_window_in;
+static uint32_t packet_stats_window_out;
+
+// Close the rate window once a second has passed.
+static void msg_packet_stats_update(void) {
+  uint32_t now = timer_ms();
+  uint32_t elapsed = now - packet_stats_window_start;
+  if (elapsed < 1000) {
+    return;
   }
-  msg_debug_out_cur = 0;
-  msg_debug_out_end =
-      (msg_debug_out_end + 1) % (MSG_DEBUG_OUT_BUFFER_SIZE / USB_PACKET_SIZE);
+  packet_stats.packets_in_per_sec =
+      (packet_stats.packets_in - packet_stats_window_in) * 1000 / elapsed;
+  packet_stats.packets_out_per_sec =
+      (packet_stats.packets_out - packet_stats_window_out) * 1000 / elapsed;
+  packet_stats_window_start = now;
+  packet_stats_window_in = packet_stats.packets_in;
+  packet_stats_window_out = packet_stats.packets_out;
+}
+
+const MsgPacketStats *msg_get_packet_stats(void) {
+  msg_packet_stats_update();
+  return &packet_stats;
 }
 
 #endif
 
+static const uint8_t *msg_out_pop(MsgOutQueue *q) {
+  if (q->start == q->end) return 0;
+  uint8_t *data = q->buf + (q->start * USB_PACKET_SIZE);
+  q->start = (q->start + 1) % q->packets;
+  return data;
+}
+
 static bool pb_callback_out(pb_ostream_t *stream, const uint8_t *buf,
                             size_t count) {
-  (void)stream;
-  for (size_t i = 0; i < count; i++) {
-    msg_out_append(buf[i]);
-  }
-  return true;
+  return msg_out_write((MsgOutQueue *)stream->state, buf, count);
 }
 
-#if DEBUG_LINK
-
-static bool pb_debug_callback_out(pb_ostream_t *stream, const uint8_t *buf,
-                                  size_t count) {
-  (void)stream;
-  for (size_t i = 0; i < count; i++) {
-    msg_debug_out_append(buf[i]);
-  }
-  return true;
+// Write the header "##<msg_id><len>" and the encoded message into the queue.
+// If max_size is SIZE_MAX, the length is not known yet and left zero.
+static bool msg_out_encode(MsgOutQueue *q, uint16_t msg_id,
+                           const pb_msgdesc_t *fields, const void *msg_ptr,
+                           size_t max_size, size_t *len) {
+  uint32_t size = max_size == SIZE_MAX ? 0 : max_size;
+  uint8_t header[MSG_HEADER_SIZE - 1] = {'#', '#'};
+  header[2] = (msg_id >> 8) & 0xFF;
+  header[3] = msg_id & 0xFF;
+  header[4] = (size >> 24) & 0xFF;
+  header[5] = (size >> 16) & 0xFF;
+  header[6] = (size >> 8) & 0xFF;
+  header[7] = size & 0xFF;
+  pb_ostream_t stream = {pb_callback_out, q, max_size, 0, 0};
+  bool status = msg_out_write(q, header, sizeof(header)) &&
+                pb_encode(&stream, fields, msg_ptr);
+  *len = stream.bytes_written;
+  return status;
 }
 
-#endif
-
 bool msg_write_common(char type, uint16_t msg_id, const void *msg_ptr) {
+  PROFILE_SCOPE(PROFILE_ENCODE);
   const pb_msgdesc_t *fields = MessageFields(type, 'o', msg_id);
   if (!fields) {  // unknown message
     return false;
   }
 
-  size_t len = 0;
-  if (!pb_get_encoded_size(&len, fields, msg_ptr)) {
-    return false;
-  }
-
-  void (*append)(uint8_t) = NULL;
-  bool (*pb_callback)(pb_ostream_t *, const uint8_t *, size_t);
-
+  MsgOutQueue *q = NULL;
   if (type == 'n') {
-    append = msg_out_append;
-    pb_callback = pb_callback_out;
+    q = &msg_out_queue;
   } else
 #if DEBUG_LINK
       if (type == 'd') {
-    append = msg_debug_out_append;
-    pb_callback = pb_debug_callback_out;
+    q = &msg_debug_out_queue;
   } else
 #endif
   {
     return false;
   }
 
-  append('#');
-  append('#');
-  append((msg_id >> 8) & 0xFF);
-  append(msg_id & 0xFF);
-  append((len >> 24) & 0xFF);
-  append((len >> 16) & 0xFF);
-  append((len >> 8) & 0xFF);
-  append(len & 0xFF);
-  pb_ostream_t stream = {pb_callback, 0, SIZE_MAX, 0, 0};
-  bool status = pb_encode(&stream, fields, msg_ptr);
-  if (type == 'n') {
-    msg_out_pad();
-  }
-#if DEBUG_LINK
-  else if (type == 'd') {
-    msg_debug_out_pad();
+  // The size in the header is not known before the message is encoded.
+  // A message that fits into the free part of the queue is encoded once and
+  // its size is patched into the first packet afterwards.  Only a message
+  // that does not fit is sized upfront and then streamed, letting the
+  // transport drain the queue as it fills up.
+  uint32_t first = q->end;
+  size_t len = 0;
+  q->backpressure = false;
+  q->flushed = false;
+  bool status = msg_out_encode(q, msg_id, fields, msg_ptr, SIZE_MAX, &len);
+  if (status) {
+    uint8_t *header = q->buf + first * USB_PACKET_SIZE;
+    header[5] = (len >> 24) & 0xFF;
+    header[6] = (len >> 16) & 0xFF;
+    header[7] = (len >> 8) & 0xFF;
+    header[8] = len & 0xFF;
+  } else {
+    q->end = first;
+    q->cur = 0;
+    q->backpressure = true;
+    status = pb_get_encoded_size(&len, fields, msg_ptr) &&
+             msg_out_encode(q, msg_id, fields, msg_ptr, len, &len);
+    q->backpressure = false;
+    if (!status && !q->flushed) {
+      // nothing was sent yet, drop the partial message
+      q->end = first;
+      q->cur = 0;
+    }
   }
-#endif
+  msg_out_pad(q);
 #if !EMULATOR
   if (CHANNEL_SLAVE == host_channel) {
     const uint8_t *data;
@@ -229,7 +283,7 @@ bool msg_write_common(char type, uint16_t msg_id, const void *msg_ptr) {
   return status;
 }
 
-void clear_msg_out(void) { msg_out_start = msg_out_end; }
+void clear_msg_out(void) { msg_out_queue.start = msg_out_queue.end; }
 
 enum {
   READSTATE_IDLE,
@@ -244,14 +298,25 @@ void msg_process(char type, uint16_t msg_id, const pb_msgdesc_t *fields,
   static uint8_t msg_decoded[MSG_IN_DECODED_SIZE]
       __attribute__((section(".secMessageSection")));
   memzero(msg_decoded, sizeof(msg_decoded));
+#if DEBUG_LINK
+  // DebugLink messages may arrive while another message is being handled
+  uint16_t prev_msg_id = profile_set_message(msg_id);
+#endif
   pb_istream_t stream = pb_istream_from_buffer(msg_raw, msg_size);
-  bool status = pb_decode(&stream, fields, msg_decoded);
+  bool status = false;
+  {
+    PROFILE_SCOPE(PROFILE_DECODE);
+    status = pb_decode(&stream, fields, msg_decoded);
+  }
   if (status) {
     msg_command_inprogress = true;
     MessageProcessFunc(type, 'i', msg_id, msg_decoded);
   } else {
     fsm_sendFailure(FailureType_Failure_DataError, stream.errmsg);
   }
+#if DEBUG_LINK
+  profile_set_message(prev_msg_id);
+#endif
 }
 
 void msg_read_common(char type, const uint8_t *buf, uint32_t len) {
@@ -265,6 +330,13 @@ void msg_read_common(char type, const uint8_t *buf, uint32_t len) {
 
   if (len != USB_PACKET_SIZE) return;
 
+#if DEBUG_LINK
+  if (type == 'n') {
+    packet_stats.packets_in++;
+    msg_packet_stats_update();
+  }
+#endif
+
   if (read_state == READSTATE_IDLE) {
     if (buf[0] != '?' || buf[1] != '#' ||
         buf[2] != '#') {  // invalid start - discard
@@ -308,22 +380,51 @@ void msg_read_common(char type, const uint8_t *buf, uint32_t len) {
   }
 }
 
+#if EMULATOR
+void msg_read_message(char type, uint8_t *buf, uint32_t len) {
+  if (len < MSG_HEADER_SIZE - 1 || buf[0] != '#' || buf[1] != '#') {
+    return;
+  }
+  uint16_t msg_id = (buf[2] << 8) + buf[3];
+  uint32_t msg_size =
+      ((uint32_t)buf[4] << 24) + (buf[5] << 16) + (buf[6] << 8) + buf[7];
+  if (msg_size != len - (MSG_HEADER_SIZE - 1)) {
+    return;
+  }
+
+  const pb_msgdesc_t *fields = MessageFields(type, 'i', msg_id);
+  if (!fields) {  // unknown message
+    fsm_sendFailure(FailureType_Failure_UnexpectedMessage, "Unknown message");
+    return;
+  }
+  if (msg_size > MSG_IN_ENCODED_SIZE) {  // message is too big :(
+    fsm_sendFailure(FailureType_Failure_DataError, "Message too big");
+    return;
+  }
+
+  msg_process(type, msg_id, fields, buf + MSG_HEADER_SIZE - 1, msg_size);
+}
+#endif
+
 const uint8_t *msg_out_data(void) {
-  if (msg_out_start == msg_out_end) return 0;
-  uint8_t *data = msg_out + (msg_out_start * USB_PACKET_SIZE);
-  msg_out_start = (msg_out_start + 1) % (MSG_OUT_BUFFER_SIZE / USB_PACKET_SIZE);
-  debugLog(0, "", "msg_out_data");
+  const uint8_t *data = msg_out_pop(&msg_out_queue);
+  if (data) {
+    debugLog(0, "", "msg_out_data");
+#if DEBUG_LINK
+    packet_stats.packets_out++;
+    msg_packet_stats_update();
+#endif
+  }
   return data;
 }
 
 #if DEBUG_LINK
 
 const uint8_t *msg_debug_out_data(void) {
-  if (msg_debug_out_start == msg_debug_out_end) return 0;
-  uint8_t *data = msg_debug_out + (msg_debug_out_start * USB_PACKET_SIZE);
-  msg_debug_out_start =
-      (msg_debug_out_start + 1) % (MSG_DEBUG_OUT_BUFFER_SIZE / USB_PACKET_SIZE);
-  debugLog(0, "", "msg_debug_out_data");
+  const uint8_t *data = msg_out_pop(&msg_debug_out_queue);
+  if (data) {
+    debugLog(0, "", "msg_debug_out_data");
+  }
   return data;
 }
 
@@ -68,12 +68,25 @@ void clear_msg_out(void);
 #define msg_debug_write(id, ptr) msg_write_common('d', (id), (ptr))
 const uint8_t *msg_debug_out_data(void);
 
+typedef struct {
+  uint32_t packets_in;
+  uint32_t packets_out;
+  uint32_t packets_in_per_sec;
+  uint32_t packets_out_per_sec;
+} MsgPacketStats;
+
+const MsgPacketStats *msg_get_packet_stats(void);
+
 #endif
 
-extern uint32_t msg_out_end;
 extern uint8_t msg_out[MSG_OUT_BUFFER_SIZE];
 
 void msg_read_common(char type, const uint8_t *buf, uint32_t len);
+#if EMULATOR
+// Process a whole message "##<2 bytes msg_id><4 bytes msg_size><payload>"
+// received over a stream transport.
+void msg_read_message(char type, uint8_t *buf, uint32_t len);
+#endif
 bool msg_write_common(char type, uint16_t msg_id, const void *msg_ptr);
 
 void msg_read_tiny(const uint8_t *buf, int len);
@@ -619,20 +619,6 @@ bool nem_fsmMultisig(nem_transaction_ctx *context,
   return true;
 }
 
-const NEMMosaicDefinition *nem_mosaicByName(const char *namespace,
-                                            const char *mosaic,
-                                            uint8_t network) {
-  for (size_t i = 0; i < NEM_MOSAIC_DEFINITIONS_COUNT; i++) {
-    const NEMMosaicDefinition *definition = &NEM_MOSAIC_DEFINITIONS[i];
-
-    if (nem_mosaicMatches(definition, namespace, mosaic, network)) {
-      return definition;
-    }
-  }
-
-  return NULL;
-}
-
 static inline size_t format_amount(const NEMMosaicDefinition *definition,
                                    const bignum256 *amnt,
                                    const bignum256 *multiplier, int divisor,
@@ -13,14 +13,25 @@ ATTRIBUTES_OPTIONAL = (
 	("levy_namespace", c_str),
 	("levy_mosaic", c_str),
 )
+
+mosaics = list(supported_on("trezor1", nem))
+
+# positions in NEM_MOSAIC_DEFINITIONS ordered by namespace and mosaic; equal
+# names keep their table order, so the first network match is the same as
+# with a linear scan
+by_name = [i for i, _ in sorted(enumerate(mosaics), key=lambda e: (e[1]["namespace"].encode(), e[1]["mosaic"].encode(), e[0]))]
 %>\
 // This file is automatically generated from nem_mosaics.c.mako
 // DO NOT EDIT
 
 #include "nem_mosaics.h"
 
+#include <string.h>
+
+#include "nem2.h"
+
 const NEMMosaicDefinition NEM_MOSAIC_DEFINITIONS[NEM_MOSAIC_DEFINITIONS_COUNT] = {
-% for m in supported_on("trezor1", nem):
+% for m in mosaics:
 {
 	% for attr, func in ATTRIBUTES_REQUIRED:
 		% if attr in m:
@@ -43,3 +54,38 @@ const NEMMosaicDefinition NEM_MOSAIC_DEFINITIONS[NEM_MOSAIC_DEFINITIONS_COUNT] =
 };
 
 const NEMMosaicDefinition *NEM_MOSAIC_DEFINITION_XEM = NEM_MOSAIC_DEFINITIONS;
+
+static const uint8_t NEM_MOSAIC_DEFINITIONS_BY_NAME[NEM_MOSAIC_DEFINITIONS_COUNT] = {${", ".join(map(str, by_name))}};
+
+static int nem_mosaicCompareName(const NEMMosaicDefinition *definition,
+                                 const char *namespace, const char *mosaic) {
+	int cmp = strcmp(definition->namespace, namespace);
+	return cmp != 0 ? cmp : strcmp(definition->mosaic, mosaic);
+}
+
+const NEMMosaicDefinition *nem_mosaicByName(const char *namespace,
+                                            const char *mosaic,
+                                            uint8_t network) {
+	size_t lo = 0, hi = NEM_MOSAIC_DEFINITIONS_COUNT;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		const NEMMosaicDefinition *definition = &NEM_MOSAIC_DEFINITIONS[NEM_MOSAIC_DEFINITIONS_BY_NAME[mid]];
+		if (nem_mosaicCompareName(definition, namespace, mosaic) < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	for (; lo < NEM_MOSAIC_DEFINITIONS_COUNT; lo++) {
+		const NEMMosaicDefinition *definition = &NEM_MOSAIC_DEFINITIONS[NEM_MOSAIC_DEFINITIONS_BY_NAME[lo]];
+		if (nem_mosaicCompareName(definition, namespace, mosaic) != 0) {
+			break;
+		}
+		if (nem_mosaicMatches(definition, namespace, mosaic, network)) {
+			return definition;
+		}
+	}
+
+	return NULL;
+}
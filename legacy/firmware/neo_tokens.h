@@ -9,6 +9,9 @@ typedef struct {
   char symbol[32];
 } NeoToken;
 
+#define NEO_TOKENS_COUNT 3
+
+extern const NeoToken neo_tokens[NEO_TOKENS_COUNT];
 extern const NeoToken UNK_TOKEN;
 const NeoToken *neo_token_by_contract_script_hash(
     const uint8_t *contract_script_hash);
@@ -85,7 +85,7 @@ bool protectButton(ButtonRequestType type, bool confirm_only) {
   if (g_bIsBixinAPP) acked = true;
 
   while (timer_out_get(timer_out_oper)) {
-    usbPoll();
+    usbPollWait(USB_POLL_WAIT_MS);
 
     // check for ButtonAck
     if (msg_tiny_id == MessageType_MessageType_ButtonAck) {
@@ -175,7 +175,7 @@ static uint8_t _protectButton_ex(ButtonRequestType type, bool confirm_only,
     if (timeout_s) {
       if (timer_out_get(timer_out_oper) == 0) break;
     }
-    usbPoll();
+    usbPollWait(USB_POLL_WAIT_MS);
 
     // check for ButtonAck
     if (msg_tiny_id == MessageType_MessageType_ButtonAck) {
@@ -275,7 +275,7 @@ const char *requestPin(PinMatrixRequestType type, const char *text,
       pinmatrix_start(text);
       pinmatrix_show = false;
     }
-    usbPoll();
+    usbPollWait(USB_POLL_WAIT_MS);
     buttonUpdate();
     if (msg_tiny_id == MessageType_MessageType_PinMatrixAck) {
       timer_out_set(timer_out_oper, 0);
@@ -617,7 +617,7 @@ bool protectPassphrase(char *passphrase) {
           _(C__ENTER_YOUR_PASSPHRASE_ON_CONNECTED_DEVICE));
       show = false;
     }
-    usbPoll();
+    usbPollWait(USB_POLL_WAIT_MS);
     buttonUpdate();
     if (msg_tiny_id == MessageType_MessageType_PassphraseAck) {
       msg_tiny_id = 0xFFFF;
@@ -744,7 +744,7 @@ uint8_t blindsignWaitKey(void) {
   exitBlindSignByInitialize = false;
 
   usbTiny(1);
-  usbPoll();
+  usbPollWait(USB_POLL_WAIT_MS);
   protectAbortedByInitialize =
       (msg_tiny_id == MessageType_MessageType_Initialize);
   if (protectAbortedByInitialize) {
@@ -782,7 +782,7 @@ uint8_t protectWaitKey(uint32_t time_out, uint8_t mode) {
       if (layoutLast == onboarding) {
 #if !EMULATOR
         timer_sleep_start_reset();
-        unregister_timer("poweroff");
+        unregister_timer(&auto_poweroff_handle);
 #endif
       } else {
         key = KEY_NULL;
@@ -790,7 +790,7 @@ uint8_t protectWaitKey(uint32_t time_out, uint8_t mode) {
         break;
       }
     }
-    usbPoll();
+    usbPollWait(USB_POLL_WAIT_MS);
 #if !EMULATOR
     if ((host_channel == CHANNEL_USB) && ((sys_usbState() == false)) &&
         msg_command_inprogress) {
@@ -1252,7 +1252,8 @@ void enter_sleep(void) {
   if (sleep_count == 1) {
     timer_sleep_start_reset();
     config_getAutoLockDelayMs();  // Cached
-    register_timer("poweroff", timer1s, auto_poweroff_timer);
+    unregister_timer(&auto_poweroff_handle);
+    auto_poweroff_handle = register_timer(timer1s, auto_poweroff_timer, true);
     layoutBack = layoutLast;
     oledBufferLoad(oled_prev);
     if (config_hasPin()) {
@@ -1582,7 +1583,7 @@ bool protectPassphraseOnDevice(char *passphrase) {
   timer_out_set(timer_out_oper, default_oper_time);
 
   while (timer_out_get(timer_out_oper)) {
-    usbPoll();
+    usbPollWait(USB_POLL_WAIT_MS);
 
     // check for ButtonAck
     if (msg_tiny_id == MessageType_MessageType_ButtonAck) {
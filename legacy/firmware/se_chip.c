@@ -65,6 +65,9 @@ typedef enum {
 
 static uint8_t se_session_key[SESSION_KEYLEN];
 static bool se_session_init = false;
+// Bumped on every derivation. The SE signs with the key it derived last, so
+// callers holding on to a derived node compare this before reusing it.
+static uint32_t se_derive_generation = 0;
 
 static uint8_t se_send_buffer[SE_BUF_MAX_LEN];
 static uint8_t se_recv_buffer[SE_BUF_MAX_LEN];
@@ -423,6 +426,8 @@ secbool se_derive_keys(HDNode *out, const char *curve,
   memcpy(APDU_DATA + len, (uint8_t *)address_n, address_n_count * 4);
   len += address_n_count * 4;
 
+  // the previously derived key is gone even if this derivation fails
+  se_derive_generation++;
   if (!se_transmit_mac(SE_INS_DERIVE, 0x00, 0x00, APDU_DATA, len, resp,
                        &resp_len)) {
     return secfalse;
@@ -436,6 +441,8 @@ secbool se_derive_keys(HDNode *out, const char *curve,
   return sectrue;
 }
 
+uint32_t se_get_derive_generation(void) { return se_derive_generation; }
+
 secbool se_reset_storage(void) {
   uint8_t rand[16];
 
@@ -1247,6 +1254,9 @@ secbool se_derive_tweak_private_keys(const uint8_t *root_hash) {
     data = (uint8_t *)root_hash;
     data_len = 32;
   }
+  // the tweak replaces the derived key in the SE, a later signature must not
+  // reuse it as the untweaked key of the same path
+  se_derive_generation++;
   if (!se_transmit_mac(SE_INS_SIGN, 0x00, 0x06, data, data_len, NULL, NULL)) {
     return secfalse;
   }
@@ -1681,6 +1691,8 @@ secbool se_derive_fido_keys(HDNode *out, const char *curve,
 
   cmd[4] = len;
 
+  // the FIDO key may share the SE's key slot with se_derive_keys()
+  se_derive_generation++;
   if (!thd89_transmit(cmd, 5 + len, (uint8_t *)resp, &resp_len)) {
     return secfalse;
   }
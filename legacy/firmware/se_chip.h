@@ -96,6 +96,7 @@ secbool se_gen_session_seed(const char *passphrase, bool cardano);
 secbool se_derive_keys(HDNode *out, const char *curve,
                        const uint32_t *address_n, size_t address_n_count,
                        uint32_t *fingerprint);
+uint32_t se_get_derive_generation(void);
 secbool se_node_sign_digest(const uint8_t *hash, uint8_t *sig, uint8_t *by);
 int se_ecdsa_sign_digest(const uint8_t curve, const uint8_t canonical,
                          const uint8_t *digest, uint8_t *sig, uint8_t *pby);
@@ -32,7 +32,9 @@
 #include "messages.h"
 #include "messages.pb.h"
 #include "protect.h"
+#include "se_chip.h"
 #include "secp256k1.h"
+#include "timer.h"
 #include "transaction.h"
 #include "zkp_bip340.h"
 #ifdef USE_SECP256K1_ZKP_ECDSA
@@ -49,6 +51,20 @@ static AmountUnit amount_unit;
 static bool serialize;
 static CONFIDENTIAL HDNode root;
 static CONFIDENTIAL HDNode node;
+// Path of the key currently held in node. Inputs spending from the same
+// address reuse it instead of deriving it again.
+static uint32_t node_address_n[8];
+static pb_size_t node_address_n_count;
+static bool node_valid;
+#if !EMULATOR
+// The SE signs with the key it derived last, so node is only valid as long as
+// nothing else (GetAddress, FIDO, ...) derived a key in between.
+static uint32_t node_se_generation;
+#endif
+#if DEBUG_LINK
+static SigningTimings timings;
+static uint32_t timings_start;
+#endif
 
 static bool signing = false;
 enum {
@@ -168,6 +184,21 @@ static bool is_replacement;  // Is this a replacement transaction?
 static TxInfo orig_info;
 static uint8_t orig_hash[32];  // TXID of the original transaction.
 
+/* Previous outputs whose amount and scriptPubKey were verified against their
+   transaction in an earlier SignTx. A previous transaction is
+   bound to its TXID, so when the same outpoint is spent again with the same
+   amount and scriptPubKey, e.g. when a rejected transaction is resubmitted
+   with a different fee, it does not need to be streamed again. */
+#define PREVOUT_CACHE_SIZE 32
+
+static struct {
+  struct {
+    bool set;
+    uint8_t id[SHA256_DIGEST_LENGTH];
+  } entries[PREVOUT_CACHE_SIZE];
+  int index;
+} prevout_cache;
+
 /* Variables specific to CoinJoin transactions. */
 static secbool is_coinjoin;  // Is this a CoinJoin transaction?
 static uint64_t coinjoin_coordination_fee_base;
@@ -386,6 +417,16 @@ static bool is_external_input(uint32_t i) {
   return external_inputs[i / 32] & (1 << (i % 32));
 }
 
+#if DEBUG_LINK
+static void timings_mark(uint32_t *phase_ms) {
+  uint32_t now = timer_ms();
+  *phase_ms = now - timings_start;
+  timings_start = now;
+}
+
+const SigningTimings *signing_get_timings(void) { return &timings; }
+#endif
+
 static void report_progress(bool force) {
   static uint32_t update_ctr = 0;
 
@@ -766,6 +807,7 @@ void send_req_finished(void) {
   if (!assert_progress_finished()) {
     return;
   }
+  timings_mark(&timings.sign_ms);
 #endif
   resp.has_request_type = true;
   resp.request_type = RequestType_TXFINISHED;
@@ -901,6 +943,9 @@ void phase2_request_next_output(bool first) {
 
 void phase2_request_next_input(bool first) {
   if (first) {
+#if DEBUG_LINK
+    timings_mark(&timings.check_ms);
+#endif
     idx1 = 0;
   } else if (idx1 < info.inputs_count - 1) {
     idx1++;
@@ -1189,6 +1234,21 @@ static bool derive_node(InputScriptType script_type, pb_size_t address_n_count,
     return false;
   }
 
+#if !EMULATOR
+  if (node_valid && node_se_generation != se_get_derive_generation()) {
+    node_valid = false;
+  }
+#endif
+  if (node_valid && node_address_n_count == address_n_count &&
+      memcmp(node_address_n, address_n,
+             address_n_count * sizeof(uint32_t)) == 0) {
+#if DEBUG_LINK
+    timings.derivations_reused++;
+#endif
+    return true;
+  }
+
+  node_valid = false;
   memcpy(&node, &root, sizeof(HDNode));
   if (hdnode_private_ckd_cached(&node, address_n, address_n_count, NULL) == 0) {
     fsm_sendFailure(FailureType_Failure_ProcessError,
@@ -1196,6 +1256,18 @@ static bool derive_node(InputScriptType script_type, pb_size_t address_n_count,
     signing_abort();
     return false;
   }
+#if DEBUG_LINK
+  timings.derivations++;
+#endif
+
+  if (address_n_count <= sizeof(node_address_n) / sizeof(uint32_t)) {
+    memcpy(node_address_n, address_n, address_n_count * sizeof(uint32_t));
+    node_address_n_count = address_n_count;
+    node_valid = true;
+#if !EMULATOR
+    node_se_generation = se_get_derive_generation();
+#endif
+  }
 
   return true;
 }
@@ -1394,6 +1466,11 @@ void signing_init(const SignTx *msg, const CoinInfo *_coin, const HDNode *_root,
   amount_unit = msg->has_amount_unit ? msg->amount_unit : AmountUnit_BITCOIN;
   serialize = msg->has_serialize ? msg->serialize : true;
   memcpy(&root, _root, sizeof(HDNode));
+  node_valid = false;
+#if DEBUG_LINK
+  memzero(&timings, sizeof(timings));
+  timings_start = timer_ms();
+#endif
 
   if (msg->inputs_count > MAX_INPUTS_COUNT) {
     fsm_sendFailure(FailureType_Failure_DataError, "Too many inputs.");
@@ -1446,6 +1523,7 @@ void signing_init(const SignTx *msg, const CoinInfo *_coin, const HDNode *_root,
   memzero(&coinjoin_authorization, sizeof(coinjoin_authorization));
   memzero(&coinjoin_request, sizeof(coinjoin_request));
   memzero(&coinjoin_request_hasher, sizeof(coinjoin_request_hasher));
+  cryptoMultisigCacheClear();
   is_replacement = false;
   unlocked_schema = unlock;
   signing = true;
@@ -1978,18 +2056,46 @@ static bool signing_add_input(TxInputType *txinput) {
   return true;
 }
 
-// check if the hash of the prevtx matches
-static bool signing_check_prevtx_hash(void) {
-  uint8_t hash[32] = {0};
-  tx_hash_final(&tp, hash, true);
-  if (memcmp(hash, input.prev_hash.bytes, 32) != 0) {
-    fsm_sendFailure(FailureType_Failure_DataError,
-                    "Encountered invalid prevhash");
-    signing_abort();
-    return false;
+void signing_clear_prevout_cache(void) {
+  memzero(&prevout_cache, sizeof(prevout_cache));
+}
+
+static void prevout_cache_id(const TxInputType *txinput, uint8_t *id) {
+  SHA256_CTX ctx = {0};
+  sha256_Init(&ctx);
+  sha256_Update(&ctx, (const uint8_t *)coin->coin_name,
+                strlen(coin->coin_name) + 1);
+  sha256_Update(&ctx, txinput->prev_hash.bytes, txinput->prev_hash.size);
+  sha256_Update(&ctx, (const uint8_t *)&txinput->prev_index, sizeof(uint32_t));
+  sha256_Update(&ctx, (const uint8_t *)&txinput->amount, sizeof(uint64_t));
+  sha256_Update(&ctx, txinput->script_pubkey.bytes,
+                txinput->script_pubkey.size);
+  sha256_Final(&ctx, id);
+}
+
+static bool prevout_cache_contains(const TxInputType *txinput) {
+  uint8_t id[SHA256_DIGEST_LENGTH] = {0};
+  prevout_cache_id(txinput, id);
+  for (int i = 0; i < PREVOUT_CACHE_SIZE; i++) {
+    if (prevout_cache.entries[i].set &&
+        memcmp(prevout_cache.entries[i].id, id, sizeof(id)) == 0) {
+      return true;
+    }
   }
+  return false;
+}
 
-  // prevtx is checked
+static void prevout_cache_add(const TxInputType *txinput) {
+  if (prevout_cache_contains(txinput)) {
+    return;
+  }
+  prevout_cache.entries[prevout_cache.index].set = true;
+  prevout_cache_id(txinput, prevout_cache.entries[prevout_cache.index].id);
+  prevout_cache.index = (prevout_cache.index + 1) % PREVOUT_CACHE_SIZE;
+}
+
+// Proceeds to the next input after the prevtx of the current one is checked.
+static bool signing_next_prevtx(void) {
   progress_step++;
   progress_substep = 0;
 
@@ -2021,6 +2127,21 @@ static bool signing_check_prevtx_hash(void) {
 
   return true;
 }
+
+// check if the hash of the prevtx matches
+static bool signing_check_prevtx_hash(void) {
+  uint8_t hash[32] = {0};
+  tx_hash_final(&tp, hash, true);
+  if (memcmp(hash, input.prev_hash.bytes, 32) != 0) {
+    fsm_sendFailure(FailureType_Failure_DataError,
+                    "Encountered invalid prevhash");
+    signing_abort();
+    return false;
+  }
+
+  prevout_cache_add(&input);
+  return signing_next_prevtx();
+}
 extern bool button_request(const ButtonRequestType code);
 static bool compile_output(TxOutputType *in, TxOutputBinType *out,
                            bool needs_confirm) {
@@ -3101,9 +3222,15 @@ static void phase1_finish(void) {
     }
   }
 
+#if DEBUG_LINK
+  timings_mark(&timings.hash_ms);
+#endif
   if (!signing_confirm_tx()) {
     return;
   }
+#if DEBUG_LINK
+  timings_mark(&timings.confirm_ms);
+#endif
 
 #if DEBUG_LINK
   if (!assert_progress_finished()) {
@@ -3688,6 +3815,15 @@ void signing_txack(TransactionType *tx) {
         }
       }
 
+      if (prevout_cache_contains(&input)) {
+        // The previous output was already verified in an earlier transaction.
+#if DEBUG_LINK
+        timings.prevtxs_reused++;
+#endif
+        signing_next_prevtx();
+        return;
+      }
+
       send_req_3_prev_meta();
       return;
     case STAGE_REQUEST_3_PREV_META:
@@ -4242,6 +4378,8 @@ void signing_abort(void) {
   }
   memzero(&root, sizeof(root));
   memzero(&node, sizeof(node));
+  node_valid = false;
+  cryptoMultisigCacheClear();
 }
 
 bool signing_is_preauthorized(void) {
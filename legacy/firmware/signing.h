@@ -33,5 +33,20 @@ void signing_init(const SignTx *msg, const CoinInfo *_coin, const HDNode *_root,
 void signing_abort(void);
 void signing_txack(TransactionType *tx);
 bool signing_is_preauthorized(void);
+void signing_clear_prevout_cache(void);
+
+#if DEBUG_LINK
+typedef struct {
+  uint32_t hash_ms;     // streaming and hashing inputs and outputs
+  uint32_t confirm_ms;  // waiting for the user to confirm
+  uint32_t check_ms;    // verifying previous and original transactions
+  uint32_t sign_ms;     // signing and serializing
+  uint32_t derivations;
+  uint32_t derivations_reused;
+  uint32_t prevtxs_reused;
+} SigningTimings;
+
+const SigningTimings *signing_get_timings(void);
+#endif
 
 #endif
@@ -23,84 +23,195 @@
 #define WL_MAX_COUNTS ((FLASH_WHITE_LIST_SIZE - WL_HEADER) / sizeof(addr_info))
 #define WL_USEFUL_COUNT 10
 
+#define UTXO_INDEX_SIZE 1024  // power of two, > UTXO_INFO_USEFUL_COUNT
+#define UTXO_INDEX_EMPTY 0xFFFF
+
 static uint32_t INIT_FLAG = 0x5A5A5A5A;
 
 static uint32_t uxto_cache_count = 0;
 static uint32_t uxto_cache_start = 0;
 
-void utxo_cache_info(void) {
-  const uint8_t* data;
-  uint32_t i, m;
-  uxto_cache_count = 0;
-  uxto_cache_start = 0;
-  data =
-      (uint8_t*)flash_get_address(FLASH_USER_DATA_SECTOR, UTXO_CACHE_HEADER, 0);
+// Hash index over the cached records, open addressing on the first bytes of
+// the outpoint hash. Slots hold record numbers in the sector. Records that
+// dropped out of the useful window are left in place and skipped by lookups
+// until the index fills up and is rebuilt.
+static uint16_t utxo_index[UTXO_INDEX_SIZE];
+static uint32_t utxo_index_used = 0;
 
-  for (i = 0; i < UTXO_INFO_TOTLE_COUNT; i++) {
-    for (m = 0; m < UTXO_INFO_LEN; m++) {
-      if (data[m] != 0xff) break;
+// Slots of the live white list entries, and the first never written slot.
+static uint16_t wl_slots[WL_USEFUL_COUNT];
+static uint32_t wl_count = 0;
+static uint32_t wl_end = 0;
+
+static bool user_data_indexed = false;
+
+static const uint8_t* utxo_record(uint32_t n) {
+  return (const uint8_t*)flash_get_address(
+      FLASH_USER_DATA_SECTOR, UTXO_CACHE_HEADER + n * UTXO_INFO_LEN,
+      UTXO_INFO_LEN);
+}
+
+static const addr_info* wl_record(uint32_t n) {
+  return (const addr_info*)flash_get_address(
+      FLASH_USER_DATA_SECTOR,
+      FLASH_WHITE_LIST_OFFSET + WL_HEADER + n * sizeof(addr_info),
+      sizeof(addr_info));
+}
+
+static bool is_erased(const uint8_t* data, uint32_t len) {
+  for (uint32_t i = 0; i < len; i += 4) {
+    if (*(const uint32_t*)(data + i) != 0xFFFFFFFF) {
+      return false;
     }
-    if (m == UTXO_INFO_LEN) break;
-    uxto_cache_count++;
-    data += UTXO_INFO_LEN;
   }
+  return true;
+}
+
+static void write_words(uint32_t offset, const uint8_t* data, uint32_t len) {
+  for (uint32_t i = 0; i < len; i += 4) {
+    uint32_t word = 0;
+    memcpy(&word, data + i, sizeof(word));
+    ensure(flash_write_word(FLASH_USER_DATA_SECTOR, offset + i, word), NULL);
+  }
+}
+
+static uint32_t utxo_index_slot(const uint8_t* hash) {
+  return (hash[0] | (hash[1] << 8)) & (UTXO_INDEX_SIZE - 1);
+}
+
+static void utxo_index_add(uint32_t n) {
+  uint32_t slot = utxo_index_slot(utxo_record(n));
+  while (utxo_index[slot] != UTXO_INDEX_EMPTY) {
+    slot = (slot + 1) & (UTXO_INDEX_SIZE - 1);
+  }
+  utxo_index[slot] = n;
+  utxo_index_used++;
+}
+
+static void utxo_index_build(void) {
+  memset(utxo_index, 0xFF, sizeof(utxo_index));
+  utxo_index_used = 0;
+  for (uint32_t i = 0; i < uxto_cache_count; i++) {
+    utxo_index_add(uxto_cache_start + i);
+  }
+}
+
+// Returns the live record with this outpoint hash, or NULL.
+static const uint8_t* utxo_index_find(const uint8_t* hash) {
+  uint32_t slot = utxo_index_slot(hash);
+  while (utxo_index[slot] != UTXO_INDEX_EMPTY) {
+    const uint32_t n = utxo_index[slot];
+    if (n >= uxto_cache_start && n < uxto_cache_start + uxto_cache_count) {
+      const uint8_t* data = utxo_record(n);
+      if (memcmp(hash, data, 20) == 0) {
+        return data;
+      }
+    }
+    slot = (slot + 1) & (UTXO_INDEX_SIZE - 1);
+  }
+  return NULL;
+}
+
+static void wl_index_build(void) {
+  wl_count = 0;
+  for (wl_end = 0; wl_end < WL_MAX_COUNTS; wl_end++) {
+    const addr_info* addr_data = wl_record(wl_end);
+    if (addr_data->state == 0xaa) {
+      if (wl_count < WL_USEFUL_COUNT) {
+        wl_slots[wl_count++] = wl_end;
+      }
+    } else if (addr_data->state == 0xff) {
+      break;
+    }
+  }
+}
+
+// Returns the position in wl_slots of the address, or -1.
+static int wl_index_find(const char* addr) {
+  for (uint32_t i = 0; i < wl_count; i++) {
+    if (!memcmp(addr, wl_record(wl_slots[i])->address, strlen(addr))) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void utxo_cache_info(void) {
+  uint32_t lo = 0, hi = UTXO_INFO_TOTLE_COUNT;
+  // Records are only appended, so the written ones are followed by erased
+  // ones.
+  while (lo < hi) {
+    const uint32_t mid = lo + (hi - lo) / 2;
+    if (is_erased(utxo_record(mid), UTXO_INFO_LEN)) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  uxto_cache_count = lo;
+  uxto_cache_start = 0;
   if (uxto_cache_count > UTXO_INFO_USEFUL_COUNT) {
     uxto_cache_start = uxto_cache_count - UTXO_INFO_USEFUL_COUNT;
     uxto_cache_count = UTXO_INFO_USEFUL_COUNT;
   }
+  utxo_index_build();
 }
+
+// Rewrites only the live records, the useful utxo window and the white list
+// entries, to the start of their areas.
 void sector_packet(void) {
   uint32_t i;
-  const uint8_t* utxo_data;
   uint8_t utxo_buf[UTXO_INFO_USEFUL_COUNT * UTXO_INFO_LEN];
+  uint32_t utxo_len = uxto_cache_count * UTXO_INFO_LEN;
 
-  const addr_info* addr_data;
   addr_info addr_list[WL_USEFUL_COUNT];
   uint32_t addr_count = 0;
 
-  uint8_t* p = (uint8_t*)addr_list;
-
-  utxo_data = (uint8_t*)flash_get_address(
-      FLASH_USER_DATA_SECTOR,
-      uxto_cache_start * UTXO_INFO_LEN + UTXO_CACHE_HEADER, 0);
   // utxo
-  memcpy(utxo_buf, utxo_data, uxto_cache_count * UTXO_INFO_LEN);
+  if (utxo_len > 0) {
+    memcpy(utxo_buf, utxo_record(uxto_cache_start), utxo_len);
+  }
 
   // white list
-  addr_data = (addr_info*)flash_get_address(
-      FLASH_USER_DATA_SECTOR, FLASH_WHITE_LIST_OFFSET + WL_HEADER, 0);
-  for (i = 0; i < WL_MAX_COUNTS; i++) {
-    if (addr_data[i].state == 0xaa) {
+  for (i = 0; i < WL_MAX_COUNTS && addr_count < WL_USEFUL_COUNT; i++) {
+    const addr_info* addr_data = wl_record(i);
+    if (addr_data->state == 0xaa) {
       memcpy(&addr_list[addr_count++], addr_data, sizeof(addr_info));
+    } else if (addr_data->state == 0xff) {
+      break;
     }
   }
   ensure(flash_erase(FLASH_USER_DATA_SECTOR), "erase failed");
   ensure(flash_unlock_write(), NULL);
-  for (i = 0; i < sizeof(utxo_buf); i++) {
-    ensure(flash_write_byte(FLASH_USER_DATA_SECTOR, UTXO_CACHE_HEADER + i,
-                            utxo_buf[i]),
-           NULL);
-  }
-  for (i = 0; i < addr_count * sizeof(addr_info); i++) {
-    ensure(flash_write_byte(FLASH_USER_DATA_SECTOR,
-                            WL_HEADER + FLASH_WHITE_LIST_OFFSET + i, p[i]),
-           NULL);
-  }
+  write_words(UTXO_CACHE_HEADER, utxo_buf, utxo_len);
+  write_words(FLASH_WHITE_LIST_OFFSET + WL_HEADER, (const uint8_t*)addr_list,
+              addr_count * sizeof(addr_info));
   ensure(flash_write_word(FLASH_USER_DATA_SECTOR, 0, INIT_FLAG), NULL);
   ensure(flash_write_word(FLASH_USER_DATA_SECTOR, FLASH_WHITE_LIST_OFFSET,
                           INIT_FLAG),
          NULL);
   ensure(flash_lock_write(), NULL);
   uxto_cache_start = 0;
+  utxo_index_build();
+  wl_index_build();
+}
+
+static void user_data_index(void) {
+  if (!user_data_indexed) {
+    utxo_cache_info();
+    wl_index_build();
+    user_data_indexed = true;
+  }
 }
 
 bool utxo_cache_check(uint8_t* prv_id, uint32_t index, uint64_t amount) {
   const uint8_t* data;
-  uint32_t i;
   SHA1_CTX sha1_ctx;
   uint8_t sha1_hash[20];
   uint8_t utxo[UTXO_INFO_LEN];
 
+  user_data_index();
+
   sha1_Init(&sha1_ctx);
   sha1_Update(&sha1_ctx, prv_id, 32);
   sha1_Update(&sha1_ctx, (uint8_t*)&index, 4);
@@ -109,35 +220,23 @@ bool utxo_cache_check(uint8_t* prv_id, uint32_t index, uint64_t amount) {
   memcpy(utxo, sha1_hash, sizeof(sha1_hash));
   memcpy(utxo + 20, (uint8_t*)&amount, sizeof(amount));
 
-  data =
-      (uint8_t*)flash_get_address(FLASH_USER_DATA_SECTOR, UTXO_CACHE_HEADER, 0);
-  data += uxto_cache_start * UTXO_INFO_LEN;
-
-  for (i = 0; i < uxto_cache_count; i++) {
-    if (memcmp(sha1_hash, data, 20) == 0) {
-      if (memcmp(data + 20, (uint8_t*)&amount, sizeof(amount))) {
-        return false;
-      } else
-        return true;
-    }
-    data += UTXO_INFO_LEN;
+  data = utxo_index_find(sha1_hash);
+  if (data != NULL) {
+    return memcmp(data + 20, (uint8_t*)&amount, sizeof(amount)) == 0;
   }
+
   // add new item
-  if (data + UTXO_INFO_LEN > (uint8_t*)flash_get_address(FLASH_USER_DATA_SECTOR,
-                                                         FLASH_UTXO_CACHE_SIZE,
-                                                         0)) {
+  if (uxto_cache_start + uxto_cache_count >= UTXO_INFO_TOTLE_COUNT) {
     sector_packet();
   }
-  ensure(flash_unlock_write(), NULL);
-  for (i = 0; i < UTXO_INFO_LEN; i++) {
-    ensure(
-        flash_write_byte(FLASH_USER_DATA_SECTOR,
-                         (uxto_cache_start + uxto_cache_count) * UTXO_INFO_LEN +
-                             UTXO_CACHE_HEADER + i,
-                         utxo[i]),
-        NULL);
+  if (utxo_index_used >= UTXO_INDEX_SIZE * 3 / 4) {
+    utxo_index_build();
   }
+  const uint32_t n = uxto_cache_start + uxto_cache_count;
+  ensure(flash_unlock_write(), NULL);
+  write_words(UTXO_CACHE_HEADER + n * UTXO_INFO_LEN, utxo, UTXO_INFO_LEN);
   ensure(flash_lock_write(), NULL);
+  utxo_index_add(n);
   uxto_cache_count++;
   if (uxto_cache_count > UTXO_INFO_USEFUL_COUNT) {
     uxto_cache_start++;
@@ -175,124 +274,82 @@ void user_data_init(void) {
     utxo_cache_info();
     sector_packet();
   }
-  utxo_cache_info();
+  user_data_indexed = false;
+  user_data_index();
 }
 
 uint32_t white_list_get_count(void) {
-  const addr_info* addr_data;
-  uint32_t i, count;
-  count = 0;
-  addr_data = (addr_info*)flash_get_address(
-      FLASH_USER_DATA_SECTOR, FLASH_WHITE_LIST_OFFSET + WL_HEADER, 0);
-
-  for (i = 0; i < WL_MAX_COUNTS; i++) {
-    if (addr_data[i].state == 0xaa) {
-      count++;
-    } else if (addr_data[i].state == 0xff) {
-      break;
-    }
-  }
-  return count;
+  user_data_index();
+  return wl_count;
 }
 
 bool white_list_check(const char* addr) {
-  const addr_info* addr_data;
-  uint32_t i;
-  addr_data = (addr_info*)flash_get_address(
-      FLASH_USER_DATA_SECTOR, FLASH_WHITE_LIST_OFFSET + WL_HEADER, 0);
-
-  for (i = 0; i < WL_MAX_COUNTS; i++) {
-    if (addr_data[i].state == 0xaa) {
-      if (!memcmp(addr, addr_data[i].address, strlen(addr))) {
-        return true;
-      }
-    } else if (addr_data[i].state == 0xff) {
-      break;
-    }
-  }
-  return false;
+  user_data_index();
+  return wl_index_find(addr) >= 0;
 }
 
 int white_list_add(const char* addr) {
-  const addr_info* addr_data;
   addr_info addr_buf = {0};
-  uint32_t i, count = 0;
-  addr_data = (addr_info*)flash_get_address(
-      FLASH_USER_DATA_SECTOR, FLASH_WHITE_LIST_OFFSET + WL_HEADER, 0);
-
-  for (i = 0; i < WL_MAX_COUNTS; i++) {
-    if (addr_data[i].state == 0xaa) {
-      count++;
-      if (!memcmp(addr, addr_data[i].address, strlen(addr))) {
-        return WHILT_LIST_ADDR_EXIST;
-      }
-    } else if (addr_data[i].state == 0xff) {
-      break;
-    }
+
+  user_data_index();
+  if (wl_index_find(addr) >= 0) {
+    return WHILT_LIST_ADDR_EXIST;
   }
-  if (count == WL_USEFUL_COUNT) {
+  if (wl_count == WL_USEFUL_COUNT) {
     return WHILT_LIST_FULL;
   }
-  if (i == WL_MAX_COUNTS) {
-    sector_packet();
+  ensure(flash_unlock_write(), NULL);
+  // A slot left behind by an interrupted write is retired.
+  while (wl_end < WL_MAX_COUNTS &&
+         !is_erased((const uint8_t*)wl_record(wl_end), sizeof(addr_info))) {
+    const uint32_t offset =
+        FLASH_WHITE_LIST_OFFSET + WL_HEADER + wl_end * sizeof(addr_info);
+    ensure(flash_write_byte(FLASH_USER_DATA_SECTOR, offset, 0x00), NULL);
+    wl_end++;
   }
-  for (i = 0; i < WL_MAX_COUNTS; i++) {
-    if (addr_data[i].state == 0xff) {
-      uint32_t m;
-      uint8_t* p = (uint8_t*)&addr_buf;
-      ensure(flash_unlock_write(), NULL);
-      addr_buf.state = 0xaa;
-      memset(addr_buf.rfu, 0xff, sizeof(addr_buf.rfu));
-      memcpy(addr_buf.address, addr, strlen(addr));
-
-      for (m = 0; m < sizeof(addr_buf); m++) {
-        ensure(flash_write_byte(FLASH_USER_DATA_SECTOR,
-                                i * sizeof(addr_info) +
-                                    FLASH_WHITE_LIST_OFFSET + WL_HEADER + m,
-                                p[m]),
-               NULL);
-      }
-      ensure(flash_lock_write(), NULL);
-      break;
-    }
+  ensure(flash_lock_write(), NULL);
+  if (wl_end == WL_MAX_COUNTS) {
+    sector_packet();
   }
+
+  const uint32_t offset =
+      FLASH_WHITE_LIST_OFFSET + WL_HEADER + wl_end * sizeof(addr_info);
+  addr_buf.state = 0xaa;
+  memset(addr_buf.rfu, 0xff, sizeof(addr_buf.rfu));
+  memcpy(addr_buf.address, addr, strlen(addr));
+  ensure(flash_unlock_write(), NULL);
+  // The word holding the state is written last.
+  write_words(offset + 4, (const uint8_t*)&addr_buf + 4, sizeof(addr_buf) - 4);
+  write_words(offset, (const uint8_t*)&addr_buf, 4);
+  ensure(flash_lock_write(), NULL);
+  wl_slots[wl_count++] = wl_end++;
   return WHITE_LIST_OK;
 }
 
 void white_list_delete(const char* addr) {
-  const addr_info* addr_data;
-  uint32_t i;
-  addr_data = (addr_info*)flash_get_address(
-      FLASH_USER_DATA_SECTOR, FLASH_WHITE_LIST_OFFSET + WL_HEADER, 0);
-
-  for (i = 0; i < WL_MAX_COUNTS; i++) {
-    if (addr_data[i].state == 0xaa) {
-      if (!memcmp(addr, addr_data[i].address, strlen(addr))) {
-        ensure(flash_unlock_write(), NULL);
-        ensure(flash_write_byte(
-                   FLASH_USER_DATA_SECTOR,
-                   i * sizeof(addr_info) + FLASH_WHITE_LIST_OFFSET + WL_HEADER,
-                   0x00),
-               NULL);
-        ensure(flash_lock_write(), NULL);
-        break;
-      }
-    }
+  user_data_index();
+  const int i = wl_index_find(addr);
+  if (i < 0) {
+    return;
   }
+  ensure(flash_unlock_write(), NULL);
+  ensure(flash_write_byte(FLASH_USER_DATA_SECTOR,
+                          wl_slots[i] * sizeof(addr_info) +
+                              FLASH_WHITE_LIST_OFFSET + WL_HEADER,
+                          0x00),
+         NULL);
+  ensure(flash_lock_write(), NULL);
+  wl_count--;
+  memmove(&wl_slots[i], &wl_slots[i + 1],
+          (wl_count - i) * sizeof(wl_slots[0]));
 }
 
 void white_list_inquiry(char data[][130], uint16_t* count) {
-  const addr_info* addr_data;
-  uint32_t i, num = 0;
-  addr_data = (addr_info*)flash_get_address(
-      FLASH_USER_DATA_SECTOR, FLASH_WHITE_LIST_OFFSET + WL_HEADER, 0);
-
-  for (i = 0; i < WL_MAX_COUNTS; i++) {
-    if (addr_data[i].state == 0xaa) {
-      memcpy(data[num++], addr_data[i].address, strlen(addr_data[i].address));
-    } else if (addr_data[i].state == 0xff) {
-      break;
-    }
+  uint32_t i;
+  user_data_index();
+  for (i = 0; i < wl_count; i++) {
+    const addr_info* addr_data = wl_record(wl_slots[i]);
+    memcpy(data[i], addr_data->address, strlen(addr_data->address));
   }
-  *count = num;
+  *count = wl_count;
 }
@@ -0,0 +1,237 @@
+/*
+ * This file is part of the Trezor project, https://trezor.io/
+ *
+ * Copyright (C) 2014 Pavol Rusnak <stick@satoshilabs.com>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host test for the Cosmos display items recorded by tx_display_query. Every
+// page of every item of a sign document is rendered from the recorded items
+// and again by walking the JSON tree, and both must be the same. The display
+// code is included as a source file to reach the recorded items. Built and
+// run by `make test` in an emulator build.
+
+#include <stdio.h>
+
+#include "cosmos/parser.h"
+#include "cosmos/tx_display.c"
+
+static int failures = 0;
+static int checks = 0;
+
+typedef struct {
+  const char *name;
+  const char *json;
+  bool recorded;  // whether every item fits in the recorded items
+} SignDoc;
+
+static const SignDoc docs[] = {
+    {"one message",
+     "{\"account_number\":\"7\",\"chain_id\":\"cosmoshub-4\",\"fee\":{\"amount"
+     "\":[{\"amount\":\"5000\",\"denom\":\"uatom\"}],\"gas\":\"200000\"},\"mem"
+     "o\":\"hello\",\"msgs\":[{\"type\":\"cosmos-sdk/MsgSend\",\"value\":{\"am"
+     "ount\":[{\"amount\":\"1000\",\"denom\":\"uatom\"}],\"from_address\":\"co"
+     "smos1from\",\"to_address\":\"cosmos1to00\"}}],\"sequence\":\"3\"}",
+     true},
+    {"grouped by type and sender",
+     "{\"account_number\":\"7\",\"chain_id\":\"cosmoshub-4\",\"fee\":{\"amount"
+     "\":[{\"amount\":\"5000\",\"denom\":\"uatom\"}],\"gas\":\"200000\"},\"mem"
+     "o\":\"hello\",\"msgs\":[{\"type\":\"cosmos-sdk/MsgSend\",\"value\":{\"am"
+     "ount\":[{\"amount\":\"1000\",\"denom\":\"uatom\"}],\"from_address\":\"co"
+     "smos1from\",\"to_address\":\"cosmos1to00\"}},{\"type\":\"cosmos-sdk/MsgS"
+     "end\",\"value\":{\"amount\":[{\"amount\":\"1001\",\"denom\":\"uatom\"}],"
+     "\"from_address\":\"cosmos1from\",\"to_address\":\"cosmos1to01\"}},{\"typ"
+     "e\":\"cosmos-sdk/MsgSend\",\"value\":{\"amount\":[{\"amount\":\"1002\","
+     "\"denom\":\"uatom\"}],\"from_address\":\"cosmos1from\",\"to_address\":\""
+     "cosmos1to02\"}}],\"sequence\":\"3\"}",
+     true},
+    {"mixed types",
+     "{\"account_number\":\"7\",\"chain_id\":\"cosmoshub-4\",\"fee\":{\"amount"
+     "\":[{\"amount\":\"5000\",\"denom\":\"uatom\"}],\"gas\":\"200000\"},\"mem"
+     "o\":\"hello\",\"msgs\":[{\"type\":\"cosmos-sdk/MsgDelegate\",\"value\":{"
+     "\"amount\":{\"amount\":\"5\",\"denom\":\"uatom\"},\"delegator_address\":"
+     "\"cosmos1from\",\"validator_address\":\"cosmosvaloper1abcdefghijklmnopqr"
+     "stuvwxyz00\"}},{\"type\":\"cosmos-sdk/MsgSend\",\"value\":{\"amount\":[{"
+     "\"amount\":\"1001\",\"denom\":\"uatom\"}],\"from_address\":\"cosmos1from"
+     "\",\"to_address\":\"cosmos1to01\"}},{\"type\":\"cosmos-sdk/MsgDelegate\""
+     ",\"value\":{\"amount\":{\"amount\":\"7\",\"denom\":\"uatom\"},\"delegato"
+     "r_address\":\"cosmos1from\",\"validator_address\":\"cosmosvaloper1abcdef"
+     "ghijklmnopqrstuvwxyz02\"}},{\"type\":\"cosmos-sdk/MsgSend\",\"value\":{"
+     "\"amount\":[{\"amount\":\"1003\",\"denom\":\"uatom\"}],\"from_address\":"
+     "\"cosmos1from\",\"to_address\":\"cosmos1to03\"}}],\"sequence\":\"3\"}",
+     true},
+    {"different senders",
+     "{\"account_number\":\"7\",\"chain_id\":\"osmosis-1\",\"fee\":{\"amount\""
+     ":[{\"amount\":\"5000\",\"denom\":\"uatom\"}],\"gas\":\"200000\"},\"memo"
+     "\":\"\",\"msgs\":[{\"type\":\"cosmos-sdk/MsgSend\",\"value\":{\"amount\""
+     ":[{\"amount\":\"1000\",\"denom\":\"uatom\"}],\"from_address\":\"cosmos1f"
+     "0\",\"to_address\":\"cosmos1to00\"}},{\"type\":\"cosmos-sdk/MsgSend\",\""
+     "value\":{\"amount\":[{\"amount\":\"1001\",\"denom\":\"uatom\"}],\"from_a"
+     "ddress\":\"cosmos1f1\",\"to_address\":\"cosmos1to01\"}},{\"type\":\"cosm"
+     "os-sdk/MsgSend\",\"value\":{\"amount\":[{\"amount\":\"1002\",\"denom\":"
+     "\"uatom\"}],\"from_address\":\"cosmos1f2\",\"to_address\":\"cosmos1to02"
+     "\"}},{\"type\":\"cosmos-sdk/MsgSend\",\"value\":{\"amount\":[{\"amount\""
+     ":\"1003\",\"denom\":\"uatom\"}],\"from_address\":\"cosmos1f3\",\"to_addr"
+     "ess\":\"cosmos1to03\"}}],\"sequence\":\"3\"}",
+     true},
+    {"multi-send",
+     "{\"account_number\":\"7\",\"chain_id\":\"cosmoshub-4\",\"fee\":{\"amount"
+     "\":[{\"amount\":\"5000\",\"denom\":\"uatom\"}],\"gas\":\"200000\"},\"mem"
+     "o\":\"hello\",\"msgs\":[{\"type\":\"cosmos-sdk/MsgMultiSend\",\"value\":"
+     "{\"inputs\":[{\"address\":\"cosmos1in\",\"coins\":[{\"amount\":\"10\",\""
+     "denom\":\"uatom\"}]}],\"outputs\":[{\"address\":\"cosmos1out1\",\"coins"
+     "\":[{\"amount\":\"4\",\"denom\":\"uatom\"}]},{\"address\":\"cosmos1out2"
+     "\",\"coins\":[{\"amount\":\"6\",\"denom\":\"uatom\"}]}]}}],\"sequence\":"
+     "\"3\"}",
+     true},
+    {"tip, other chain",
+     "{\"account_number\":\"7\",\"chain_id\":\"juno-1\",\"fee\":{\"amount\":[{"
+     "\"amount\":\"5000\",\"denom\":\"uatom\"}],\"gas\":\"200000\"},\"memo\":"
+     "\"hello\",\"msgs\":[{\"type\":\"cosmos-sdk/MsgDelegate\",\"value\":{\"am"
+     "ount\":{\"amount\":\"6\",\"denom\":\"uatom\"},\"delegator_address\":\"co"
+     "smos1from\",\"validator_address\":\"cosmosvaloper1abcdefghijklmnopqrstuv"
+     "wxyz01\"}},{\"type\":\"cosmos-sdk/MsgDelegate\",\"value\":{\"amount\":{"
+     "\"amount\":\"7\",\"denom\":\"uatom\"},\"delegator_address\":\"cosmos1fro"
+     "m\",\"validator_address\":\"cosmosvaloper1abcdefghijklmnopqrstuvwxyz02\""
+     "}}],\"sequence\":\"3\",\"tip\":{\"amount\":[{\"amount\":\"10\",\"denom\""
+     ":\"uatom\"}],\"tipper\":\"cosmos1tip\"}}",
+     true},
+    {"long memo",
+     "{\"account_number\":\"7\",\"chain_id\":\"cosmoshub-4\",\"fee\":{\"amount"
+     "\":[{\"amount\":\"5000\",\"denom\":\"uatom\"}],\"gas\":\"200000\"},\"mem"
+     "o\":\"xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx"
+     "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx"
+     "xxxxxxxxxxxx\",\"msgs\":[{\"type\":\"cosmos-sdk/MsgSend\",\"value\":{\"a"
+     "mount\":[{\"amount\":\"1000\",\"denom\":\"uatom\"}],\"from_address\":\"c"
+     "osmos1from\",\"to_address\":\"cosmos1to00\"}}],\"sequence\":\"3\"}",
+     true},
+    {"array value",
+     "{\"account_number\":\"7\",\"chain_id\":\"foo\",\"fee\":{\"amount\":[{\"a"
+     "mount\":\"5000\",\"denom\":\"uatom\"}],\"gas\":\"200000\"},\"memo\":\"he"
+     "llo\",\"msgs\":[{\"type\":\"custom/Msg\",\"value\":{\"list\":[\"0\",\"1"
+     "\",\"2\",\"3\",\"4\",\"5\",\"6\",\"7\",\"8\",\"9\",\"10\",\"11\",\"12\","
+     "\"13\",\"14\",\"15\",\"16\",\"17\",\"18\",\"19\",\"20\",\"21\",\"22\",\""
+     "23\",\"24\",\"25\",\"26\",\"27\",\"28\",\"29\"]}}],\"sequence\":\"3\"}",
+     true},
+    {"too many keys to record",
+     "{\"account_number\":\"7\",\"chain_id\":\"cosmoshub-4\",\"fee\":{\"amount"
+     "\":[{\"amount\":\"5000\",\"denom\":\"uatom\"}],\"gas\":\"200000\"},\"mem"
+     "o\":\"\",\"msgs\":[{\"type\":\"custom/Msg\",\"value\":{\"distinct_field_"
+     "name_number_00\":\"0\",\"distinct_field_name_number_01\":\"1\",\"distinc"
+     "t_field_name_number_02\":\"2\",\"distinct_field_name_number_03\":\"3\","
+     "\"distinct_field_name_number_04\":\"4\",\"distinct_field_name_number_05"
+     "\":\"5\",\"distinct_field_name_number_06\":\"6\",\"distinct_field_name_n"
+     "umber_07\":\"7\",\"distinct_field_name_number_08\":\"8\",\"distinct_fiel"
+     "d_name_number_09\":\"9\",\"distinct_field_name_number_10\":\"10\",\"dist"
+     "inct_field_name_number_11\":\"11\",\"distinct_field_name_number_12\":\"1"
+     "2\",\"distinct_field_name_number_13\":\"13\",\"distinct_field_name_numbe"
+     "r_14\":\"14\",\"distinct_field_name_number_15\":\"15\"}}],\"sequence\":"
+     "\"3\"}",
+     false},
+};
+
+typedef struct {
+  parser_error_t err;
+  char key[64];
+  char value[64];
+  uint8_t page_count;
+} Rendering;
+
+static parser_context_t ctx;
+
+static void render(uint8_t idx, uint16_t value_len, uint8_t page,
+                   Rendering *r) {
+  memset(r, 0, sizeof(*r));
+  r->err = cosmos_parser_getItem(&ctx, idx, r->key, sizeof(r->key), r->value,
+                                 value_len, page, &r->page_count);
+}
+
+// Drops the recorded items and keeps any from being recorded again, so that
+// every query walks the JSON tree.
+static void forget_items(void) {
+  display_cache.item_count = UINT8_MAX;
+  display_cache.item_keys_len = 0;
+  display_cache.items_complete = false;
+}
+
+// Records the items again, as the validation does.
+static void record_items(void) {
+  display_cache.item_count = 0;
+  display_cache.item_keys_len = 0;
+  display_cache.items_complete = false;
+  cosmos_parser_validate(&ctx);
+}
+
+static void check_doc(const SignDoc *doc) {
+  parser_error_t err =
+      cosmos_parser_parse(&ctx, (const uint8_t *)doc->json, strlen(doc->json));
+  if (err == parser_ok) {
+    err = cosmos_parser_validate(&ctx);
+  }
+  checks++;
+  if (err != parser_ok) {
+    printf("FAIL %s: parse error %d\n", doc->name, err);
+    failures++;
+    return;
+  }
+  checks++;
+  if (display_cache.items_complete != doc->recorded) {
+    printf("FAIL %s: items %srecorded\n", doc->name,
+           display_cache.items_complete ? "" : "not ");
+    failures++;
+  }
+
+  uint8_t num_items = 0;
+  cosmos_parser_getNumItems(&ctx, &num_items);
+  // the value lengths of the validation and of a paging screen, one item and
+  // one page past the end
+  static const uint16_t value_lens[] = {64, 20};
+  for (uint8_t idx = 0; idx <= num_items; idx++) {
+    for (size_t l = 0; l < sizeof(value_lens) / sizeof(value_lens[0]); l++) {
+      for (uint8_t page = 0;; page++) {
+        Rendering recorded = {0}, walked = {0};
+        render(idx, value_lens[l], page, &recorded);
+        forget_items();
+        render(idx, value_lens[l], page, &walked);
+        record_items();
+
+        checks++;
+        if (recorded.err != walked.err ||
+            strcmp(recorded.key, walked.key) != 0 ||
+            strcmp(recorded.value, walked.value) != 0 ||
+            recorded.page_count != walked.page_count) {
+          printf("FAIL %s: item %d page %d: [%s] [%s] %d/%d, expected "
+                 "[%s] [%s] %d/%d\n",
+                 doc->name, idx, page, recorded.key, recorded.value,
+                 recorded.page_count, recorded.err, walked.key, walked.value,
+                 walked.page_count, walked.err);
+          failures++;
+        }
+        if (walked.err != parser_ok || page >= walked.page_count) {
+          break;
+        }
+      }
+    }
+  }
+}
+
+int main(void) {
+  for (size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); i++) {
+    check_doc(&docs[i]);
+  }
+
+  printf("%d checks, %d failures\n", checks, failures);
+  return failures == 0 ? 0 : 1;
+}
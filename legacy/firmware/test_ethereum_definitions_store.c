@@ -0,0 +1,270 @@
+/*
+ * This file is part of the Trezor project, https://trezor.io/
+ *
+ * Copyright (C) 2022 Martin Novak <martin.novak@satoshilabs.com>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host test for the Ethereum definitions store. The store is included as a
+// source file, so that a reboot can be simulated by clearing its state, and
+// runs on a RAM sector that behaves like NOR flash: writes can only clear
+// bits. Built and run by `make test` in an emulator build.
+
+#include <stdio.h>
+
+#include "ethereum_definitions_store.c"
+#include "pb_encode.h"
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(cond)                                          \
+  do {                                                       \
+    checks++;                                                \
+    if (!(cond)) {                                           \
+      printf("FAIL %s:%d: %s\n", __func__, __LINE__, #cond); \
+      failures++;                                            \
+    }                                                        \
+  } while (0)
+
+static uint8_t sector[FLASH_ETH_DEFS_LEN];
+static int erases = 0;
+
+secbool flash_unlock_write(void) { return sectrue; }
+
+secbool flash_lock_write(void) { return sectrue; }
+
+uint32_t flash_sector_size(uint8_t s) {
+  return s == FLASH_ETH_DEFS_SECTOR ? sizeof(sector) : 0;
+}
+
+const void *flash_get_address(uint8_t s, uint32_t offset, uint32_t size) {
+  if (s != FLASH_ETH_DEFS_SECTOR || offset > sizeof(sector) ||
+      size > sizeof(sector) - offset) {
+    return NULL;
+  }
+  return sector + offset;
+}
+
+secbool flash_erase(uint8_t s) {
+  if (s != FLASH_ETH_DEFS_SECTOR) {
+    return secfalse;
+  }
+  memset(sector, 0xFF, sizeof(sector));
+  erases++;
+  return sectrue;
+}
+
+secbool flash_write_word(uint8_t s, uint32_t offset, uint32_t data) {
+  if (s != FLASH_ETH_DEFS_SECTOR || offset % 4 != 0 ||
+      offset + 4 > sizeof(sector)) {
+    return secfalse;
+  }
+  uint32_t word = 0;
+  memcpy(&word, sector + offset, 4);
+  word &= data;
+  memcpy(sector + offset, &word, 4);
+  return sectrue;
+}
+
+static uint8_t key_id[ETHEREUM_DEFINITIONS_KEY_ID_LEN] = "prodkeys";
+
+void ethereum_definitions_key_id(uint8_t id[ETHEREUM_DEFINITIONS_KEY_ID_LEN]) {
+  memcpy(id, key_id, ETHEREUM_DEFINITIONS_KEY_ID_LEN);
+}
+
+static void reboot(void) {
+  store_loaded = false;
+  store_usable = false;
+  store_end = 0;
+  store_data_version = 0;
+  store_count = 0;
+  memzero(store_index, sizeof(store_index));
+}
+
+typedef struct {
+  uint8_t bytes[STORE_MAX_PAYLOAD];
+  uint16_t length;
+} Payload;
+
+static void encode(const pb_msgdesc_t *fields, const void *definition,
+                   Payload *payload) {
+  pb_ostream_t stream =
+      pb_ostream_from_buffer(payload->bytes, sizeof(payload->bytes));
+  if (!pb_encode(&stream, fields, definition)) {
+    printf("FAIL encode: %s\n", PB_GET_ERROR(&stream));
+    failures++;
+  }
+  payload->length = stream.bytes_written;
+}
+
+static void put_network(uint32_t data_version, uint64_t chain_id,
+                        uint32_t slip44, Payload *payload) {
+  EthereumNetworkInfo network = {0};
+  network.chain_id = chain_id;
+  network.slip44 = slip44;
+  snprintf(network.symbol, sizeof(network.symbol), "N%u", (unsigned)slip44);
+  snprintf(network.name, sizeof(network.name), "Network %llu",
+           (unsigned long long)chain_id);
+  encode(EthereumNetworkInfo_fields, &network, payload);
+  ethereum_definitions_store_put(EthereumDefinitionType_NETWORK, data_version,
+                                 payload->bytes, payload->length, &network);
+}
+
+static void put_token(uint32_t data_version, uint64_t chain_id, uint32_t n,
+                      Payload *payload) {
+  EthereumTokenInfo token = {0};
+  token.chain_id = chain_id;
+  token.address.size = 20;
+  memcpy(token.address.bytes, &n, sizeof(n));
+  token.decimals = 18;
+  snprintf(token.symbol, sizeof(token.symbol), "T%u", (unsigned)n);
+  // a long name, so that the sector fills up in a few hundred records
+  memset(token.name, 'x', 200);
+  encode(EthereumTokenInfo_fields, &token, payload);
+  ethereum_definitions_store_put(EthereumDefinitionType_TOKEN, data_version,
+                                 payload->bytes, payload->length, &token);
+}
+
+static bool has_token(uint64_t chain_id, uint32_t n) {
+  uint8_t address[20] = {0};
+  memcpy(address, &n, sizeof(n));
+  EthereumTokenInfo token = {0};
+  return ethereum_definitions_store_get_token(chain_id, address, &token) &&
+         token.chain_id == chain_id && memcmp(token.address.bytes, address,
+                                              sizeof(address)) == 0;
+}
+
+static void test_insert_lookup(void) {
+  Payload network_payload = {0}, token_payload = {0};
+  put_network(MIN_DATA_VERSION, 1, 60, &network_payload);
+  put_token(MIN_DATA_VERSION, 1, 7, &token_payload);
+
+  for (int boot = 0; boot < 2; boot++) {
+    CHECK(ethereum_definitions_store_contains(
+        EthereumDefinitionType_NETWORK, MIN_DATA_VERSION,
+        network_payload.bytes, network_payload.length));
+    CHECK(ethereum_definitions_store_contains(
+        EthereumDefinitionType_TOKEN, MIN_DATA_VERSION, token_payload.bytes,
+        token_payload.length));
+    CHECK(!ethereum_definitions_store_contains(
+        EthereumDefinitionType_TOKEN, MIN_DATA_VERSION,
+        network_payload.bytes, network_payload.length));
+    CHECK(!ethereum_definitions_store_contains(
+        EthereumDefinitionType_NETWORK, MIN_DATA_VERSION + 1,
+        network_payload.bytes, network_payload.length));
+
+    EthereumNetworkInfo network = {0};
+    CHECK(ethereum_definitions_store_get_network(1, 0, &network) &&
+          network.slip44 == 60 && strcmp(network.symbol, "N60") == 0);
+    CHECK(ethereum_definitions_store_get_network(CHAIN_ID_UNKNOWN, 60,
+                                                 &network) &&
+          network.chain_id == 1);
+    CHECK(!ethereum_definitions_store_get_network(2, 0, &network));
+    CHECK(has_token(1, 7));
+    CHECK(!has_token(1, 8));
+    CHECK(!has_token(2, 7));
+
+    // everything survives a reboot
+    reboot();
+  }
+
+  // a newer signing of the definitions evicts the older ones
+  Payload newer = {0};
+  put_network(MIN_DATA_VERSION + 1, 5, 1, &newer);
+  EthereumNetworkInfo network = {0};
+  CHECK(ethereum_definitions_store_get_network(5, 0, &network));
+  CHECK(!ethereum_definitions_store_get_network(1, 0, &network));
+  CHECK(!has_token(1, 7));
+
+  ethereum_definitions_store_wipe();
+  CHECK(!ethereum_definitions_store_get_network(5, 0, &network));
+}
+
+static void test_rollover(void) {
+  reboot();
+  ethereum_definitions_store_wipe();
+  int erases_before = erases;
+
+  Payload payload = {0};
+  uint32_t n = 0;
+  while (erases == erases_before && n < 10000) {
+    put_token(MIN_DATA_VERSION, 1, n, &payload);
+    CHECK(has_token(1, n));
+    CHECK(store_count <= STORE_MAX_ENTRIES);
+    n++;
+  }
+  CHECK(erases == erases_before + 1);
+
+  // the sector started over with only the record that did not fit
+  CHECK(store_count == 1);
+  CHECK(has_token(1, n - 1));
+  CHECK(!has_token(1, n - 2));
+
+  // and the new log is appended to as before, also after a reboot
+  for (uint32_t i = 0; i < STORE_MAX_ENTRIES + 3; i++, n++) {
+    put_token(MIN_DATA_VERSION, 1, n, &payload);
+  }
+  reboot();
+  CHECK(ethereum_definitions_store_contains(EthereumDefinitionType_TOKEN,
+                                            MIN_DATA_VERSION, payload.bytes,
+                                            payload.length));
+  CHECK(store_count == STORE_MAX_ENTRIES);
+  CHECK(has_token(1, n - 1));
+  CHECK(has_token(1, n - STORE_MAX_ENTRIES));
+  CHECK(!has_token(1, n - STORE_MAX_ENTRIES - 1));
+}
+
+static void test_stale_store(void) {
+  reboot();
+  Payload payload = {0};
+  put_network(MIN_DATA_VERSION, 1, 60, &payload);
+
+  // a firmware trusting other keys must not trust what the store holds
+  memcpy(key_id, "devkeys!", sizeof(key_id));
+  reboot();
+  CHECK(!ethereum_definitions_store_contains(EthereumDefinitionType_NETWORK,
+                                             MIN_DATA_VERSION, payload.bytes,
+                                             payload.length));
+  EthereumNetworkInfo network = {0};
+  CHECK(!ethereum_definitions_store_get_network(1, 0, &network));
+
+  // the store was started over for the new keys
+  put_network(MIN_DATA_VERSION, 2, 61, &payload);
+  reboot();
+  CHECK(ethereum_definitions_store_get_network(2, 0, &network));
+
+  // and going back drops it again
+  memcpy(key_id, "prodkeys", sizeof(key_id));
+  reboot();
+  CHECK(!ethereum_definitions_store_get_network(2, 0, &network));
+
+  // a corrupted header is treated the same way
+  put_network(MIN_DATA_VERSION, 3, 62, &payload);
+  flash_write_word(FLASH_ETH_DEFS_SECTOR, 4, 0);
+  reboot();
+  CHECK(!ethereum_definitions_store_get_network(3, 0, &network));
+}
+
+int main(void) {
+  memset(sector, 0xFF, sizeof(sector));
+
+  test_insert_lookup();
+  test_rollover();
+  test_stale_store();
+
+  printf("%d checks, %d failures\n", checks, failures);
+  return failures == 0 ? 0 : 1;
+}
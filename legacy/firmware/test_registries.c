@@ -0,0 +1,262 @@
+/*
+ * This file is part of the Trezor project, https://trezor.io/
+ *
+ * Copyright (C) 2014 Pavol Rusnak <stick@satoshilabs.com>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host test for the registry lookups. Every key of every registry is looked up
+// both through the indexed lookup and through a plain linear scan over the
+// table, which is how the lookups used to be implemented, and the results must
+// be the same entry. Built and run by `make test` in an emulator build.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "coins.h"
+#if !BITCOIN_ONLY
+// included as a source file to reach the cosmos network indices
+#include "cosmos_networks.c"
+#include "neo_tokens.h"
+#include "nem2.h"
+#include "scdo_tokens.h"
+#include "ton_tokens.h"
+#include "tron_tokens.h"
+#endif
+
+static int failures = 0;
+static int checks = 0;
+
+static void check(const void *got, const void *expected, const char *what,
+                  const char *key) {
+  checks++;
+  if (got != expected) {
+    printf("FAIL %s(%s): got %p, expected %p\n", what, key, got, expected);
+    failures++;
+  }
+}
+
+static const CoinInfo *linearCoinByName(const char *name) {
+  for (int i = 0; i < COINS_COUNT; i++) {
+    if (strcmp(name, coins[i].coin_name) == 0) {
+      return &(coins[i]);
+    }
+  }
+  return 0;
+}
+
+static const CoinInfo *linearCoinByAddressType(uint32_t address_type) {
+  for (int i = 0; i < COINS_COUNT; i++) {
+    if (address_type == coins[i].address_type) {
+      return &(coins[i]);
+    }
+  }
+  return 0;
+}
+
+static const CoinInfo *linearCoinBySlip44(uint32_t coin_type) {
+  if (coin_type == SLIP44_TESTNET) {
+    return linearCoinByName("Testnet");
+  }
+  for (int i = 0; i < COINS_COUNT; i++) {
+    if (coin_type == coins[i].coin_type) {
+      return &(coins[i]);
+    }
+  }
+  return 0;
+}
+
+static void test_coins(void) {
+  char key[32] = {0};
+  for (int i = 0; i < COINS_COUNT; i++) {
+    const CoinInfo *coin = &coins[i];
+    check(coinByName(coin->coin_name), linearCoinByName(coin->coin_name),
+          "coinByName", coin->coin_name);
+    snprintf(key, sizeof(key), "%s!", coin->coin_name);
+    check(coinByName(key), 0, "coinByName", key);
+
+    snprintf(key, sizeof(key), "%u", (unsigned)coin->address_type);
+    check(coinByAddressType(coin->address_type),
+          linearCoinByAddressType(coin->address_type), "coinByAddressType",
+          key);
+    check(coinByAddressType(coin->address_type + 1),
+          linearCoinByAddressType(coin->address_type + 1),
+          "coinByAddressType", key);
+
+    snprintf(key, sizeof(key), "%u", (unsigned)coin->coin_type);
+    check(coinBySlip44(coin->coin_type), linearCoinBySlip44(coin->coin_type),
+          "coinBySlip44", key);
+    check(coinBySlip44(coin->coin_type + 1),
+          linearCoinBySlip44(coin->coin_type + 1), "coinBySlip44", key);
+  }
+  check(coinByName(""), 0, "coinByName", "");
+  check(coinByName(NULL), 0, "coinByName", "NULL");
+  check(coinBySlip44(0), linearCoinBySlip44(0), "coinBySlip44", "0");
+  check(coinBySlip44(0xffffffff), 0, "coinBySlip44", "0xffffffff");
+}
+
+#if !BITCOIN_ONLY
+
+// The old lookups used memcmp, which may read past the end of a shorter key.
+// strncmp stops at the terminator and matches the same entries.
+static const CosmosNetworkType *linearCosmosByChainId(const char *chain_id) {
+  for (int i = 0; i < COSMOS_NETWORK_COUNT; i++) {
+    if (strncmp(chain_id, cosmos_networks[i].chain_id, strlen(chain_id)) ==
+        0) {
+      return &(cosmos_networks[i]);
+    }
+  }
+  return NULL;
+}
+
+static const CosmosNetworkType *linearCosmosByHrp(const char *hrp) {
+  for (int i = 0; i < COSMOS_NETWORK_COUNT; i++) {
+    if (strncmp(hrp, cosmos_networks[i].hrp, strlen(hrp)) == 0) {
+      return &(cosmos_networks[i]);
+    }
+  }
+  return NULL;
+}
+
+// The indices are kept by hand, so check that each one lists every network
+// once, sorted by its key.
+static void check_cosmos_index(const uint8_t *index,
+                               const char *(*key)(uint8_t), const char *what) {
+  bool seen[COSMOS_NETWORK_COUNT] = {0};
+  for (int i = 0; i < COSMOS_NETWORK_COUNT; i++) {
+    checks++;
+    if (index[i] >= COSMOS_NETWORK_COUNT || seen[index[i]]) {
+      printf("FAIL %s[%d]: network %d missing or listed twice\n", what, i,
+             index[i]);
+      failures++;
+      continue;
+    }
+    seen[index[i]] = true;
+    checks++;
+    if (i > 0 && index[i - 1] < COSMOS_NETWORK_COUNT &&
+        strcmp(key(index[i - 1]), key(index[i])) > 0) {
+      printf("FAIL %s[%d]: %s sorted after %s\n", what, i, key(index[i]),
+             key(index[i - 1]));
+      failures++;
+    }
+  }
+}
+
+static void test_cosmos(void) {
+  check_cosmos_index(cosmos_networks_by_chain_id, cosmosnetworkChainId,
+                     "cosmos_networks_by_chain_id");
+  check_cosmos_index(cosmos_networks_by_hrp, cosmosnetworkHrp,
+                     "cosmos_networks_by_hrp");
+
+  char key[64] = {0};
+  for (int i = 0; i < COSMOS_NETWORK_COUNT; i++) {
+    const char *chain_id = cosmos_networks[i].chain_id;
+    const char *hrp = cosmos_networks[i].hrp;
+    // Every prefix of every key, since the lookups match by prefix.
+    for (size_t len = 0; len <= strlen(chain_id); len++) {
+      snprintf(key, sizeof(key), "%.*s", (int)len, chain_id);
+      check(cosmosnetworkByChainId(key), linearCosmosByChainId(key),
+            "cosmosnetworkByChainId", key);
+    }
+    for (size_t len = 0; len <= strlen(hrp); len++) {
+      snprintf(key, sizeof(key), "%.*s", (int)len, hrp);
+      check(cosmosnetworkByHrp(key), linearCosmosByHrp(key),
+            "cosmosnetworkByHrp", key);
+    }
+    snprintf(key, sizeof(key), "%s~", chain_id);
+    check(cosmosnetworkByChainId(key), NULL, "cosmosnetworkByChainId", key);
+    snprintf(key, sizeof(key), "%s~", hrp);
+    check(cosmosnetworkByHrp(key), NULL, "cosmosnetworkByHrp", key);
+  }
+}
+
+static const NEMMosaicDefinition *linearMosaicByName(const char *namespace,
+                                                     const char *mosaic,
+                                                     uint8_t network) {
+  for (size_t i = 0; i < NEM_MOSAIC_DEFINITIONS_COUNT; i++) {
+    const NEMMosaicDefinition *definition = &NEM_MOSAIC_DEFINITIONS[i];
+    if (nem_mosaicMatches(definition, namespace, mosaic, network)) {
+      return definition;
+    }
+  }
+  return NULL;
+}
+
+static void test_nem(void) {
+  static const uint8_t networks[] = {NEM_NETWORK_MAINNET, NEM_NETWORK_TESTNET,
+                                     NEM_NETWORK_MIJIN};
+  for (size_t i = 0; i < NEM_MOSAIC_DEFINITIONS_COUNT; i++) {
+    const NEMMosaicDefinition *definition = &NEM_MOSAIC_DEFINITIONS[i];
+    for (size_t j = 0; j < sizeof(networks); j++) {
+      check(nem_mosaicByName(definition->namespace, definition->mosaic,
+                             networks[j]),
+            linearMosaicByName(definition->namespace, definition->mosaic,
+                               networks[j]),
+            "nem_mosaicByName", definition->mosaic);
+    }
+    check(nem_mosaicByName(definition->namespace, "", NEM_NETWORK_MAINNET),
+          NULL, "nem_mosaicByName", definition->namespace);
+  }
+}
+
+static void test_tokens(void) {
+  char address[64] = {0};
+  for (int i = 0; i < TRON_TOKENS_COUNT; i++) {
+    memcpy(address, tron_tokens[i].address, sizeof(tron_tokens[i].address));
+    check(get_tron_token_by_address(address), &tron_tokens[i],
+          "get_tron_token_by_address", address);
+    address[34] ^= 1;
+    check(get_tron_token_by_address(address), &tron_tokens[TRON_TOKENS_COUNT],
+          "get_tron_token_by_address", address);
+  }
+  for (int i = 0; i < TON_TOKENS_COUNT; i++) {
+    memcpy(address, ton_tokens[i].address, sizeof(ton_tokens[i].address));
+    check(ton_get_token_by_address(address), &ton_tokens[i],
+          "ton_get_token_by_address", address);
+    address[47] ^= 1;
+    check(ton_get_token_by_address(address), &ton_tokens[TON_TOKENS_COUNT],
+          "ton_get_token_by_address", address);
+  }
+  for (int i = 0; i < TOKENS_COUNT; i++) {
+    snprintf(address, sizeof(address), "%s", scdo_tokens[i].address);
+    check(getTokenByAddress(address), &scdo_tokens[i], "getTokenByAddress",
+          address);
+    address[19] ^= 1;
+    check(getTokenByAddress(address), ScdoUnknownToken, "getTokenByAddress",
+          address);
+  }
+  for (int i = 0; i < NEO_TOKENS_COUNT; i++) {
+    uint8_t hash[20] = {0};
+    memcpy(hash, neo_tokens[i].contract_script_hash, sizeof(hash));
+    check(neo_token_by_contract_script_hash(hash), &neo_tokens[i],
+          "neo_token_by_contract_script_hash", neo_tokens[i].symbol);
+    hash[19] ^= 1;
+    check(neo_token_by_contract_script_hash(hash), &UNK_TOKEN,
+          "neo_token_by_contract_script_hash", neo_tokens[i].symbol);
+  }
+}
+
+#endif
+
+int main(void) {
+  test_coins();
+#if !BITCOIN_ONLY
+  test_cosmos();
+  test_nem();
+  test_tokens();
+#endif
+  printf("%d checks, %d failures\n", checks, failures);
+  return failures ? 1 : 0;
+}
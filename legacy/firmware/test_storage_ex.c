@@ -0,0 +1,289 @@
+/*
+ * This file is part of the Trezor project, https://trezor.io/
+ *
+ * Copyright (C) 2014 Pavol Rusnak <stick@satoshilabs.com>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host test for the UTXO cache and the white list. Random operations, with
+// reboots and interrupted white list writes in between, are run against the
+// store and against a plain model of it, and the results must be the same.
+// The store is included as a source file, so that a reboot can be simulated
+// by clearing its state, and runs on a RAM sector that behaves like NOR
+// flash: writes can only clear bits. Built and run by `make test` in an
+// emulator build.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// storage_ex.h replaces the store with stubs in emulator builds, and this
+// test runs the device code.
+#undef EMULATOR
+#define EMULATOR 0
+#include "storage_ex.c"
+
+static int failures = 0;
+static int checks = 0;
+
+#define CHECK(cond)                                                  \
+  do {                                                               \
+    checks++;                                                        \
+    if (!(cond)) {                                                   \
+      printf("FAIL %s:%d: %s (op %d)\n", __func__, __LINE__, #cond, \
+             op);                                                    \
+      failures++;                                                    \
+    }                                                                \
+  } while (0)
+
+static int op = 0;
+
+#define SECTOR_SIZE (FLASH_UTXO_CACHE_SIZE + FLASH_WHITE_LIST_SIZE)
+
+static uint8_t sector[SECTOR_SIZE];
+static int erases = 0;
+
+void __attribute__((noreturn))
+__fatal_error(const char *expr, const char *msg, const char *file, int line,
+              const char *func) {
+  printf("FATAL %s: %s at %s:%d %s (op %d)\n", expr, msg ? msg : "", file,
+         line, func, op);
+  exit(1);
+}
+
+secbool flash_unlock_write(void) { return sectrue; }
+
+secbool flash_lock_write(void) { return sectrue; }
+
+const void *flash_get_address(uint8_t s, uint32_t offset, uint32_t size) {
+  if (s != FLASH_USER_DATA_SECTOR || offset > sizeof(sector) ||
+      size > sizeof(sector) - offset) {
+    return NULL;
+  }
+  return sector + offset;
+}
+
+secbool flash_erase(uint8_t s) {
+  if (s != FLASH_USER_DATA_SECTOR) {
+    return secfalse;
+  }
+  memset(sector, 0xFF, sizeof(sector));
+  erases++;
+  return sectrue;
+}
+
+secbool flash_write_byte(uint8_t s, uint32_t offset, uint8_t data) {
+  if (s != FLASH_USER_DATA_SECTOR || offset >= sizeof(sector)) {
+    return secfalse;
+  }
+  sector[offset] &= data;
+  return sectrue;
+}
+
+secbool flash_write_word(uint8_t s, uint32_t offset, uint32_t data) {
+  if (s != FLASH_USER_DATA_SECTOR || offset % 4 != 0 ||
+      offset + 4 > sizeof(sector)) {
+    return secfalse;
+  }
+  uint32_t word = 0;
+  memcpy(&word, sector + offset, 4);
+  word &= data;
+  memcpy(sector + offset, &word, 4);
+  return sectrue;
+}
+
+static void reboot(void) {
+  uxto_cache_count = 0;
+  uxto_cache_start = 0;
+  memset(utxo_index, 0, sizeof(utxo_index));
+  utxo_index_used = 0;
+  memset(wl_slots, 0, sizeof(wl_slots));
+  wl_count = 0;
+  wl_end = 0;
+  user_data_indexed = false;
+  user_data_init();
+}
+
+// The model keeps the last UTXO_INFO_USEFUL_COUNT new outputs in order, and
+// the live white list entries in slot order.
+typedef struct {
+  uint8_t tx;
+  uint32_t index;
+  uint64_t amount;
+} ModelUtxo;
+
+static ModelUtxo model_utxos[UTXO_INFO_USEFUL_COUNT];
+static uint32_t model_utxo_count = 0;
+
+static char model_wl[WL_USEFUL_COUNT][ADDR_MAX_SIZE];
+static uint32_t model_wl_count = 0;
+
+static bool model_utxo_check(uint8_t tx, uint32_t index, uint64_t amount) {
+  for (uint32_t i = 0; i < model_utxo_count; i++) {
+    if (model_utxos[i].tx == tx && model_utxos[i].index == index) {
+      return model_utxos[i].amount == amount;
+    }
+  }
+  if (model_utxo_count == UTXO_INFO_USEFUL_COUNT) {
+    memmove(&model_utxos[0], &model_utxos[1],
+            (UTXO_INFO_USEFUL_COUNT - 1) * sizeof(model_utxos[0]));
+    model_utxo_count--;
+  }
+  model_utxos[model_utxo_count++] = (ModelUtxo){tx, index, amount};
+  return true;
+}
+
+static int model_wl_find(const char *addr) {
+  for (uint32_t i = 0; i < model_wl_count; i++) {
+    if (strcmp(model_wl[i], addr) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static int model_wl_add(const char *addr) {
+  if (model_wl_find(addr) >= 0) {
+    return WHILT_LIST_ADDR_EXIST;
+  }
+  if (model_wl_count == WL_USEFUL_COUNT) {
+    return WHILT_LIST_FULL;
+  }
+  strcpy(model_wl[model_wl_count++], addr);
+  return WHITE_LIST_OK;
+}
+
+static void model_wl_delete(const char *addr) {
+  int i = model_wl_find(addr);
+  if (i >= 0) {
+    model_wl_count--;
+    memmove(&model_wl[i], &model_wl[i + 1],
+            (model_wl_count - i) * sizeof(model_wl[0]));
+  }
+}
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(uint32_t n) {
+  rng_state = rng_state * 1103515245 + 12345;
+  return (rng_state >> 8) % n;
+}
+
+// Addresses of the same length, since the store matches them by prefix.
+static void make_address(uint32_t n, char addr[ADDR_MAX_SIZE]) {
+  snprintf(addr, ADDR_MAX_SIZE, "bc1qaddress%04u", (unsigned)n);
+}
+
+static void check_utxo(void) {
+  uint8_t tx = rng(16);
+  uint32_t index = rng(64);
+  uint64_t amount = ((uint64_t)tx << 40) + index * 1000 + (rng(20) == 0);
+  uint8_t prv_id[32] = {0};
+  memset(prv_id, tx, sizeof(prv_id));
+  CHECK(utxo_cache_check(prv_id, index, amount) ==
+        model_utxo_check(tx, index, amount));
+}
+
+static void check_white_list(void) {
+  char addr[ADDR_MAX_SIZE] = {0};
+  make_address(rng(16), addr);
+  switch (rng(4)) {
+    case 0:
+    case 1:
+      CHECK(white_list_add(addr) == model_wl_add(addr));
+      break;
+    case 2:
+      white_list_delete(addr);
+      model_wl_delete(addr);
+      break;
+    default:
+      CHECK(white_list_check(addr) == (model_wl_find(addr) >= 0));
+      break;
+  }
+
+  CHECK(white_list_get_count() == model_wl_count);
+  char list[WL_USEFUL_COUNT][130];
+  memset(list, 0, sizeof(list));
+  uint16_t count = 0;
+  white_list_inquiry(list, &count);
+  CHECK(count == model_wl_count);
+  for (uint32_t i = 0; i < count && i < model_wl_count; i++) {
+    CHECK(strcmp(list[i], model_wl[i]) == 0);
+  }
+}
+
+// Leaves the next white list slot as an add that was interrupted before it
+// wrote the state word.
+static void interrupt_white_list_add(void) {
+  if (wl_end >= WL_MAX_COUNTS) {
+    return;
+  }
+  addr_info partial = {0};
+  memset(partial.rfu, 0xff, sizeof(partial.rfu));
+  make_address(9999, partial.address);
+  const uint32_t offset =
+      FLASH_WHITE_LIST_OFFSET + WL_HEADER + wl_end * sizeof(addr_info);
+  write_words(offset + 4, (const uint8_t *)&partial + 4, sizeof(partial) - 4);
+}
+
+static void test_random(void) {
+  for (op = 0; op < 40000; op++) {
+    const uint32_t r = rng(1000);
+    if (r < 700) {
+      check_utxo();
+    } else if (r < 990) {
+      check_white_list();
+    } else if (r < 995) {
+      reboot();
+    } else {
+      interrupt_white_list_add();
+      reboot();
+    }
+  }
+  // both areas were compacted several times
+  CHECK(erases > 4);
+}
+
+// An interrupted add in the last white list slot must not lose the next add.
+static void test_interrupted_last_slot(void) {
+  char addr[ADDR_MAX_SIZE] = {0};
+  while (model_wl_count > 0) {
+    white_list_delete(model_wl[0]);
+    model_wl_delete(model_wl[0]);
+  }
+  for (uint32_t n = 0; wl_end < WL_MAX_COUNTS - 1; n++) {
+    make_address(n % 16, addr);
+    CHECK(white_list_add(addr) == WHITE_LIST_OK);
+    white_list_delete(addr);
+  }
+  interrupt_white_list_add();
+  reboot();
+  make_address(3, addr);
+  CHECK(white_list_add(addr) == WHITE_LIST_OK);
+  CHECK(white_list_check(addr));
+  CHECK(white_list_get_count() == 1);
+  reboot();
+  CHECK(white_list_check(addr));
+}
+
+int main(void) {
+  memset(sector, 0xFF, sizeof(sector));
+  reboot();
+
+  test_random();
+  test_interrupted_last_slot();
+
+  printf("%d checks, %d failures\n", checks, failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+/*
+ * This file is part of the Trezor project, https://trezor.io/
+ *
+ * Copyright (C) 2014 Pavol Rusnak <stick@satoshilabs.com>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host test for ton_parse_boc. Valid bags of cells must give the root cell
+// hash, and malformed ones, including every truncation of a valid one, must be
+// rejected. A message with an inlined body must keep all references of the
+// body's root. Built and run by `make test` in an emulator build.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fsm.h"
+#include "ton_cell.h"
+
+static int failures = 0;
+static int checks = 0;
+
+// ton_cell.c reports some errors to the host itself
+#if DEBUG_LINK
+void fsm_sendFailureDebug(FailureType code, const char *text,
+                          const char *source) {
+  (void)code;
+  (void)text;
+  (void)source;
+}
+#else
+void fsm_sendFailure(FailureType code, const char *text) {
+  (void)code;
+  (void)text;
+}
+#endif
+
+typedef struct {
+  const char *name;
+  const char *boc;
+  const char *root_hash;  // NULL if the bag of cells must be rejected
+  uint16_t root_depth;
+} BocVector;
+
+// 0xdeadbeef with references to 0xab and 0xcd, without CRC
+#define TWO_REFS_BOC "b5ee9c7201010301000e000208deadbeef01020002ab0002cd"
+
+static const BocVector vectors[] = {
+    // empty cell, with CRC
+    {"empty", "b5ee9c724101010100020000004cacb9cd",
+     "96a296d224f285c67bee93c30f8a309157f0daa35dc5b87e410b78630a09cfc7", 0},
+    // 0xdeadbeef with a reference to 0xab, with CRC
+    {"ref", "b5ee9c7241010201000a000108deadbeef010002abf5b0f1bf",
+     "3c204271e3faf3436ddd55f455d258d147f6d18d05f6b04daa99b7b4cdc640c9", 1},
+    {"two refs", TWO_REFS_BOC,
+     "9876c3f9edfbed69734ea73d31e7fc0eea1e0a77c71b1903c51795786014609e", 1},
+    // the same cells as "ref" with an index and without CRC
+    {"index", "b5ee9c7281010201000a00070a0108deadbeef010002ab",
+     "3c204271e3faf3436ddd55f455d258d147f6d18d05f6b04daa99b7b4cdc640c9", 1},
+    // last CRC byte changed
+    {"bad crc", "b5ee9c7241010201000a000108deadbeef010002abf5b0f1be", NULL,
+     0},
+    // cell data changed, CRC kept
+    {"bad data", "b5ee9c7241010201000a000108deadbeee010002abf5b0f1bf", NULL,
+     0},
+    // index end of the first cell off by one
+    {"bad index", "b5ee9c7281010201000a00080a0108deadbeef010002ab", NULL, 0},
+    // size fields of 0 and 5 bytes
+    {"ref size 0", "b5ee9c7280010201000a0108deadbeef010002ab", NULL, 0},
+    {"ref size 5", "b5ee9c7285010000000002000000000100000000000a00000000000108"
+                   "deadbeef00000000010002ab",
+     NULL, 0},
+    // reference to the cell itself
+    {"self ref", "b5ee9c7201010201000a000108deadbeef000002ab", NULL, 0},
+    // two root cells
+    {"two roots", "b5ee9c7201010202000a00000108deadbeef010002ab", NULL, 0},
+    // total cells size larger than the cells
+    {"bad size", "b5ee9c7201010201000b000108deadbeef010002ab", NULL, 0},
+    // CRC of the first 5 bytes in the last 4 of 9, which overlap the header
+    {"crc in header", "b5ee9c724301cf11ec", NULL, 0},
+    // wrong magic
+    {"bad magic", "b5ee9c7301010201000a000108deadbeef010002ab", NULL, 0},
+};
+
+static size_t unhex(const char *hex, uint8_t *out) {
+  size_t len = strlen(hex) / 2;
+  for (size_t i = 0; i < len; i++) {
+    unsigned int byte = 0;
+    sscanf(hex + 2 * i, "%2x", &byte);
+    out[i] = byte;
+  }
+  return len;
+}
+
+// Parses a copy of exactly len bytes, so that reading past the end shows up
+// under a sanitizer.
+static bool parse(const uint8_t *boc, size_t len, CellRef_t *root) {
+  uint8_t *copy = malloc(len ? len : 1);
+  memcpy(copy, boc, len);
+  bool ok = ton_parse_boc(copy, len, root, NULL, NULL);
+  free(copy);
+  return ok;
+}
+
+static void check_vector(const BocVector *v) {
+  uint8_t boc[TON_BOC_MAX_SIZE] = {0};
+  size_t len = unhex(v->boc, boc);
+
+  CellRef_t root = {0};
+  bool ok = parse(boc, len, &root);
+  checks++;
+  if (ok != (v->root_hash != NULL)) {
+    printf("FAIL %s: %s\n", v->name, ok ? "accepted" : "rejected");
+    failures++;
+    return;
+  }
+  if (!ok) {
+    return;
+  }
+
+  uint8_t hash[HASH_LEN] = {0};
+  unhex(v->root_hash, hash);
+  checks++;
+  if (memcmp(root.hash, hash, HASH_LEN) != 0 ||
+      root.max_depth != v->root_depth) {
+    printf("FAIL %s: wrong root hash or depth\n", v->name);
+    failures++;
+  }
+
+  // no prefix of a valid bag of cells is one, which covers lengths where the
+  // CRC would overlap the header
+  for (size_t i = 0; i < len; i++) {
+    checks++;
+    if (parse(boc, i, &root)) {
+      printf("FAIL %s: accepted when truncated to %zu bytes\n", v->name, i);
+      failures++;
+    }
+  }
+}
+
+// The body of "two refs" inlined in an internal message of 1 TON, with
+// bounce, to 0:1111...11.
+static void check_inline_refs(void) {
+  static const char* ab_hash =
+      "57c2a1a13baa2762109ed68be0c396f2303ce17e3dde7917d0e74b4072b1dbc7";
+  static const char* cd_hash =
+      "55d3a36fab16e3608adfd243927a59037d0d48f37dd6dd81fc47c941ac6a1e01";
+  static const char* message_hash =
+      "70dba78935ed76acc4a2be053f444f252f07d274f34e748178b453f63476685f";
+
+  uint8_t boc[TON_BOC_MAX_SIZE] = {0};
+  size_t len = unhex(TWO_REFS_BOC, boc);
+  CellRef_t payload = {0};
+  BitString_t payload_bits;
+  bitstring_init(&payload_bits);
+  CellRefs_t payload_refs = {0};
+  checks++;
+  if (!ton_parse_boc(boc, len, &payload, &payload_bits, &payload_refs)) {
+    printf("FAIL inline refs: rejected\n");
+    failures++;
+    return;
+  }
+
+  uint8_t ab[HASH_LEN] = {0}, cd[HASH_LEN] = {0};
+  unhex(ab_hash, ab);
+  unhex(cd_hash, cd);
+  checks++;
+  if (payload_refs.refs_count != 2 ||
+      memcmp(payload_refs.refs[0].hash, ab, HASH_LEN) != 0 ||
+      memcmp(payload_refs.refs[1].hash, cd, HASH_LEN) != 0) {
+    printf("FAIL inline refs: wrong references of the root\n");
+    failures++;
+  }
+
+  uint8_t dest[HASH_LEN];
+  memset(dest, 0x11, sizeof(dest));
+  CellRef_t message = {0};
+  uint8_t expected[HASH_LEN] = {0};
+  unhex(message_hash, expected);
+  checks++;
+  if (!build_message_ref(true, 0, dest, 1000000000, &payload, false, NULL,
+                         &payload_bits, &payload_refs, &message) ||
+      memcmp(message.hash, expected, HASH_LEN) != 0) {
+    printf("FAIL inline refs: wrong message hash\n");
+    failures++;
+  }
+}
+
+int main(void) {
+  for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+    check_vector(&vectors[i]);
+  }
+  check_inline_refs();
+
+  printf("%d checks, %d failures\n", checks, failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -155,10 +155,10 @@ bool ton_sign_message(const TonSignMessage *msg, const HDNode *node,
   bitstring_init(&payload_bits_data);
   BitString_t *payload_bits = &payload_bits_data;
 
-  CellRef_t payload_ref_data;
-  CellRef_t *payload_ref = &payload_ref_data;
+  CellRefs_t payload_refs_data = {0};
+  CellRefs_t *payload_refs = &payload_refs_data;
 
-  unsigned char raw_data[1024];
+  static unsigned char raw_data[TON_BOC_MAX_SIZE];
   bool is_raw_data = false;
   size_t data_len = 0;
 
@@ -253,7 +253,7 @@ bool ton_sign_message(const TonSignMessage *msg, const HDNode *node,
     // create payload
     if (is_raw_data) {
       if (!ton_parse_boc(raw_data, data_len, payload, payload_bits,
-                         payload_ref)) {
+                         payload_refs)) {
         fsm_sendFailure(FailureType_Failure_ProcessError,
                         "Failed to create raw data body");
         return false;
@@ -385,7 +385,7 @@ bool ton_sign_message(const TonSignMessage *msg, const HDNode *node,
       msg->expire_at, msg->seqno, parsed_dest.is_bounceable,
       parsed_dest.workchain, parsed_dest.hash, msg->ton_amount, msg->mode,
       !comment_inline ? payload : NULL, is_jetton,
-      comment_inline ? msg->comment : NULL, payload_bits, payload_ref,
+      comment_inline ? msg->comment : NULL, payload_bits, payload_refs,
       ext_destination_ptrs, msg->ext_ton_amount, ext_payload_ptrs,
       ext_dest_count, digest);
 
@@ -1,6 +1,8 @@
 #include <stdbool.h>
 
+#include "bignum.h"
 #include "fsm.h"
+#include "memzero.h"
 #include "messages-ton.pb.h"
 #include "messages.h"
 #include "messages.pb.h"
@@ -107,7 +109,7 @@ bool ton_create_jetton_transfer_body(uint8_t dest_workchain, uint8_t* dest_hash,
 bool build_message_ref(bool is_bounceable, uint8_t dest_workchain,
                        uint8_t* dest_hash, uint64_t value, CellRef_t* payload,
                        bool is_jetton, const char* payload_str,
-                       BitString_t* payload_bits, CellRef_t* payload_ref,
+                       BitString_t* payload_bits, CellRefs_t* payload_refs,
                        CellRef_t* out_message_ref) {
   BitString_t bits;
   bitstring_init(&bits);
@@ -136,9 +138,9 @@ bool build_message_ref(bool is_bounceable, uint8_t dest_workchain,
     return ton_hash_cell(&bits, NULL, 0, out_message_ref);
 
   } else if (payload != NULL) {
-    // check if raw data inline
-    // if (false) {
-    if (bits.data_cursor + payload_bits->data_cursor <= 1023 && !is_jetton) {
+    // check if raw data inline, only a parsed body can be inlined
+    if (payload_bits != NULL && payload_refs != NULL && !is_jetton &&
+        bits.data_cursor + payload_bits->data_cursor <= 1023) {
       bitstring_write_bit(&bits, 0);  // no state-init
       bitstring_write_bit(&bits, 0);  // body in line
 
@@ -149,14 +151,9 @@ bool build_message_ref(bool is_bounceable, uint8_t dest_workchain,
         bitstring_write_bit(&bits, src_value);
       }
 
-      // append payload ref in message ref
-      if (payload->max_depth > 0) {
-        struct CellRef_t refs[1] = {*payload_ref};
-        return ton_hash_cell(&bits, refs, 1, out_message_ref);
-
-      } else {
-        return ton_hash_cell(&bits, NULL, 0, out_message_ref);
-      }
+      // the message cell takes over all references of the inlined body
+      return ton_hash_cell(&bits, payload_refs->refs, payload_refs->refs_count,
+                           out_message_ref);
 
     } else {
       bitstring_write_bit(&bits, 0);  // no state-init
@@ -177,14 +174,14 @@ bool ton_create_message_digest(
     uint32_t expire_at, uint32_t seqno, bool is_bounceable,
     uint8_t dest_workchain, uint8_t* dest_hash, uint64_t value, uint8_t mode,
     CellRef_t* payload, bool is_jetton, const char* payload_str,
-    BitString_t* payload_bits, CellRef_t* payload_ref, const char** ext_dest,
+    BitString_t* payload_bits, CellRefs_t* payload_refs, const char** ext_dest,
     const uint64_t* ext_ton_amount, const char** ext_payload,
     uint8_t ext_dest_count, uint8_t* digest) {
   // Build Internal Message
   struct CellRef_t internalMessageRef;
   if (!build_message_ref(is_bounceable, dest_workchain, dest_hash, value,
                          payload, is_jetton, payload_str, payload_bits,
-                         payload_ref, &internalMessageRef)) {
+                         payload_refs, &internalMessageRef)) {
     return false;
   }
 
@@ -293,137 +290,220 @@ void set_top_upped_array(uint8_t* array, size_t array_len,
   fsm_sendFailure(FailureType_Failure_ProcessError, "Invalid top-upped array");
 }
 
-bool ton_parse_boc(const uint8_t* input_boc, size_t input_boc_len,
-                   CellRef_t* payload, BitString_t* payload_bits,
-                   CellRef_t* payload_ref) {
-  if (input_boc_len < 5 || input_boc_len > 1024) {
+typedef struct {
+  const uint8_t* data;
+  size_t len;
+  size_t pos;
+} BocReader;
+
+typedef struct {
+  const uint8_t* data;  // completion tag included
+  uint8_t d2;
+  uint8_t refs_count;
+  uint32_t refs[4];
+} BocCell;
+
+static bool boc_read_uint(BocReader* r, uint8_t bytes, uint32_t* out) {
+  if (bytes > 4 || r->len - r->pos < bytes) {
     return false;
   }
+  *out = 0;
+  for (int i = 0; i < bytes; i++) {
+    *out = (*out << 8) | r->data[r->pos++];
+  }
+  return true;
+}
 
-  // Compare BOC with magic prefix
-  if (memcmp(input_boc, REACH_BOC_MAGIC_PREFIX, 4) != 0) {
-    return false;  // Does not match
+static bool boc_skip(BocReader* r, size_t bytes) {
+  if (r->len - r->pos < bytes) {
+    return false;
+  }
+  r->pos += bytes;
+  return true;
+}
+
+// Reads an ordinary level 0 cell. References must point to later cells, so
+// that hashing the cells from the last one up never meets an unhashed child.
+static bool boc_read_cell(BocReader* r, uint8_t ref_size, uint32_t index,
+                          uint32_t cells_num, BocCell* cell) {
+  if (r->len - r->pos < 2) {
+    return false;
+  }
+  uint8_t d1 = r->data[r->pos++];
+  cell->d2 = r->data[r->pos++];
+  cell->refs_count = d1 & 0x07;
+  bool is_exotic = d1 & 0x08;
+  bool with_hashes = d1 & 0x10;
+  uint8_t level = d1 >> 5;
+  if (cell->refs_count > 4 || is_exotic || level != 0) {
+    return false;
+  }
+  // Stored hash and depth, recomputed below anyway
+  if (with_hashes && !boc_skip(r, HASH_LEN + 2)) {
+    return false;
   }
 
-  // Record BOC data
-  uint8_t boc[input_boc_len];
-  memcpy(boc, input_boc, input_boc_len);
+  size_t data_len = (cell->d2 + 1) / 2;
+  cell->data = &r->data[r->pos];
+  if (!boc_skip(r, data_len)) {
+    return false;
+  }
+  if ((cell->d2 & 1) && cell->data[data_len - 1] == 0) {
+    return false;  // missing completion tag
+  }
 
-  size_t index = 0;
-  index += 4;  // Remove the first four bytes of the BOC prefix
+  for (int i = 0; i < cell->refs_count; i++) {
+    if (!boc_read_uint(r, ref_size, &cell->refs[i]) ||
+        cell->refs[i] <= index || cell->refs[i] >= cells_num) {
+      return false;
+    }
+  }
+  return true;
+}
 
-  // Parse BOC header
-  uint8_t flags_byte = boc[index++];
-  bool has_idx = flags_byte & 0x80;
-  // bool hash_crc32 = flags_byte & 0x40;
-  // bool has_cache_bits = flags_byte & 0x20;
-  // uint8_t flags = ((flags_byte & 0x10) << 1) | (flags_byte & 0x08);
-  uint8_t size_bytes = flags_byte & 0x07;
+// The serialized descriptors and data of an ordinary cell are its
+// representation, so they are hashed as they are.
+static void boc_hash_cell(const BocCell* cell, const CellRef_t* cell_refs,
+                          CellRef_t* out) {
+  SHA256_CTX ctx;
+  sha256_Init(&ctx);
+  uint8_t d[2] = {cell->refs_count, cell->d2};
+  sha256_Update(&ctx, d, 2);
+  sha256_Update(&ctx, cell->data, (cell->d2 + 1) / 2);
 
-  // Read offset_bytes
-  uint8_t offset_bytes = boc[index++];
+  out->max_depth = 0;
+  for (int i = 0; i < cell->refs_count; i++) {
+    const CellRef_t* ref = &cell_refs[cell->refs[i]];
+    uint8_t depth[2] = {ref->max_depth >> 8, ref->max_depth & 0xFF};
+    sha256_Update(&ctx, depth, 2);
+    if (ref->max_depth + 1 > out->max_depth) {
+      out->max_depth = ref->max_depth + 1;
+    }
+  }
+  for (int i = 0; i < cell->refs_count; i++) {
+    sha256_Update(&ctx, cell_refs[cell->refs[i]].hash, HASH_LEN);
+  }
+  sha256_Final(&ctx, out->hash);
+}
 
-  // Read cells_num
-  uint32_t cells_num = 0;
-  for (int i = 0; i < size_bytes; i++) {
-    cells_num = (cells_num << 8) | boc[index++];
+static uint32_t boc_crc32c(const uint8_t* data, size_t len) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int j = 0; j < 8; j++) {
+      crc = (crc >> 1) ^ (0x82F63B78 & (0 - (crc & 1)));
+    }
   }
+  return ~crc;
+}
+
+bool ton_parse_boc(const uint8_t* input_boc, size_t input_boc_len,
+                   CellRef_t* payload, BitString_t* payload_bits,
+                   CellRefs_t* payload_refs) {
+  // Hashes of the cells already hashed, and where each cell starts
+  static CellRef_t cell_refs[TON_BOC_MAX_CELLS];
+  static uint16_t cell_pos[TON_BOC_MAX_CELLS];
 
-  if (cells_num > 4) {
-    fsm_sendFailure(FailureType_Failure_ProcessError, "Invalid cells number");
+  if (input_boc_len < 6 || input_boc_len > TON_BOC_MAX_SIZE) {
     return false;
   }
 
-  // Read roots_num
-  uint32_t roots_num = 0;
-  for (int i = 0; i < size_bytes; i++) {
-    roots_num = (roots_num << 8) | boc[index++];
+  // Compare BOC with magic prefix
+  if (memcmp(input_boc, REACH_BOC_MAGIC_PREFIX, 4) != 0) {
+    return false;  // Does not match
   }
 
-  // Read absent_num
-  uint32_t absent_num = 0;
-  for (int i = 0; i < size_bytes; i++) {
-    absent_num = (absent_num << 8) | boc[index++];
+  BocReader r = {input_boc, input_boc_len, 4};
+
+  // Parse BOC header
+  uint8_t flags_byte = input_boc[r.pos++];
+  bool has_idx = flags_byte & 0x80;
+  bool has_crc32 = flags_byte & 0x40;
+  bool has_cache_bits = flags_byte & 0x20;
+  uint8_t size_bytes = flags_byte & 0x07;
+  uint8_t offset_bytes = input_boc[r.pos++];
+  if (size_bytes < 1 || size_bytes > 4 || offset_bytes < 1 ||
+      offset_bytes > 4) {
+    return false;
   }
 
-  // Read tot_cells_size
-  uint32_t tot_cells_size = 0;
-  for (int i = 0; i < offset_bytes; i++) {
-    tot_cells_size = (tot_cells_size << 8) | boc[index++];
+  if (has_crc32) {
+    size_t crc_pos = input_boc_len - 4;
+    if (crc_pos < r.pos) {
+      return false;
+    }
+    uint32_t crc = read_le(&input_boc[crc_pos]);
+    if (crc != boc_crc32c(input_boc, crc_pos)) {
+      return false;
+    }
+    r.len = crc_pos;
   }
 
-  // Read root list (always zero)
+  uint32_t cells_num = 0, roots_num = 0, absent_num = 0, tot_cells_size = 0;
   uint32_t root_cell_index = 0;
-  if (roots_num > 0) {
-    for (int i = 0; i < size_bytes; i++) {
-      root_cell_index = (root_cell_index << 8) | boc[index++];
-    }
+  if (!boc_read_uint(&r, size_bytes, &cells_num) ||
+      !boc_read_uint(&r, size_bytes, &roots_num) ||
+      !boc_read_uint(&r, size_bytes, &absent_num) ||
+      !boc_read_uint(&r, offset_bytes, &tot_cells_size) ||
+      !boc_read_uint(&r, size_bytes, &root_cell_index)) {
+    return false;
+  }
+  if (cells_num == 0 || cells_num > TON_BOC_MAX_CELLS || roots_num != 1 ||
+      absent_num != 0 || root_cell_index >= cells_num) {
+    return false;
   }
 
-  if (has_idx) index += cells_num * offset_bytes;
+  BocReader idx = r;
+  if (has_idx && !boc_skip(&r, cells_num * offset_bytes)) {
+    return false;
+  }
 
-  // First pass: Record data and references for each cell
-  CellData_t cell_data[cells_num];
+  // First pass: check the cell layout against the index and the header
+  size_t cells_start = r.pos;
+  BocCell cell;
   for (uint32_t i = 0; i < cells_num; i++) {
-    bitstring_init(&cell_data[i].bits);
-    uint8_t d1 = boc[index++];
-    uint8_t d2 = boc[index++];
-
-    cell_data[i].refs_count = d1 & 0x07;
-    uint16_t data_bytes = (d2 + 1) / 2;
-    bool is_fullfilled_bytes = !(d2 & 1);
-
-    // Read cell data
-    memcpy(cell_data[i].bits.data, &boc[index], data_bytes);
-    index += data_bytes;
-
-    uint16_t data_cursor;
-    set_top_upped_array(cell_data[i].bits.data, data_bytes, is_fullfilled_bytes,
-                        &data_cursor);
-    cell_data[i].bits.data_cursor = data_cursor;
-
-    if (i == 0) {
-      memcpy(payload_bits->data, cell_data[i].bits.data, data_bytes);
-      payload_bits->data_cursor = data_cursor;
+    cell_pos[i] = r.pos;
+    if (!boc_read_cell(&r, size_bytes, i, cells_num, &cell)) {
+      return false;
     }
-
-    // Read reference indices
-    for (int j = 0; j < cell_data[i].refs_count; j++) {
-      uint32_t ref_index = 0;
-      for (int k = 0; k < offset_bytes; k++) {
-        ref_index = (ref_index << 8) | boc[index++];
+    if (has_idx) {
+      uint32_t end = 0;
+      boc_read_uint(&idx, offset_bytes, &end);
+      if (has_cache_bits) {
+        end >>= 1;
+      }
+      if (end != r.pos - cells_start) {
+        return false;
       }
-      cell_data[i].ref_indices[j] = ref_index;
     }
   }
+  if (r.pos - cells_start != tot_cells_size || r.pos != r.len) {
+    return false;
+  }
 
-  // Second pass: Calculate hash from the end
+  // Second pass: hash every cell once, children first
   for (int i = cells_num - 1; i >= 0; i--) {
-    CellRef_t refs[cell_data[i].refs_count];
-    for (int j = 0; j < cell_data[i].refs_count; j++) {
-      refs[j] = cell_data[cell_data[i].ref_indices[j]].cell_ref;
-    }
-
-    if (!ton_hash_cell(&cell_data[i].bits, refs, cell_data[i].refs_count,
-                       &cell_data[i].cell_ref)) {
-      fsm_sendFailure(FailureType_Failure_ProcessError, "Hash cell failed");
-      return false;
-    }
-
-    if (i == 1) {
-      memcpy(payload_ref, &cell_data[i].cell_ref, sizeof(CellRef_t));
-    }
+    r.pos = cell_pos[i];
+    boc_read_cell(&r, size_bytes, i, cells_num, &cell);
+    boc_hash_cell(&cell, cell_refs, &cell_refs[i]);
   }
 
-  // Assign the value of cell[0] to payload
-  if (cells_num > 0) {
-    CellRef_t temp_payload = cell_data[0].cell_ref;
-    memcpy(payload, &temp_payload, sizeof(CellRef_t));
-  } else {
-    // If no cells found in BOC, return false to indicate failure
-    fsm_sendFailure(FailureType_Failure_ProcessError, "No cells found in BOC");
-    return false;
+  r.pos = cell_pos[root_cell_index];
+  boc_read_cell(&r, size_bytes, root_cell_index, cells_num, &cell);
+  memcpy(payload, &cell_refs[root_cell_index], sizeof(CellRef_t));
+  if (payload_bits) {
+    uint16_t data_len = (cell.d2 + 1) / 2;
+    memcpy(payload_bits->data, cell.data, data_len);
+    set_top_upped_array(payload_bits->data, data_len, !(cell.d2 & 1),
+                        &payload_bits->data_cursor);
+  }
+  if (payload_refs) {
+    memzero(payload_refs, sizeof(CellRefs_t));
+    for (int i = 0; i < cell.refs_count; i++) {
+      memcpy(&payload_refs->refs[i], &cell_refs[cell.refs[i]],
+             sizeof(CellRef_t));
+    }
+    payload_refs->refs_count = cell.refs_count;
   }
-
   return true;
 }
@@ -1,17 +1,24 @@
 #include "ton_tokens.h"
+#include <stdlib.h>
 #include <string.h>
 
-#define TON_TOKENS_COUNT 2
+// Sorted by address for bsearch, with the UNKN entry last.
 const TonTokenType ton_tokens[TON_TOKENS_COUNT + 1] = {
-    {"EQCxE6mUtQJKFnGfaROTKOt1lZbDiiX1kCixRv7Nw2Id_sDs", " USDT", 6},
     {"EQAvlWFDxGF2lXm67y4yzC17wYKD9A0guwPkMs1gOsM__NOT", " NOT", 9},
+    {"EQCxE6mUtQJKFnGfaROTKOt1lZbDiiX1kCixRv7Nw2Id_sDs", " USDT", 6},
     {"FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF", " UNKN", 0},
 };
 
+static int ton_token_compare(const void *key, const void *token) {
+  return memcmp(key, ((const TonTokenType *)token)->address, 48);
+}
+
 ConstTonTokenPtr ton_get_token_by_address(const char *address) {
-  for (int i = 0; i < TON_TOKENS_COUNT; i++) {
-    if (memcmp(address, ton_tokens[i].address, 48) != 0) continue;
-    return &ton_tokens[i];
+  const TonTokenType *token =
+      bsearch(address, ton_tokens, TON_TOKENS_COUNT, sizeof(TonTokenType),
+              ton_token_compare);
+  if (token) {
+    return token;
   }
 
   return &ton_tokens[TON_TOKENS_COUNT];  // UNKN TOKEN
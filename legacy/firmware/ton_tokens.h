@@ -11,6 +11,10 @@ typedef struct {
 
 typedef const TonTokenType *ConstTonTokenPtr;
 
+#define TON_TOKENS_COUNT 2
+
+extern const TonTokenType ton_tokens[TON_TOKENS_COUNT + 1];
+
 ConstTonTokenPtr ton_get_token_by_address(const char *address);
 
 #endif  // __TON_TOKENS_H__
@@ -32,6 +32,7 @@
 #include "memzero.h"
 #include "menu_list.h"
 #include "oled.h"
+#include "profile.h"
 #include "protect.h"
 #include "rng.h"
 #include "setup.h"
@@ -244,9 +245,9 @@ int main(void) {
 #endif
   // ble_reset();
 #if !EMULATOR
-  register_timer("button", timer1s / 2, buttonsTimer);
-  register_timer("button_long", timer1s / 5, longPressTimer);
-  register_timer("charge_dis", timer1s, chargeDisTimer);
+  register_timer(timer1s / 2, buttonsTimer, true);
+  register_timer(timer1s / 5, longPressTimer, true);
+  register_timer(timer1s, chargeDisTimer, true);
 #endif
   __stack_chk_guard = random32();  // this supports compiler provided
                                    // unpredictable stack protection checks
@@ -285,6 +286,7 @@ int main(void) {
 #if !EMULATOR
   config_wipe();
 #endif
+  profile_init();
 #endif
 
   config_init();
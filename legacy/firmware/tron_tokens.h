@@ -30,6 +30,10 @@ typedef struct {
 
 typedef const TronTokenType *ConstTronTokenPtr;
 
+#define TRON_TOKENS_COUNT 14
+
+extern const TronTokenType tron_tokens[TRON_TOKENS_COUNT + 1];
+
 ConstTronTokenPtr get_tron_token_by_address(const char *address);
 
 #endif  // __TRON_TOKENS_H__
@@ -18,12 +18,14 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "usb.h"
 
 #include "debug.h"
 #include "messages.h"
+#include "profile.h"
 #include "timer.h"
 
 static volatile char tiny = 0;
@@ -36,9 +38,66 @@ void usbInit(void) { emulatorSocketInit(); }
 #define _ISDBG ('n')
 #endif
 
+// Outgoing queues and the socket they drain to, mirroring the IN endpoints
+// of the hardware transport.
+typedef struct {
+  int iface;
+  const uint8_t *(*next)(void);
+} UsbTx;
+
+static const UsbTx main_tx = {.iface = 0, .next = msg_out_data};
+#if DEBUG_LINK
+static const UsbTx debug_tx = {.iface = 1, .next = msg_debug_out_data};
+#endif
+
+// Write the next queued packet of tx. Returns true if a packet was sent.
+static bool usb_tx_pump(const UsbTx *tx) {
+  const uint8_t *data = tx->next();
+  if (data == NULL) {
+    return false;
+  }
+  PROFILE_SCOPE(PROFILE_USB);
+  emulatorSocketWrite(tx->iface, data, USB_PACKET_SIZE);
+  return true;
+}
+
+static void usb_tx_drain(const UsbTx *tx) {
+  while (usb_tx_pump(tx)) {
+  }
+}
+
+// Stream transports deliver whole messages, so they skip the reassembly of
+// 64-byte packets. Tiny mode still gets them as a single packet.
+static void usb_read_stream(uint32_t millis) {
+  static uint8_t buffer[MSG_HEADER_SIZE - 1 + MSG_IN_ENCODED_SIZE];
+
+  int iface = 0;
+  size_t len = emulatorSocketRead(&iface, buffer, sizeof(buffer), millis);
+  if (len == 0) {
+    return;
+  }
+  if (!tiny) {
+    msg_read_message(_ISDBG, buffer, len);
+  } else if (len < USB_PACKET_SIZE) {
+    uint8_t packet[USB_PACKET_SIZE] = {'?'};
+    memcpy(packet + 1, buffer, len);
+    msg_read_tiny(packet, sizeof(packet));
+  }
+}
+
 void waitAndProcessUSBRequests(uint32_t millis) {
   emulatorPoll();
 
+  if (emulatorSocketIsStream()) {
+    usb_read_stream(millis);
+    usb_tx_drain(&main_tx);
+#if DEBUG_LINK
+    usb_tx_drain(&debug_tx);
+#endif
+    emulatorSocketFlush();
+    return;
+  }
+
   static uint8_t buffer[USB_PACKET_SIZE];
 
   int iface = 0;
@@ -52,20 +111,20 @@ void waitAndProcessUSBRequests(uint32_t millis) {
     }
   }
 
-  const uint8_t *data;
-  while ((data = msg_out_data()) != NULL) {
-    emulatorSocketWrite(0, data, USB_PACKET_SIZE);
-  }
+  usb_tx_drain(&main_tx);
 
 #if DEBUG_LINK
-  while ((data = msg_debug_out_data()) != NULL) {
-    emulatorSocketWrite(1, data, USB_PACKET_SIZE);
-  }
+  usb_tx_drain(&debug_tx);
 #endif
+  emulatorSocketFlush();
 }
 
 void usbPoll(void) { waitAndProcessUSBRequests(0); }
 
+// The SDL keyboard state cannot be waited on, so callers keep the timeout
+// short enough for the buttons to stay responsive.
+void usbPollWait(uint32_t millis) { waitAndProcessUSBRequests(millis); }
+
 char usbTiny(char set) {
   char old = tiny;
   tiny = set;
@@ -73,9 +132,21 @@ char usbTiny(char set) {
 }
 
 void usbFlush(uint32_t millis) {
-  const uint8_t *data;
-  while ((data = msg_out_data()) != NULL) {
-    emulatorSocketWrite(0, data, USB_PACKET_SIZE);
-  }
+  usb_tx_drain(&main_tx);
+  emulatorSocketFlush();
   usleep(millis * 1000);
 }
+
+bool usbFlushPacket(char type) {
+  bool sent = false;
+  if (type == 'n') {
+    sent = usb_tx_pump(&main_tx);
+  }
+#if DEBUG_LINK
+  if (type == 'd') {
+    sent = usb_tx_pump(&debug_tx);
+  }
+#endif
+  emulatorSocketFlush();
+  return sent;
+}
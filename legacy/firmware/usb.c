@@ -26,6 +26,7 @@
 #include "debug.h"
 #include "messages.h"
 #include "oled.h"
+#include "profile.h"
 #include "random_delays.h"
 #include "timer.h"
 #include "trans_fifo.h"
@@ -335,6 +336,7 @@ static void main_rx_callback(usbd_device *dev, uint8_t ep) {
   (void)ep;
   static CONFIDENTIAL uint8_t buf[64] __attribute__((aligned(4)));
   if (dev != NULL) {
+    PROFILE_SCOPE(PROFILE_USB);
     if (usbd_ep_read_packet(dev, ENDPOINT_ADDRESS_MAIN_OUT, buf, sizeof(buf)) !=
         USB_PACKET_SIZE)
       return;
@@ -344,7 +346,7 @@ static void main_rx_callback(usbd_device *dev, uint8_t ep) {
     host_channel = CHANNEL_SLAVE;
   }
   timer_sleep_start_reset();
-  unregister_timer("poweroff");
+  unregister_timer(&auto_poweroff_handle);
   debugLog(0, "", "main_rx_callback");
   if (!tiny) {
     msg_read(buf, sizeof(buf));
@@ -371,22 +373,116 @@ static void debug_rx_callback(usbd_device *dev, uint8_t ep) {
 
 #endif
 
+// Outgoing packets are double-buffered: while one packet sits in the
+// endpoint FIFO, the next one is staged here.  The transfer-complete
+// callback of an IN endpoint writes the staged packet, so a queue drains
+// back to back whenever usbd_poll runs, not just once per usbPoll.
+typedef struct {
+  uint8_t ep;
+  const uint8_t *(*next)(void);
+  bool pending;
+  uint8_t packet[USB_PACKET_SIZE] __attribute__((aligned(4)));
+} UsbTx;
+
+static const uint8_t *main_out_data(void) {
+  // the I2C channel sends its packets from msg_write_common
+  return CHANNEL_USB == host_channel ? msg_out_data() : NULL;
+}
+
+static UsbTx main_tx = {.ep = ENDPOINT_ADDRESS_MAIN_IN, .next = main_out_data};
+
+#if U2F_ENABLED
+static const uint8_t *u2f_next_data(void) { return u2f_out_data(); }
+
+static UsbTx u2f_tx = {.ep = ENDPOINT_ADDRESS_U2F_IN, .next = u2f_next_data};
+#endif
+
+#if DEBUG_LINK
+static UsbTx debug_tx = {.ep = ENDPOINT_ADDRESS_DEBUG_IN,
+                         .next = msg_debug_out_data};
+#endif
+
+// Stage the next queued packet if needed and try to write it.
+// Returns true if a packet was handed to the endpoint.
+static bool usb_tx_pump(usbd_device *dev, UsbTx *tx) {
+  PROFILE_SCOPE(PROFILE_USB);
+  if (!tx->pending) {
+    const uint8_t *data = tx->next();
+    if (data == NULL) {
+      return false;
+    }
+    memcpy(tx->packet, data, USB_PACKET_SIZE);
+    tx->pending = true;
+  }
+  if (usbd_ep_write_packet(dev, tx->ep, tx->packet, USB_PACKET_SIZE) !=
+      USB_PACKET_SIZE) {
+    return false;
+  }
+  tx->pending = false;
+  return true;
+}
+
+// Write all queued packets of tx, waiting for the host to take each one.
+// Returns false if the host did not read a packet within timeout. Nothing
+// is queued while draining, so the wait is bounded by the queue length.
+static bool usb_tx_drain(usbd_device *dev, UsbTx *tx, uint32_t timeout) {
+  timer_out_set(timer_out_resp, timeout);
+  for (;;) {
+    if (usb_tx_pump(dev, tx)) {
+      timer_out_set(timer_out_resp, timeout);
+    } else if (!tx->pending) {
+      return true;
+    } else if (timer_out_get(timer_out_resp) == 0) {
+      return false;
+    }
+  }
+}
+
+static void usb_tx_reset(void) {
+  main_tx.pending = false;
+#if U2F_ENABLED
+  u2f_tx.pending = false;
+#endif
+#if DEBUG_LINK
+  debug_tx.pending = false;
+#endif
+}
+
+static void main_tx_callback(usbd_device *dev, uint8_t ep) {
+  (void)ep;
+  usb_tx_pump(dev, &main_tx);
+}
+
+#if U2F_ENABLED
+static void u2f_tx_callback(usbd_device *dev, uint8_t ep) {
+  (void)ep;
+  usb_tx_pump(dev, &u2f_tx);
+}
+#endif
+
+#if DEBUG_LINK
+static void debug_tx_callback(usbd_device *dev, uint8_t ep) {
+  (void)ep;
+  usb_tx_pump(dev, &debug_tx);
+}
+#endif
+
 static void set_config(usbd_device *dev, uint16_t wValue) {
   (void)wValue;
 
   usbd_ep_setup(dev, ENDPOINT_ADDRESS_MAIN_IN, USB_ENDPOINT_ATTR_INTERRUPT,
-                USB_PACKET_SIZE, 0);
+                USB_PACKET_SIZE, main_tx_callback);
   usbd_ep_setup(dev, ENDPOINT_ADDRESS_MAIN_OUT, USB_ENDPOINT_ATTR_INTERRUPT,
                 USB_PACKET_SIZE, main_rx_callback);
 #if U2F_ENABLED
   usbd_ep_setup(dev, ENDPOINT_ADDRESS_U2F_IN, USB_ENDPOINT_ATTR_INTERRUPT,
-                USB_PACKET_SIZE, 0);
+                USB_PACKET_SIZE, u2f_tx_callback);
   usbd_ep_setup(dev, ENDPOINT_ADDRESS_U2F_OUT, USB_ENDPOINT_ATTR_INTERRUPT,
                 USB_PACKET_SIZE, u2f_rx_callback);
 #endif
 #if DEBUG_LINK
   usbd_ep_setup(dev, ENDPOINT_ADDRESS_DEBUG_IN, USB_ENDPOINT_ATTR_INTERRUPT,
-                USB_PACKET_SIZE, 0);
+                USB_PACKET_SIZE, debug_tx_callback);
   usbd_ep_setup(dev, ENDPOINT_ADDRESS_DEBUG_OUT, USB_ENDPOINT_ATTR_INTERRUPT,
                 USB_PACKET_SIZE, debug_rx_callback);
 #endif
@@ -412,6 +508,7 @@ static const struct usb_bos_descriptor bos_descriptor = {
     .capabilities = capabilities};
 
 void usbInit(void) {
+  usb_tx_reset();
   bool trezor_comp_mode = false;
   if (!config_hasTrezorCompMode()) {
     config_setTrezorCompMode(true);
@@ -470,8 +567,6 @@ static void i2c_slave_poll(void) {
 }
 
 void usbPoll(void) {
-  static const uint8_t *data;
-
   volatile bool reset = false;
   bool lock = true;
 
@@ -526,59 +621,36 @@ void usbPoll(void) {
   if (usbd_dev == NULL) {
     return;
   }
-  // poll read buffer
+  // poll read buffer, transfer-complete callbacks write queued packets
   usbd_poll(usbd_dev);
-  // write pending data
-  if (CHANNEL_USB == host_channel) {
-    data = msg_out_data();
-    if (data) {
-      timer_out_set(timer_out_resp, timer1s / 2);
-      while (usbd_ep_write_packet(usbd_dev, ENDPOINT_ADDRESS_MAIN_IN, data,
-                                  USB_PACKET_SIZE) != USB_PACKET_SIZE) {
-        if (timer_out_get(timer_out_resp) == 0) {
-          clear_msg_out();
-
-          RCC_AHB2RSTR |= RCC_AHB2RSTR_OTGFSRST;
-          RCC_AHB2RSTR &= ~RCC_AHB2RSTR_OTGFSRST;
-          usbInit();
-          break;
-        }
-      }
-    }
+  // write all pending data
+  if (!usb_tx_drain(usbd_dev, &main_tx, timer1s / 2)) {
+    clear_msg_out();
+    usb_tx_reset();
+
+    RCC_AHB2RSTR |= RCC_AHB2RSTR_OTGFSRST;
+    RCC_AHB2RSTR &= ~RCC_AHB2RSTR_OTGFSRST;
+    usbInit();
+    return;
   }
 
 #if U2F_ENABLED
-  data = u2f_out_data();
-  if (data) {
-    while (usbd_ep_write_packet(usbd_dev, ENDPOINT_ADDRESS_U2F_IN, data,
-                                USB_PACKET_SIZE) != USB_PACKET_SIZE) {
-    }
-  }
+  usb_tx_pump(usbd_dev, &u2f_tx);
 #endif
 
 #if DEBUG_LINK
   // write pending debug data
-  data = msg_debug_out_data();
-  if (data) {
-    while (usbd_ep_write_packet(usbd_dev, ENDPOINT_ADDRESS_DEBUG_IN, data,
-                                USB_PACKET_SIZE) != USB_PACKET_SIZE) {
-    }
-  }
+  usb_tx_pump(usbd_dev, &debug_tx);
 #endif
 }
 
 #if !BITCOIN_ONLY
 void usb_u2f_data_send(void) {
-  static const uint8_t *data;
-  while (1) {
-    data = u2f_out_data();
-    if (data) {
-      while (usbd_ep_write_packet(usbd_dev, ENDPOINT_ADDRESS_U2F_IN, data,
-                                  USB_PACKET_SIZE) != USB_PACKET_SIZE) {
-      }
-    } else {
-      break;
+  // a host that stops reading loses the rest of the response
+  if (!usb_tx_drain(usbd_dev, &u2f_tx, timer1s)) {
+    while (u2f_out_data() != NULL) {
     }
+    u2f_tx.pending = false;
   }
 }
 #endif
@@ -608,22 +680,30 @@ void waitAndProcessUSBRequests(uint32_t millis) {
   while ((timer_ms() - start) < millis) {
     if (usbd_dev != NULL) {
       usbd_poll(usbd_dev);
+      usb_tx_pump(usbd_dev, &main_tx);
     }
     i2c_slave_poll();
   }
 }
 
+void usbPollWait(uint32_t millis) {
+  usbPoll();
+  if (millis == 0) {
+    return;
+  }
+  // USB is polled, but SysTick, the BLE USART, the I2C slave and the power
+  // button all interrupt, so this sleeps for a millisecond at most
+  __asm__ volatile("wfi");
+}
+
 void usbFlush(uint32_t millis) {
   if (usbd_dev == NULL) {
     return;
   }
 
-  static const uint8_t *data;
-  data = msg_out_data();
-  if (data) {
-    while (usbd_ep_write_packet(usbd_dev, ENDPOINT_ADDRESS_MAIN_IN, data,
-                                USB_PACKET_SIZE) != USB_PACKET_SIZE) {
-    }
+  if (!usb_tx_drain(usbd_dev, &main_tx, timer1s / 2)) {
+    clear_msg_out();
+    main_tx.pending = false;
   }
 
   uint32_t start = timer_ms();
@@ -632,3 +712,32 @@ void usbFlush(uint32_t millis) {
     asm("nop");
   }
 }
+
+bool usbFlushPacket(char type) {
+  if (usbd_dev == NULL) {
+    return false;
+  }
+
+  UsbTx *tx = NULL;
+  if (type == 'n') {
+    tx = &main_tx;
+  }
+#if DEBUG_LINK
+  else if (type == 'd') {
+    tx = &debug_tx;
+  }
+#endif
+  if (tx == NULL) {
+    return false;
+  }
+
+  // a staged packet has already left the queue, so a written one makes
+  // room either now or on the next call
+  timer_out_set(timer_out_resp, timer1s / 2);
+  while (!usb_tx_pump(usbd_dev, tx)) {
+    if (!tx->pending || timer_out_get(timer_out_resp) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
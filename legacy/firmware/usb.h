@@ -20,8 +20,15 @@
 #ifndef __USB_H__
 #define __USB_H__
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #define USB_PACKET_SIZE 64
 
+// Longest time a wait loop sleeps in `usbPollWait` before it looks at the
+// buttons and its timeouts again.
+#define USB_POLL_WAIT_MS 10
+
 void usbInit(void);
 void usbPoll(void);
 void usbReconnect(void);
@@ -50,12 +57,31 @@ char usbTiny(char set);
  */
 void waitAndProcessUSBRequests(uint32_t millis);
 
+/*
+ * Like `usbPoll`, but then sleep until something may need attention: an
+ * incoming USB, BLE or DebugLink packet, a button change or a timer tick,
+ * for at most the given number of milliseconds. Loops waiting for the user
+ * or the host should call this instead of spinning on `usbPoll`.
+ *
+ * On hardware the core sleeps in WFI until the next interrupt, which is at
+ * most one SysTick. The emulator blocks in poll() on its sockets.
+ */
+void usbPollWait(uint32_t millis);
+
 /*
  * Flush out any messages still in USB bus FIFO while waiting given number
  * of milliseconds. Any incoming USB protobuf messages are not serviced.
  */
 void usbFlush(uint32_t millis);
 
+/*
+ * Send the oldest pending packet of the outgoing message queue `type`
+ * ('n' or 'd') to the host. Used by the message framer to make room while a
+ * response larger than the queue is being encoded. Returns false if no
+ * packet could be sent.
+ */
+bool usbFlushPacket(char type);
+
 void usb_u2f_data_send(void);
 
 #endif
@@ -38,7 +38,23 @@ static const uint32_t FLASH_SECTOR_TABLE[FLASH_SECTOR_COUNT + 1] = {
     [9] = 0x080A0000,   // - 0x080BFFFF | 128 KiB
     [10] = 0x080C0000,  // - 0x080DFFFF | 128 KiB
     [11] = 0x080E0000,  // - 0x080FFFFF | 128 KiB
-    [12] = 0x08100000,  // last element - not a valid sector
+    [12] = 0x08100000,  // - 0x08103FFF |  16 KiB
+    [13] = 0x08104000,  // - 0x08107FFF |  16 KiB
+    [14] = 0x08108000,  // - 0x0810BFFF |  16 KiB
+    [15] = 0x0810C000,  // - 0x0810FFFF |  16 KiB
+    [16] = 0x08110000,  // - 0x0811FFFF |  64 KiB
+    [17] = 0x08120000,  // - 0x0813FFFF | 128 KiB
+    [18] = 0x08140000,  // - 0x0815FFFF | 128 KiB
+    [19] = 0x08160000,  // - 0x0817FFFF | 128 KiB
+    [20] = 0x08180000,  // - 0x0819FFFF | 128 KiB
+    [21] = 0x081A0000,  // - 0x081BFFFF | 128 KiB
+    [22] = 0x081C0000,  // - 0x081DFFFF | 128 KiB
+    [23] = 0x081E0000,  // - 0x081FFFFF | 128 KiB
+    [24] = 0x08200000,  // - 0x0823FFFF | 256 KiB
+    [25] = 0x08240000,  // - 0x0827FFFF | 256 KiB
+    [26] = 0x08280000,  // - 0x082BFFFF | 256 KiB
+    [27] = 0x082C0000,  // - 0x082FFFFF | 256 KiB
+    [28] = 0x08300000,  // last element - not a valid sector
 };
 
 static secbool flash_check_success(uint32_t status) {
@@ -77,7 +77,15 @@ extern uint8_t *emulator_flash_base;
 #define FLASH_FWHEADER_LEN (0x400)
 
 #define FLASH_APP_START (FLASH_FWHEADER_START + FLASH_FWHEADER_LEN)
-#define FLASH_APP_LEN (2 * 1024 * 1024 - 64 * 1024)
+// firmware header and code end with sector 23, see memory_app_1.8.0.ld
+#define FLASH_APP_LEN (2 * 1024 * 1024 - 64 * 1024 - FLASH_FWHEADER_LEN)
+
+// verified Ethereum definitions, see ethereum_definitions_store.c
+#define FLASH_ETH_DEFS_SECTOR 24
+#define FLASH_ETH_DEFS_START (0x08200000)
+#define FLASH_ETH_DEFS_LEN (0x40000)
+
+#define FLASH_FONT_START (0x08240000)  // sector 25
 
 #define FLASH_BOOT_SECTOR_FIRST 0
 #define FLASH_BOOT_SECTOR_LAST 3
@@ -103,6 +111,11 @@ extern uint8_t *emulator_flash_base;
 #define FLASH_BLE_FIRMWARE_START (FLASH_INIT_DATA_START + FLASH_INIT_DATA_LEN)
 #define FLASH_BLE_MAX_LEN (0x40000)
 
+_Static_assert(FLASH_APP_START + FLASH_APP_LEN <= FLASH_ETH_DEFS_START,
+               "firmware overlaps the Ethereum definitions store");
+_Static_assert(FLASH_ETH_DEFS_START + FLASH_ETH_DEFS_LEN <= FLASH_FONT_START,
+               "Ethereum definitions store overlaps the font");
+
 void memory_protect(void);
 uint8_t memory_protect_state(void);
 void memory_write_lock(void);
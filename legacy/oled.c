@@ -23,6 +23,7 @@
 #include "common.h"
 #include "memzero.h"
 #include "oled.h"
+#include "profile.h"
 #include "prompt.h"
 #include "timer.h"
 #include "util.h"
@@ -94,6 +95,29 @@ void oledClearPixel(int x, int y) {
   _oledbuffer[OLED_OFFSET(x, y)] &= ~OLED_MASK(x, y);
 }
 
+/*
+ * Clears the pixels of column x whose bits are set in pixels, bit y for
+ * row y, one buffer byte per 8 rows
+ */
+void oledClearColumn(int x, uint64_t pixels) {
+  if ((x < 0) || (x >= OLED_WIDTH)) {
+    return;
+  }
+  for (int page = 0; page < OLED_HEIGHT / 8; page++) {
+    uint8_t bits = pixels >> (page * 8);
+    if (bits == 0) {
+      continue;
+    }
+    uint8_t mask = 0;
+    for (int y = 0; y < 8; y++) {
+      if (bits & (1 << y)) {
+        mask |= OLED_MASK(x, y);
+      }
+    }
+    _oledbuffer[OLED_OFFSET(x, page * 8)] &= ~mask;
+  }
+}
+
 /*
  * Inverts pixel at x, y
  */
@@ -223,6 +247,7 @@ void oledInvertDebugLink() {
  */
 #if !EMULATOR
 void oledRefresh() {
+  PROFILE_SCOPE(PROFILE_DISPLAY);
   static const uint8_t s[3] = {OLED_SETLOWCOLUMN | 0x00,
                                OLED_SETHIGHCOLUMN | 0x00,
                                OLED_SETSTARTLINE | 0x00};
@@ -276,6 +301,24 @@ void oledBufferRestore(uint8_t *buffer) {
   memcpy(_oledbuffer, buffer, OLED_BUFSIZE);
 }
 
+/*
+ * Save / restore the full height columns x..x+width-1 page by page.
+ * buffer must hold width * OLED_HEIGHT / 8 bytes.
+ */
+void oledBufferLoadColumns(int x, int width, uint8_t *buffer) {
+  for (int page = 0; page < OLED_HEIGHT / 8; page++) {
+    memcpy(buffer + page * width,
+           _oledbuffer + OLED_OFFSET(x + width - 1, page * 8), width);
+  }
+}
+
+void oledBufferRestoreColumns(int x, int width, const uint8_t *buffer) {
+  for (int page = 0; page < OLED_HEIGHT / 8; page++) {
+    memcpy(_oledbuffer + OLED_OFFSET(x + width - 1, page * 8),
+           buffer + page * width, width);
+  }
+}
+
 void oledclearLine(uint8_t line) {
   if (line < (OLED_HEIGHT / 8)) {
     memzero(_oledbuffer + OLED_WIDTH * (OLED_HEIGHT / 8 - line - 1),
@@ -50,12 +50,15 @@ void oledBufferBak(void);
 void oledBufferResume(void);
 void oledBufferLoad(uint8_t *buffer);
 void oledBufferRestore(uint8_t *buffer);
+void oledBufferLoadColumns(int x, int width, uint8_t *buffer);
+void oledBufferRestoreColumns(int x, int width, const uint8_t *buffer);
 void oledSetBuffer(uint8_t *buf);
 void oledclearLine(uint8_t line);
 const uint8_t *oledGetBuffer(void);
 bool oledGetPixel(int x, int y);
 void oledDrawPixel(int x, int y);
 void oledClearPixel(int x, int y);
+void oledClearColumn(int x, uint64_t pixels);
 void oledInvertPixel(int x, int y);
 void oledDrawChar(int x, int y, char c, uint8_t font);
 int oledStringWidth(const char *text, uint8_t font);
@@ -0,0 +1,120 @@
+#include "profile.h"
+
+#if DEBUG_LINK
+
+#include <string.h>
+
+#if EMULATOR
+#include <time.h>
+#else
+#include <libopencm3/cm3/dwt.h>
+#include <libopencm3/stm32/rcc.h>
+#include "util.h"
+#endif
+
+static ProfileMessage messages[PROFILE_MESSAGES];
+static ProfileMessage *current = &messages[0];
+static uint16_t current_id = PROFILE_NO_MESSAGE;
+static uint8_t depth[PROFILE_SECTIONS];
+
+#if !EMULATOR
+// The cycle counter is not accessible in unprivileged mode, where only the
+// number of times each section ran is counted.
+static bool has_cycle_counter = false;
+#endif
+
+// The emulator counts nanoseconds, as if it ran at 1 GHz.
+static uint32_t profile_cycles(void) {
+#if EMULATOR
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)ts.tv_sec * 1000000000U + ts.tv_nsec;
+#else
+  return has_cycle_counter ? dwt_read_cycle_counter() : 0;
+#endif
+}
+
+uint32_t profile_cycles_per_us(void) {
+#if EMULATOR
+  return 1000;
+#else
+  return has_cycle_counter ? rcc_ahb_frequency / 1000000 : 0;
+#endif
+}
+
+void profile_init(void) {
+#if !EMULATOR
+  has_cycle_counter = !is_mode_unprivileged() && dwt_enable_cycle_counter();
+#endif
+  profile_reset();
+}
+
+void profile_reset(void) {
+  memset(messages, 0, sizeof(messages));
+  for (int i = 0; i < PROFILE_MESSAGES; i++) {
+    messages[i].msg_id = PROFILE_NO_MESSAGE;
+  }
+  profile_set_message(current_id);
+}
+
+uint16_t profile_set_message(uint16_t msg_id) {
+  uint16_t prev = current_id;
+  current_id = msg_id;
+  current = &messages[0];
+  if (msg_id == PROFILE_NO_MESSAGE) {
+    return prev;
+  }
+  for (int i = 1; i < PROFILE_MESSAGES; i++) {
+    if (messages[i].msg_id == PROFILE_NO_MESSAGE) {
+      messages[i].msg_id = msg_id;
+    }
+    if (messages[i].msg_id == msg_id) {
+      current = &messages[i];
+      break;
+    }
+  }
+  return prev;
+}
+
+ProfileScope profile_begin(ProfileSection section) {
+  ProfileScope scope = {section, depth[section]++ == 0, 0};
+  if (scope.outer) {
+    scope.start = profile_cycles();
+  }
+  return scope;
+}
+
+static uint8_t bucket(uint32_t cycles) {
+  uint8_t b = cycles ? (31 - __builtin_clz(cycles)) / 2 : 0;
+  return b < PROFILE_BUCKETS ? b : PROFILE_BUCKETS - 1;
+}
+
+void profile_end(ProfileScope *scope) {
+  depth[scope->section]--;
+  if (!scope->outer) {
+    // nested in a scope of the same section, which counts the time
+    return;
+  }
+  uint32_t cycles = profile_cycles() - scope->start;
+
+  ProfileHistogram *h = &current->sections[scope->section];
+  h->count++;
+  h->total += cycles;
+  if (cycles > h->max) {
+    h->max = cycles;
+  }
+  uint16_t *b = &h->buckets[bucket(cycles)];
+  if (*b < UINT16_MAX) {
+    (*b)++;
+  }
+}
+
+const ProfileMessage *profile_get(int index) {
+  if (index < 0 || index >= PROFILE_MESSAGES ||
+      (index > 0 && messages[index].msg_id == PROFILE_NO_MESSAGE)) {
+    return NULL;
+  }
+  return &messages[index];
+}
+
+#endif
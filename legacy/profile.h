@@ -0,0 +1,76 @@
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Sections of work timed in DEBUG_LINK builds. Sections may overlap, e.g.
+// USB writes made while a response is being encoded count in both, but a
+// section nested in itself is only counted once.
+typedef enum {
+  PROFILE_SE = 0,
+  PROFILE_HASH,
+  PROFILE_ECC,
+  PROFILE_DECODE,
+  PROFILE_ENCODE,
+  PROFILE_USB,
+  PROFILE_DISPLAY,
+  PROFILE_SECTIONS,
+} ProfileSection;
+
+// Timings are kept per message type. Slot 0 collects the time spent
+// outside of any message and the message types beyond the first
+// PROFILE_MESSAGES - 1.
+#define PROFILE_MESSAGES 8
+#define PROFILE_NO_MESSAGE 0xFFFF
+
+// Bucket i counts durations of [4^i, 4^(i+1)) cycles.
+#define PROFILE_BUCKETS 16
+
+typedef struct {
+  uint32_t count;
+  uint64_t total;
+  uint32_t max;
+  uint16_t buckets[PROFILE_BUCKETS];
+} ProfileHistogram;
+
+typedef struct {
+  uint16_t msg_id;
+  ProfileHistogram sections[PROFILE_SECTIONS];
+} ProfileMessage;
+
+#if DEBUG_LINK
+
+typedef struct {
+  uint8_t section;
+  bool outer;
+  uint32_t start;
+} ProfileScope;
+
+void profile_init(void);
+uint32_t profile_cycles_per_us(void);
+ProfileScope profile_begin(ProfileSection section);
+void profile_end(ProfileScope *scope);
+
+// Attributes the following timings to msg_id and returns the previous one.
+uint16_t profile_set_message(uint16_t msg_id);
+
+// Returns the message slot at index, or NULL if it is unused.
+const ProfileMessage *profile_get(int index);
+void profile_reset(void);
+
+// Times the rest of the enclosing block.
+#define PROFILE_SCOPE(section)                          \
+  ProfileScope profile_scope_##section                  \
+      __attribute__((cleanup(profile_end))) = profile_begin(section)
+
+#else
+
+#define PROFILE_SCOPE(section)
+
+#endif
+
+// picked up by the crypto library, see options.h
+#define CRYPTO_PROFILE_SCOPE(section) PROFILE_SCOPE(section)
+
+#endif
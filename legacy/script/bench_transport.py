@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+"""Measure the message throughput of the emulator transport.
+
+Start the emulator with TREZOR_TRANSPORT set to udp (default), tcp or
+unix:PATH and pass the matching trezorlib path, e.g.
+
+    ./bench_transport.py udp:127.0.0.1:54935
+    ./bench_transport.py stream:tcp:127.0.0.1:54935
+    ./bench_transport.py stream:unix:/tmp/trezor.sock
+"""
+
+import sys
+import time
+
+from trezorlib import messages
+from trezorlib.mapping import DEFAULT_MAPPING
+from trezorlib.transport import get_transport
+
+DEFAULT_PATH = "udp:127.0.0.1:54935"
+DURATION = 3.0
+# Ping.message is limited to 256 bytes by the firmware
+SIZES = (0, 32, 128, 255)
+
+
+def bench(transport, size):
+    msg_type, msg_data = DEFAULT_MAPPING.encode(
+        messages.Ping(message="x" * size, button_protection=False)
+    )
+    count = 0
+    total = 0
+    start = time.monotonic()
+    while True:
+        transport.write(msg_type, msg_data)
+        resp_type, resp_data = transport.read()
+        resp = DEFAULT_MAPPING.decode(resp_type, resp_data)
+        if not isinstance(resp, messages.Success):
+            raise RuntimeError(f"Unexpected response: {resp}")
+        count += 1
+        total += len(msg_data) + len(resp_data)
+        elapsed = time.monotonic() - start
+        if elapsed >= DURATION:
+            return count / elapsed, total / elapsed / 1e6
+
+
+def main():
+    path = sys.argv[1] if len(sys.argv) > 1 else DEFAULT_PATH
+    transport = get_transport(path)
+    transport.begin_session()
+    try:
+        print(f"transport {transport.get_path()}")
+        for size in SIZES:
+            msgs, mbytes = bench(transport, size)
+            print(f"ping {size:3d} bytes: {msgs:8.1f} msg/s {mbytes:6.3f} MB/s")
+    finally:
+        transport.end_session()
+
+
+if __name__ == "__main__":
+    main()
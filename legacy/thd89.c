@@ -1,9 +1,11 @@
 #include "thd89.h"
 #include "common.h"
+#include "profile.h"
 #include "usart.h"
 
 secbool thd89_transmit(uint8_t *cmd, uint16_t len, uint8_t *resp,
                        uint16_t *resp_len) {
+  PROFILE_SCOPE(PROFILE_SE);
   if (secfalse == bMI2CDRV_SendData(cmd, len)) {
     return secfalse;
   }
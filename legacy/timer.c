@@ -17,8 +17,6 @@
  * along with this library.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <string.h>
-
 #include <libopencm3/cm3/systick.h>
 #include <libopencm3/cm3/vector.h>
 #include <libopencm3/stm32/rcc.h>
@@ -50,49 +48,91 @@ void delay_us(uint32_t uiDelay_us) {
 
 #define TIMER_NUM 5
 typedef struct {
-  char name[32];
-  uint32_t current;
-  uint32_t cycle;
-  timer_func fp;
+  timer_func fp;  // NULL for a free slot, written last when registering
+  uint32_t deadline;
+  uint32_t cycle;  // 0 for a one-shot timer
+  uint8_t generation;
 } TimerDsec;
 
-TimerDsec timer_array[TIMER_NUM] = {0};
+static volatile TimerDsec timer_array[TIMER_NUM];
+
+// The tick handler only looks at the timers when the earliest deadline is
+// reached or a timer has been registered since it last did.
+static volatile uint32_t timer_next_deadline = 0;
+static volatile bool timer_rescan = false;
 
-void register_timer(char *name, uint32_t cyc, timer_func fp) {
-  int i;
+static bool deadline_reached(uint32_t deadline) {
+  return (int32_t)(system_millis - deadline) >= 0;
+}
 
-  for (i = 0; i < TIMER_NUM; i++) {
+timer_handle register_timer(uint32_t cyc, timer_func fp, bool periodic) {
+  for (int i = 0; i < TIMER_NUM; i++) {
     if (!timer_array[i].fp) {
-      strcpy(timer_array[i].name, name);
-      timer_array[i].current = system_millis;
-      timer_array[i].cycle = cyc;
+      timer_array[i].deadline = system_millis + cyc;
+      timer_array[i].cycle = periodic ? cyc : 0;
+      timer_array[i].generation++;
       timer_array[i].fp = fp;
-      return;
+      timer_rescan = true;
+      return (timer_array[i].generation << 8) | i;
     }
   }
+  return TIMER_INVALID;
 }
 
-void unregister_timer(char *name) {
-  int i;
+void unregister_timer(timer_handle *handle) {
+  if (*handle == TIMER_INVALID) {
+    return;
+  }
+  const uint32_t i = *handle & 0xFF;
+  if (i < TIMER_NUM && timer_array[i].generation == (uint8_t)(*handle >> 8)) {
+    timer_array[i].fp = NULL;
+  }
+  *handle = TIMER_INVALID;
+}
 
-  for (i = 0; i < TIMER_NUM; i++) {
-    if (!strcmp(timer_array[i].name, name)) {
-      memset(timer_array[i].name, 0x00, sizeof(TimerDsec));
-      return;
+static void timer_dispatch(void) {
+  uint32_t next_in = UINT32_MAX >> 1;
+  timer_rescan = false;
+  for (int i = 0; i < TIMER_NUM; i++) {
+    timer_func fp = timer_array[i].fp;
+    if (!fp) {
+      continue;
+    }
+    if (deadline_reached(timer_array[i].deadline)) {
+      if (timer_array[i].cycle) {
+        timer_array[i].deadline = system_millis + timer_array[i].cycle;
+      } else {
+        timer_array[i].fp = NULL;
+      }
+      fp();
+    }
+    if (timer_array[i].fp &&
+        timer_array[i].deadline - system_millis < next_in) {
+      next_in = timer_array[i].deadline - system_millis;
     }
   }
+  timer_next_deadline = system_millis + next_in;
 }
 
-static uint32_t timer_out_array[timer_out_null];
-static void timer_out_decrease(void) {
-  uint32_t i = timer_out_null;
-  while (i--) {
-    if (timer_out_array[i]) timer_out_array[i]--;
-  }
+// Timeouts are kept as deadlines, so that nothing has to count them down.
+static uint32_t timer_out_deadline[timer_out_null];
+static bool timer_out_active[timer_out_null];
+
+void timer_out_set(TimerOut type, uint32_t val) {
+  timer_out_deadline[type] = system_millis + val;
+  timer_out_active[type] = val != 0;
 }
 
-void timer_out_set(TimerOut type, uint32_t val) { timer_out_array[type] = val; }
-uint32_t timer_out_get(TimerOut type) { return timer_out_array[type]; }
+uint32_t timer_out_get(TimerOut type) {
+  if (!timer_out_active[type]) {
+    return 0;
+  }
+  if (deadline_reached(timer_out_deadline[type])) {
+    timer_out_active[type] = false;
+    return 0;
+  }
+  return timer_out_deadline[type] - system_millis;
+}
 /*
  * Initialise the Cortex-M3 SysTick timer
  */
@@ -124,20 +164,15 @@ void timer_init(void) {
 }
 
 void sys_tick_handler(void) {
-  int i;
   system_millis++;
   system_millis_sleep_start++;
-  timer_out_decrease();
-  for (i = 0; i < TIMER_NUM; i++) {
-    if (timer_array[i].fp) {
-      if ((system_millis - timer_array[i].current) > timer_array[i].cycle) {
-        timer_array[i].current = system_millis;
-        timer_array[i].fp();
-      }
-    }
+  if (timer_rescan || deadline_reached(timer_next_deadline)) {
+    timer_dispatch();
   }
 }
 
+timer_handle auto_poweroff_handle = TIMER_INVALID;
+
 void timer_sleep_start_reset(void) { system_millis_sleep_start = 0; }
 
 uint32_t timer_get_sleep_count(void) { return system_millis_sleep_start; }
@@ -20,6 +20,7 @@
 #ifndef __TIMER_H__
 #define __TIMER_H__
 
+#include <stdbool.h>
 #include <stdint.h>
 #include "supervise.h"
 
@@ -42,8 +43,16 @@ typedef enum _TimerOut {
 
 typedef void (*timer_func)(void);
 
-void register_timer(char *name, uint32_t cyc, timer_func fp);
-void unregister_timer(char *name);
+// Handle of a registered timer. A stale handle does not match a timer
+// registered later in the same slot.
+typedef int32_t timer_handle;
+#define TIMER_INVALID (-1)
+
+// Calls fp after cyc ms, and then every cyc ms if periodic. Returns
+// TIMER_INVALID if all timers are in use.
+timer_handle register_timer(uint32_t cyc, timer_func fp, bool periodic);
+// Stops the timer if it has not expired yet and invalidates the handle.
+void unregister_timer(timer_handle *handle);
 
 void delay_ms(uint32_t uiDelay_Ms);
 void delay_us(uint32_t uiDelay_us);
@@ -64,6 +73,8 @@ uint32_t timer_ms(void);
 #else
 #define timer_ms svc_timer_ms
 extern uint8_t usb_connect_status;
+// Auto power-off timer of the sleep screen, cancelled by any user input.
+extern timer_handle auto_poweroff_handle;
 #endif
 
 #endif
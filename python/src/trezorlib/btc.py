@@ -136,6 +136,28 @@ def get_public_node(
     )
 
 
+@expect(messages.PublicKeyMultiple, field="xpubs", ret_type=List[str])
+def get_public_node_multiple(
+    client: "TrezorClient",
+    paths: Sequence["Address"],
+    ecdsa_curve_name: Optional[str] = None,
+    show_display: bool = False,
+    coin_name: Optional[str] = None,
+    script_type: messages.InputScriptType = messages.InputScriptType.SPENDADDRESS,
+    ignore_xpub_magic: bool = False,
+) -> "MessageType":
+    return client.call(
+        messages.GetPublicKeyMultiple(
+            addresses=[messages.BIP32Address(address_n=n) for n in paths],
+            ecdsa_curve_name=ecdsa_curve_name,
+            show_display=show_display,
+            coin_name=coin_name,
+            script_type=script_type,
+            ignore_xpub_magic=ignore_xpub_magic,
+        )
+    )
+
+
 @expect(messages.Address, field="address", ret_type=str)
 def get_address(*args: Any, **kwargs: Any):
     return get_authenticated_address(*args, **kwargs)
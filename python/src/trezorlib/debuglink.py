@@ -259,6 +259,24 @@ class DebugLink:
         """
         self._call(messages.DebugLinkWatchLayout(watch=watch))
 
+    def get_profile(self, reset: bool = False) -> messages.DebugLinkProfile:
+        """Read the time spent in profiled sections, per message type.
+
+        Only DEBUG_LINK builds of T1 support this. The pages of entries sent by the
+        device are joined into one response. Divide cycle counts by `cycles_per_us`
+        to get microseconds; it is 0 if the device cannot count cycles.
+        """
+        entries: List[messages.DebugLinkProfileEntry] = []
+        while True:
+            profile = self._call(
+                messages.DebugLinkGetProfile(offset=len(entries), reset=reset)
+            )
+            assert isinstance(profile, messages.DebugLinkProfile)
+            entries.extend(profile.entries)
+            if not profile.more:
+                profile.entries = entries
+                return profile
+
     def encode_pin(self, pin: str, matrix: Optional[str] = None) -> str:
         """Transform correct PIN according to the displayed matrix."""
         if matrix is None:
@@ -14,7 +14,7 @@
 # You should have received a copy of the License along with this library.
 # If not, see <https://www.gnu.org/licenses/lgpl-3.0.html>.
 
-from typing import TYPE_CHECKING, Sequence
+from typing import TYPE_CHECKING, List, Optional, Sequence
 
 from . import messages
 from .tools import expect
@@ -79,3 +79,48 @@ def sign_tx(
     else:
         raise ValueError("Invalid response")
     return signatures
+
+
+def sign_transaction(
+    client: "TrezorClient",
+    inputs: Sequence[messages.KaspaTxAckInput],
+    outputs: Sequence[messages.KaspaTxAckOutput],
+    prefix: str = "kaspa",
+    schema: str = "schnorr",
+    version: int = 0,
+    lock_time: int = 0,
+) -> Sequence[bytes]:
+    """Sign a transaction whose sighashes are computed on the device.
+
+    Inputs are sent twice, first to confirm the transaction and then to sign
+    it, so the device only keeps the running hashes of the transaction.
+    """
+    signatures: List[Optional[bytes]] = [None] * len(inputs)
+    resp = client.call(
+        messages.KaspaSignTxInit(
+            inputs_count=len(inputs),
+            outputs_count=len(outputs),
+            prefix=prefix,
+            schema=schema,
+            version=version,
+            lock_time=lock_time,
+        )
+    )
+    while isinstance(resp, messages.KaspaTxRequest):
+        if resp.signature is not None and resp.signature_index is not None:
+            signatures[resp.signature_index] = resp.signature
+        if resp.request_type == messages.KaspaRequestType.TXFINISHED:
+            break
+        assert resp.request_index is not None
+        if resp.request_type == messages.KaspaRequestType.TXINPUT:
+            resp = client.call(inputs[resp.request_index])
+        elif resp.request_type == messages.KaspaRequestType.TXOUTPUT:
+            resp = client.call(outputs[resp.request_index])
+        else:
+            raise ValueError("Unknown request type")
+    else:
+        raise ValueError("Invalid response")
+
+    if any(sig is None for sig in signatures):
+        raise ValueError("Some inputs were not signed")
+    return signatures  # type: ignore [return-value]
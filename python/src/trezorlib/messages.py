@@ -125,6 +125,8 @@ class MessageType(IntEnum):
     DebugLinkRecordScreen = 9003
     DebugLinkEraseSdCard = 9005
     DebugLinkWatchLayout = 9006
+    DebugLinkGetProfile = 9100
+    DebugLinkProfile = 9101
     EthereumGetPublicKey = 450
     EthereumPublicKey = 451
     EthereumGetAddress = 56
@@ -358,6 +360,10 @@ class MessageType(IntEnum):
     KaspaSignedTx = 11303
     KaspaTxInputRequest = 11304
     KaspaTxInputAck = 11305
+    KaspaSignTxInit = 11306
+    KaspaTxRequest = 11307
+    KaspaTxAckInput = 11308
+    KaspaTxAckOutput = 11309
     NexaGetAddress = 11400
     NexaAddress = 11401
     NexaSignTx = 11402
@@ -665,6 +671,16 @@ class DebugButton(IntEnum):
     INFO = 2
 
 
+class DebugLinkProfileSection(IntEnum):
+    SE = 0
+    HASH = 1
+    ECC = 2
+    DECODE = 3
+    ENCODE = 4
+    USB = 5
+    DISPLAY = 6
+
+
 class EthereumDefinitionType(IntEnum):
     NETWORK = 0
     TOKEN = 1
@@ -692,6 +708,12 @@ class EthereumDataType(IntEnum):
     STRUCT = 8
 
 
+class KaspaRequestType(IntEnum):
+    TXINPUT = 0
+    TXOUTPUT = 1
+    TXFINISHED = 2
+
+
 class MoneroNetworkType(IntEnum):
     MAINNET = 0
     TESTNET = 1
@@ -4982,6 +5004,19 @@ class DebugLinkState(protobuf.MessageType):
         11: protobuf.Field("reset_word_pos", "uint32", repeated=False, required=False, default=None),
         12: protobuf.Field("mnemonic_type", "BackupType", repeated=False, required=False, default=None),
         13: protobuf.Field("layout_lines", "string", repeated=True, required=False, default=None),
+        14: protobuf.Field("signing_hash_ms", "uint32", repeated=False, required=False, default=None),
+        15: protobuf.Field("signing_confirm_ms", "uint32", repeated=False, required=False, default=None),
+        16: protobuf.Field("signing_check_ms", "uint32", repeated=False, required=False, default=None),
+        17: protobuf.Field("signing_sign_ms", "uint32", repeated=False, required=False, default=None),
+        18: protobuf.Field("signing_derivations", "uint32", repeated=False, required=False, default=None),
+        19: protobuf.Field("signing_derivations_reused", "uint32", repeated=False, required=False, default=None),
+        20: protobuf.Field("usb_packets_in", "uint32", repeated=False, required=False, default=None),
+        21: protobuf.Field("usb_packets_out", "uint32", repeated=False, required=False, default=None),
+        22: protobuf.Field("usb_packets_in_per_sec", "uint32", repeated=False, required=False, default=None),
+        23: protobuf.Field("usb_packets_out_per_sec", "uint32", repeated=False, required=False, default=None),
+        24: protobuf.Field("signing_prevtxs_reused", "uint32", repeated=False, required=False, default=None),
+        25: protobuf.Field("address_qr_encodes", "uint32", repeated=False, required=False, default=None),
+        26: protobuf.Field("address_qr_columns", "uint32", repeated=False, required=False, default=None),
     }
 
     def __init__(
@@ -5000,6 +5035,19 @@ class DebugLinkState(protobuf.MessageType):
         recovery_word_pos: Optional["int"] = None,
         reset_word_pos: Optional["int"] = None,
         mnemonic_type: Optional["BackupType"] = None,
+        signing_hash_ms: Optional["int"] = None,
+        signing_confirm_ms: Optional["int"] = None,
+        signing_check_ms: Optional["int"] = None,
+        signing_sign_ms: Optional["int"] = None,
+        signing_derivations: Optional["int"] = None,
+        signing_derivations_reused: Optional["int"] = None,
+        usb_packets_in: Optional["int"] = None,
+        usb_packets_out: Optional["int"] = None,
+        usb_packets_in_per_sec: Optional["int"] = None,
+        usb_packets_out_per_sec: Optional["int"] = None,
+        signing_prevtxs_reused: Optional["int"] = None,
+        address_qr_encodes: Optional["int"] = None,
+        address_qr_columns: Optional["int"] = None,
     ) -> None:
         self.layout_lines: Sequence["str"] = layout_lines if layout_lines is not None else []
         self.layout = layout
@@ -5014,6 +5062,19 @@ class DebugLinkState(protobuf.MessageType):
         self.recovery_word_pos = recovery_word_pos
         self.reset_word_pos = reset_word_pos
         self.mnemonic_type = mnemonic_type
+        self.signing_hash_ms = signing_hash_ms
+        self.signing_confirm_ms = signing_confirm_ms
+        self.signing_check_ms = signing_check_ms
+        self.signing_sign_ms = signing_sign_ms
+        self.signing_derivations = signing_derivations
+        self.signing_derivations_reused = signing_derivations_reused
+        self.usb_packets_in = usb_packets_in
+        self.usb_packets_out = usb_packets_out
+        self.usb_packets_in_per_sec = usb_packets_in_per_sec
+        self.usb_packets_out_per_sec = usb_packets_out_per_sec
+        self.signing_prevtxs_reused = signing_prevtxs_reused
+        self.address_qr_encodes = address_qr_encodes
+        self.address_qr_columns = address_qr_columns
 
 
 class DebugLinkStop(protobuf.MessageType):
@@ -5133,6 +5194,72 @@ class DebugLinkWatchLayout(protobuf.MessageType):
         self.watch = watch
 
 
+class DebugLinkGetProfile(protobuf.MessageType):
+    MESSAGE_WIRE_TYPE = 9100
+    FIELDS = {
+        1: protobuf.Field("offset", "uint32", repeated=False, required=False, default=None),
+        2: protobuf.Field("reset", "bool", repeated=False, required=False, default=None),
+    }
+
+    def __init__(
+        self,
+        *,
+        offset: Optional["int"] = None,
+        reset: Optional["bool"] = None,
+    ) -> None:
+        self.offset = offset
+        self.reset = reset
+
+
+class DebugLinkProfile(protobuf.MessageType):
+    MESSAGE_WIRE_TYPE = 9101
+    FIELDS = {
+        1: protobuf.Field("cycles_per_us", "uint32", repeated=False, required=True),
+        2: protobuf.Field("entries", "DebugLinkProfileEntry", repeated=True, required=False, default=None),
+        3: protobuf.Field("more", "bool", repeated=False, required=False, default=None),
+    }
+
+    def __init__(
+        self,
+        *,
+        cycles_per_us: "int",
+        entries: Optional[Sequence["DebugLinkProfileEntry"]] = None,
+        more: Optional["bool"] = None,
+    ) -> None:
+        self.entries: Sequence["DebugLinkProfileEntry"] = entries if entries is not None else []
+        self.cycles_per_us = cycles_per_us
+        self.more = more
+
+
+class DebugLinkProfileEntry(protobuf.MessageType):
+    MESSAGE_WIRE_TYPE = None
+    FIELDS = {
+        1: protobuf.Field("message_type", "uint32", repeated=False, required=True),
+        2: protobuf.Field("section", "DebugLinkProfileSection", repeated=False, required=True),
+        3: protobuf.Field("count", "uint32", repeated=False, required=True),
+        4: protobuf.Field("total_cycles", "uint64", repeated=False, required=True),
+        5: protobuf.Field("max_cycles", "uint32", repeated=False, required=True),
+        6: protobuf.Field("histogram", "uint32", repeated=True, required=False, default=None),
+    }
+
+    def __init__(
+        self,
+        *,
+        message_type: "int",
+        section: "DebugLinkProfileSection",
+        count: "int",
+        total_cycles: "int",
+        max_cycles: "int",
+        histogram: Optional[Sequence["int"]] = None,
+    ) -> None:
+        self.histogram: Sequence["int"] = histogram if histogram is not None else []
+        self.message_type = message_type
+        self.section = section
+        self.count = count
+        self.total_cycles = total_cycles
+        self.max_cycles = max_cycles
+
+
 class EosGetPublicKey(protobuf.MessageType):
     MESSAGE_WIRE_TYPE = 600
     FIELDS = {
@@ -6838,6 +6965,103 @@ class KaspaSignedTx(protobuf.MessageType):
         self.signature = signature
 
 
+class KaspaSignTxInit(protobuf.MessageType):
+    MESSAGE_WIRE_TYPE = 11306
+    FIELDS = {
+        1: protobuf.Field("inputs_count", "uint32", repeated=False, required=True),
+        2: protobuf.Field("outputs_count", "uint32", repeated=False, required=True),
+        3: protobuf.Field("schema", "string", repeated=False, required=False, default='schnorr'),
+        4: protobuf.Field("prefix", "string", repeated=False, required=False, default='kaspa'),
+        5: protobuf.Field("version", "uint32", repeated=False, required=False, default=0),
+        6: protobuf.Field("lock_time", "uint64", repeated=False, required=False, default=0),
+    }
+
+    def __init__(
+        self,
+        *,
+        inputs_count: "int",
+        outputs_count: "int",
+        schema: Optional["str"] = 'schnorr',
+        prefix: Optional["str"] = 'kaspa',
+        version: Optional["int"] = 0,
+        lock_time: Optional["int"] = 0,
+    ) -> None:
+        self.inputs_count = inputs_count
+        self.outputs_count = outputs_count
+        self.schema = schema
+        self.prefix = prefix
+        self.version = version
+        self.lock_time = lock_time
+
+
+class KaspaTxRequest(protobuf.MessageType):
+    MESSAGE_WIRE_TYPE = 11307
+    FIELDS = {
+        1: protobuf.Field("request_type", "KaspaRequestType", repeated=False, required=True),
+        2: protobuf.Field("request_index", "uint32", repeated=False, required=False, default=None),
+        3: protobuf.Field("signature_index", "uint32", repeated=False, required=False, default=None),
+        4: protobuf.Field("signature", "bytes", repeated=False, required=False, default=None),
+    }
+
+    def __init__(
+        self,
+        *,
+        request_type: "KaspaRequestType",
+        request_index: Optional["int"] = None,
+        signature_index: Optional["int"] = None,
+        signature: Optional["bytes"] = None,
+    ) -> None:
+        self.request_type = request_type
+        self.request_index = request_index
+        self.signature_index = signature_index
+        self.signature = signature
+
+
+class KaspaTxAckInput(protobuf.MessageType):
+    MESSAGE_WIRE_TYPE = 11308
+    FIELDS = {
+        1: protobuf.Field("address_n", "uint32", repeated=True, required=False, default=None),
+        2: protobuf.Field("prev_hash", "bytes", repeated=False, required=True),
+        3: protobuf.Field("prev_index", "uint32", repeated=False, required=True),
+        4: protobuf.Field("amount", "uint64", repeated=False, required=True),
+        5: protobuf.Field("sequence", "uint64", repeated=False, required=False, default=0),
+        6: protobuf.Field("sig_op_count", "uint32", repeated=False, required=False, default=1),
+    }
+
+    def __init__(
+        self,
+        *,
+        prev_hash: "bytes",
+        prev_index: "int",
+        amount: "int",
+        address_n: Optional[Sequence["int"]] = None,
+        sequence: Optional["int"] = 0,
+        sig_op_count: Optional["int"] = 1,
+    ) -> None:
+        self.address_n: Sequence["int"] = address_n if address_n is not None else []
+        self.prev_hash = prev_hash
+        self.prev_index = prev_index
+        self.amount = amount
+        self.sequence = sequence
+        self.sig_op_count = sig_op_count
+
+
+class KaspaTxAckOutput(protobuf.MessageType):
+    MESSAGE_WIRE_TYPE = 11309
+    FIELDS = {
+        1: protobuf.Field("amount", "uint64", repeated=False, required=True),
+        2: protobuf.Field("address", "string", repeated=False, required=True),
+    }
+
+    def __init__(
+        self,
+        *,
+        amount: "int",
+        address: "str",
+    ) -> None:
+        self.amount = amount
+        self.address = address
+
 class LnurlAuth(protobuf.MessageType):
     MESSAGE_WIRE_TYPE = 11600
     FIELDS = {
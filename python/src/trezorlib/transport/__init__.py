@@ -115,12 +115,14 @@ class Transport:
 def all_transports() -> Iterable[Type["Transport"]]:
     from .bridge import BridgeTransport
     from .hid import HidTransport
+    from .stream import StreamTransport
     from .udp import UdpTransport
     from .webusb import WebUsbTransport
 
     transports: Tuple[Type["Transport"], ...] = (
         BridgeTransport,
         HidTransport,
+        StreamTransport,
         UdpTransport,
         WebUsbTransport,
     )
@@ -0,0 +1,148 @@
+# This file is part of the Trezor project.
+#
+# Copyright (C) 2012-2022 SatoshiLabs and contributors
+#
+# This library is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License version 3
+# as published by the Free Software Foundation.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the License along with this library.
+# If not, see <https://www.gnu.org/licenses/lgpl-3.0.html>.
+
+import logging
+import socket
+import struct
+from typing import TYPE_CHECKING, Any, Iterable, Optional
+
+from ..log import DUMP_PACKETS
+from . import MessagePayload, TransportException
+from .protocol import Protocol, ProtocolBasedTransport
+
+if TYPE_CHECKING:
+    from ..models import TrezorModel
+
+SOCKET_TIMEOUT = 10
+
+LOG = logging.getLogger(__name__)
+
+
+class ProtocolStream(Protocol):
+    """Whole messages over a reliable byte stream, as served by the legacy
+    emulator with TREZOR_TRANSPORT=tcp or TREZOR_TRANSPORT=unix:PATH.
+
+    Each message is sent as "##" + msg_type + length + data, without splitting it
+    into 64-byte reports.
+    """
+
+    HEADER = ">2sHL"
+    HEADER_LEN = struct.calcsize(HEADER)
+
+    handle: "StreamTransport"
+
+    def write(self, message_type: int, message_data: bytes) -> None:
+        header = struct.pack(self.HEADER, b"##", message_type, len(message_data))
+        self.handle.write_bytes(header + message_data)
+
+    def read(self) -> MessagePayload:
+        header = self.handle.read_bytes(self.HEADER_LEN)
+        magic, msg_type, datalen = struct.unpack(self.HEADER, header)
+        if magic != b"##":
+            raise RuntimeError("Unexpected magic characters")
+        return msg_type, self.handle.read_bytes(datalen)
+
+
+class StreamTransport(ProtocolBasedTransport):
+    """Stream connection to the legacy emulator.
+
+    Paths are "stream:tcp:HOST:PORT" or "stream:unix:PATH". The debug link is
+    served on the next port, or on PATH.debug.
+    """
+
+    DEFAULT_HOST = "127.0.0.1"
+    DEFAULT_PORT = 54935
+    PATH_PREFIX = "stream"
+    ENABLED: bool = True
+
+    def __init__(self, device: Optional[str] = None) -> None:
+        if not device:
+            device = f"tcp:{self.DEFAULT_HOST}:{self.DEFAULT_PORT}"
+        kind, _, address = device.partition(":")
+        if kind == "tcp":
+            host, _, port = address.partition(":")
+            self.family = socket.AF_INET
+            self.address: Any = (
+                host or self.DEFAULT_HOST,
+                int(port) if port else self.DEFAULT_PORT,
+            )
+        elif kind == "unix":
+            self.family = socket.AF_UNIX
+            self.address = address
+        else:
+            raise TransportException(f"Unknown stream transport: {device}")
+        self.device = device
+        self.socket: Optional[socket.socket] = None
+
+        super().__init__(protocol=ProtocolStream(self))
+
+    def get_path(self) -> str:
+        return f"{self.PATH_PREFIX}:{self.device}"
+
+    def find_debug(self) -> "StreamTransport":
+        if self.family == socket.AF_UNIX:
+            return StreamTransport(f"unix:{self.address}.debug")
+        host, port = self.address
+        return StreamTransport(f"tcp:{host}:{port + 1}")
+
+    @classmethod
+    def enumerate(
+        cls, _models: Optional[Iterable["TrezorModel"]] = None
+    ) -> Iterable["StreamTransport"]:
+        # stream transports are only used when requested explicitly
+        return []
+
+    @classmethod
+    def find_by_path(cls, path: str, prefix_search: bool = False) -> "StreamTransport":
+        d = cls(path.replace(f"{cls.PATH_PREFIX}:", "", 1))
+        try:
+            d.open()
+        except OSError as e:
+            raise TransportException(f"No stream device at {path}") from e
+        finally:
+            d.close()
+        return d
+
+    def open(self) -> None:
+        self.socket = socket.socket(self.family, socket.SOCK_STREAM)
+        self.socket.settimeout(SOCKET_TIMEOUT)
+        self.socket.connect(self.address)
+        if self.family == socket.AF_INET:
+            self.socket.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+
+    def close(self) -> None:
+        if self.socket is not None:
+            self.socket.close()
+        self.socket = None
+
+    def write_bytes(self, data: bytes) -> None:
+        assert self.socket is not None
+        LOG.log(DUMP_PACKETS, f"sending message: {data.hex()}")
+        self.socket.sendall(data)
+
+    def read_bytes(self, size: int) -> bytes:
+        assert self.socket is not None
+        buffer = bytearray()
+        while len(buffer) < size:
+            try:
+                chunk = self.socket.recv(size - len(buffer))
+            except socket.timeout:
+                continue
+            if not chunk:
+                raise TransportException("Connection closed")
+            buffer.extend(chunk)
+        LOG.log(DUMP_PACKETS, f"received message: {buffer.hex()}")
+        return bytes(buffer)
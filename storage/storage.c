@@ -171,6 +171,11 @@ static uint8_t cached_keys[KEYS_SIZE] = {0};
 static uint8_t *const cached_dek = cached_keys;
 static uint8_t *const cached_sak = cached_keys + DEK_SIZE;
 static uint8_t authentication_sum[SHA256_DIGEST_LENGTH] = {0};
+// The storage authentication tag that matches authentication_sum. Both are
+// valid while authentication_verified is sectrue, that is from the first
+// read after unlocking until the storage is locked again.
+static uint8_t authentication_tag[STORAGE_TAG_SIZE] = {0};
+static secbool authentication_verified = secfalse;
 static uint8_t hardware_salt[HARDWARE_SALT_SIZE] = {0};
 static uint32_t norcow_active_version = 0;
 static const uint8_t TRUE_BYTE = 0x01;
@@ -190,6 +195,7 @@ static secbool storage_set_encrypted(const uint16_t key, const void *val,
                                      const uint16_t len);
 static secbool storage_get_encrypted(const uint16_t key, void *val_dest,
                                      const uint16_t max_len, uint16_t *len);
+static secbool auth_scan(uint16_t key, const void **val, uint16_t *len);
 
 static secbool secequal(const void *ptr1, const void *ptr2, size_t n) {
   const uint8_t *p1 = ptr1;
@@ -240,6 +246,30 @@ static secbool is_protected(uint16_t key) {
   return ((app & FLAG_PUBLIC) == 0 && app != APP_STORAGE) ? sectrue : secfalse;
 }
 
+/*
+ * Forget the verified storage authentication tag, so that the next read
+ * verifies all protected entries again.
+ */
+static void auth_clear(void) {
+  authentication_verified = secfalse;
+  memzero(authentication_sum, sizeof(authentication_sum));
+  memzero(authentication_tag, sizeof(authentication_tag));
+}
+
+/*
+ * Store the storage authentication tag computed from authentication_sum.
+ */
+static secbool auth_store_tag(const uint8_t *tag) {
+  secbool ret = norcow_set(STORAGE_TAG_KEY, tag, STORAGE_TAG_SIZE);
+  if (sectrue == ret) {
+    memcpy(authentication_tag, tag, STORAGE_TAG_SIZE);
+    authentication_verified = sectrue;
+  } else {
+    auth_clear();
+  }
+  return ret;
+}
+
 /*
  * Initialize the storage authentication tag for freshly wiped storage.
  */
@@ -248,7 +278,7 @@ static secbool auth_init(void) {
   memzero(authentication_sum, sizeof(authentication_sum));
   hmac_sha256(cached_sak, SAK_SIZE, authentication_sum,
               sizeof(authentication_sum), tag);
-  return norcow_set(STORAGE_TAG_KEY, tag, STORAGE_TAG_SIZE);
+  return auth_store_tag(tag);
 }
 
 /*
@@ -266,7 +296,19 @@ static secbool auth_update(uint16_t key) {
   }
   hmac_sha256(cached_sak, SAK_SIZE, authentication_sum,
               sizeof(authentication_sum), tag);
-  return norcow_set(STORAGE_TAG_KEY, tag, STORAGE_TAG_SIZE);
+  return auth_store_tag(tag);
+}
+
+/*
+ * Make sure authentication_sum is known before a protected key is added or
+ * removed, so that auth_update() can fold the key into it.
+ */
+static void auth_verify(uint16_t key) {
+  if (sectrue == is_protected(key) && sectrue != authentication_verified) {
+    const void *val = NULL;
+    uint16_t len = 0;
+    auth_scan(STORAGE_TAG_KEY, &val, &len);
+  }
 }
 
 /*
@@ -274,6 +316,7 @@ static secbool auth_update(uint16_t key) {
  * tag.
  */
 static secbool auth_set(uint16_t key, const void *val, uint16_t len) {
+  auth_verify(key);
   secbool found = secfalse;
   secbool ret = norcow_set_ex(key, val, len, &found);
   if (sectrue == ret && secfalse == found) {
@@ -286,10 +329,10 @@ static secbool auth_set(uint16_t key, const void *val, uint16_t len) {
 }
 
 /*
- * A secure version of norcow_get(), which checks the storage authentication
- * tag.
+ * Walk all entries to find the given key, recompute authentication_sum from
+ * the protected ones and check it against the storage authentication tag.
  */
-static secbool auth_get(uint16_t key, const void **val, uint16_t *len) {
+static secbool auth_scan(uint16_t key, const void **val, uint16_t *len) {
   *val = NULL;
   *len = 0;
   uint32_t sum[SHA256_DIGEST_LENGTH / sizeof(uint32_t)] = {0};
@@ -368,6 +411,9 @@ static secbool auth_get(uint16_t key, const void **val, uint16_t *len) {
   if (tag_val == NULL || tag_len != STORAGE_TAG_SIZE ||
       sectrue != secequal(h, tag_val, STORAGE_TAG_SIZE)) {
     handle_fault("storage tag check");
+  } else {
+    memcpy(authentication_tag, h, STORAGE_TAG_SIZE);
+    authentication_verified = sectrue;
   }
 
   if (*val == NULL) {
@@ -380,6 +426,34 @@ static secbool auth_get(uint16_t key, const void **val, uint16_t *len) {
   return sectrue;
 }
 
+/*
+ * A secure version of norcow_get(), which checks the storage authentication
+ * tag. All protected entries are authenticated on the first read after
+ * unlocking, later reads only compare the stored tag with the verified one.
+ */
+static secbool auth_get(uint16_t key, const void **val, uint16_t *len) {
+  if (sectrue != authentication_verified) {
+    return auth_scan(key, val, len);
+  }
+
+  // If the check above is skipped by a fault, authentication_tag is all zeros
+  // and does not match the stored tag.
+  const void *tag_val = NULL;
+  uint16_t tag_len = 0;
+  if (sectrue != norcow_get(STORAGE_TAG_KEY, &tag_val, &tag_len) ||
+      tag_len != STORAGE_TAG_SIZE ||
+      sectrue != secequal(authentication_tag, tag_val, STORAGE_TAG_SIZE)) {
+    handle_fault("storage tag check");
+  }
+
+  if (sectrue != norcow_get(key, val, len)) {
+    // A protected entry removed from the flash would leave the tag unchanged,
+    // so a missing entry is checked against all of them.
+    return auth_scan(key, val, len);
+  }
+  return sectrue;
+}
+
 static secbool set_wipe_code(const uint8_t *wipe_code, size_t wipe_code_len) {
   if (wipe_code_len > MAX_WIPE_CODE_LEN ||
       wipe_code_len > UINT16_MAX - WIPE_CODE_SALT_SIZE - WIPE_CODE_TAG_SIZE) {
@@ -888,7 +962,7 @@ secbool storage_is_unlocked(void) {
 void storage_lock(void) {
   unlocked = secfalse;
   memzero(cached_keys, sizeof(cached_keys));
-  memzero(authentication_sum, sizeof(authentication_sum));
+  auth_clear();
 }
 
 // Returns the storage version that was used to lock the storage.
@@ -988,6 +1062,7 @@ static secbool decrypt_dek(const uint8_t *kek, const uint8_t *keiv) {
     return secfalse;
   }
   memcpy(cached_keys, keys, sizeof(keys));
+  auth_clear();
   memzero(keys, sizeof(keys));
   memzero(tag, sizeof(tag));
   return sectrue;
@@ -1107,8 +1182,9 @@ static secbool unlock(const uint8_t *pin, size_t pin_len,
   // Check for storage upgrades that need to be performed after unlocking and
   // check that the authenticated version number matches the unauthenticated
   // version and norcow version.
-  // NOTE: This also initializes the authentication_sum by calling
-  // storage_get_encrypted() which calls auth_get().
+  // NOTE: This also verifies the storage authentication tag and initializes
+  // the authentication_sum by calling storage_get_encrypted() which calls
+  // auth_get().
   if (sectrue != storage_upgrade_unlocked(pin, pin_len, ext_salt) ||
       sectrue != check_storage_version()) {
     return secfalse;
@@ -1316,6 +1392,7 @@ secbool storage_delete(const uint16_t key) {
   if (sectrue != unlocked && (app & FLAGS_WRITE) != FLAGS_WRITE) {
     return secfalse;
   }
+  auth_verify(key);
   secbool ret = norcow_delete(key);
   if (sectrue == ret) {
     ret = auth_update(key);
@@ -1481,7 +1558,7 @@ secbool storage_change_wipe_code(const uint8_t *pin, size_t pin_len,
 void storage_wipe(void) {
   norcow_wipe();
   norcow_active_version = NORCOW_VERSION;
-  memzero(authentication_sum, sizeof(authentication_sum));
+  auth_clear();
   memzero(cached_keys, sizeof(cached_keys));
   init_wiped_storage();
 }
@@ -1659,6 +1736,7 @@ static secbool storage_upgrade(void) {
 
     unlocked = secfalse;
     memzero(cached_keys, sizeof(cached_keys));
+    auth_clear();
   } else {
     // Copy all entries.
     uint32_t offset = 0;
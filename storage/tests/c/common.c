@@ -17,12 +17,27 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "common.h"
 
+// The library is linked with --wrap=sha256_Transform, so that the tests can
+// count the SHA-256 compressions done outside of sha2.c, e.g. by the storage
+// authentication.
+uint32_t sha256_transform_count = 0;
+
+void __real_sha256_Transform(const uint32_t *state_in, const uint32_t *data,
+                             uint32_t *state_out);
+
+void __wrap_sha256_Transform(const uint32_t *state_in, const uint32_t *data,
+                             uint32_t *state_out) {
+  sha256_transform_count++;
+  __real_sha256_Transform(state_in, data, state_out);
+}
+
 void __shutdown(void) {
   printf("SHUTDOWN\n");
   exit(3);
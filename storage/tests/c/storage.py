@@ -85,6 +85,9 @@ class Storage:
     def delete(self, key: int) -> bool:
         return sectrue == self.lib.storage_delete(c.c_uint16(key))
 
+    def _sha256_transform_count(self) -> int:
+        return c.c_uint32.in_dll(self.lib, "sha256_transform_count").value
+
     def _dump(self) -> bytes:
         # return just sectors 4 and 16 of the whole flash
         return [
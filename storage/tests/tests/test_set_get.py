@@ -104,6 +104,33 @@ def test_chacha_strings():
             assert s.get(0x0301 + i) == string
 
 
+def test_get_cost():
+    # The storage is authenticated once after unlocking, so the SHA-256 work of
+    # reading an entry does not grow with the number of entries.
+    sc, sp = common.init(unlock=True)
+    for s in (sc, sp):
+        s.set(0x0101, b"first")
+
+    def read_cost() -> int:
+        count = sc._sha256_transform_count()
+        assert sc.get(0x0101) == b"first"
+        return sc._sha256_transform_count() - count
+
+    cost = read_cost()
+    for s in (sc, sp):
+        for i in range(50):
+            s.set(0x0201 + i, b"entry %d" % i)
+    assert common.memory_equals(sc, sp)
+    assert read_cost() == cost
+
+    for s in (sc, sp):
+        s.lock()
+        assert s.unlock("")
+        for i in range(50):
+            assert s.get(0x0201 + i) == b"entry %d" % i
+    assert read_cost() == cost
+
+
 def test_set_repeated():
     test_strings = [[0x0501, b""], [0x0502, b"test"], [0x8501, b""], [0x8502, b"test"]]
     sc, sp = common.init(unlock=True)
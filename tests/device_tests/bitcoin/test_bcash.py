@@ -354,7 +354,7 @@ def test_send_bch_multisig_wrongchange(client: Client):
                 request_finished(),
             ]
         )
-        (signatures1, serialized_tx) = btc.sign_tx(
+        signatures1, serialized_tx = btc.sign_tx(
             client, "Bcash", [inp1], [out1], prev_txes=TX_API
         )
     assert (
@@ -404,28 +404,31 @@ def test_send_bch_multisig_change(client: Client):
         script_type=messages.OutputScriptType.PAYTOMULTISIG,
         amount=24_000,
     )
+
+    tt = client.features.model == "T"
+
+    def expected_responses(prev_tx_requested: bool):
+        return [
+            request_input(0),
+            request_output(0),
+            messages.ButtonRequest(code=B.ConfirmOutput),
+            (tt, messages.ButtonRequest(code=B.ConfirmOutput)),
+            request_output(1),
+            messages.ButtonRequest(code=B.SignTx),
+            (tt, messages.ButtonRequest(code=B.SignTx)),
+            request_input(0),
+            (prev_tx_requested, request_meta(FAKE_TXHASH_203416)),
+            (prev_tx_requested, request_input(0, FAKE_TXHASH_203416)),
+            (prev_tx_requested, request_output(0, FAKE_TXHASH_203416)),
+            request_input(0),
+            request_output(0),
+            request_output(1),
+            request_finished(),
+        ]
+
     with client:
-        tt = client.features.model == "T"
-        client.set_expected_responses(
-            [
-                request_input(0),
-                request_output(0),
-                messages.ButtonRequest(code=B.ConfirmOutput),
-                (tt, messages.ButtonRequest(code=B.ConfirmOutput)),
-                request_output(1),
-                messages.ButtonRequest(code=B.SignTx),
-                (tt, messages.ButtonRequest(code=B.SignTx)),
-                request_input(0),
-                request_meta(FAKE_TXHASH_203416),
-                request_input(0, FAKE_TXHASH_203416),
-                request_output(0, FAKE_TXHASH_203416),
-                request_input(0),
-                request_output(0),
-                request_output(1),
-                request_finished(),
-            ]
-        )
-        (signatures1, serialized_tx) = btc.sign_tx(
+        client.set_expected_responses(expected_responses(True))
+        signatures1, serialized_tx = btc.sign_tx(
             client, "Bcash", [inp1], [out1, out2], prev_txes=TX_API
         )
 
@@ -445,29 +448,15 @@ def test_send_bch_multisig_change(client: Client):
     )
     out2.address_n[2] = H_(1)
 
+    # The T1 remembers the previous output verified in the first signing, as
+    # the redeem script and so the scriptPubKey are the same.
     with client:
-        client.set_expected_responses(
-            [
-                request_input(0),
-                request_output(0),
-                messages.ButtonRequest(code=B.ConfirmOutput),
-                (tt, messages.ButtonRequest(code=B.ConfirmOutput)),
-                request_output(1),
-                messages.ButtonRequest(code=B.SignTx),
-                (tt, messages.ButtonRequest(code=B.SignTx)),
-                request_input(0),
-                request_meta(FAKE_TXHASH_203416),
-                request_input(0, FAKE_TXHASH_203416),
-                request_output(0, FAKE_TXHASH_203416),
-                request_input(0),
-                request_output(0),
-                request_output(1),
-                request_finished(),
-            ]
-        )
-        (signatures1, serialized_tx) = btc.sign_tx(
+        client.set_expected_responses(expected_responses(tt))
+        signatures1, serialized_tx = btc.sign_tx(
             client, "Bcash", [inp1], [out1, out2], prev_txes=TX_API
         )
+    if not tt:
+        assert client.debug.state().signing_prevtxs_reused == 1
 
     assert (
         signatures1[0].hex()
@@ -259,28 +259,31 @@ def test_send_btg_multisig_change(client: Client):
         script_type=messages.OutputScriptType.PAYTOMULTISIG,
         amount=1_252_382_934 - 24_000 - 1_000,
     )
+
+    tt = client.features.model == "T"
+
+    def expected_responses(prev_tx_requested: bool):
+        return [
+            request_input(0),
+            request_output(0),
+            messages.ButtonRequest(code=B.ConfirmOutput),
+            (tt, messages.ButtonRequest(code=B.ConfirmOutput)),
+            request_output(1),
+            messages.ButtonRequest(code=B.SignTx),
+            (tt, messages.ButtonRequest(code=B.SignTx)),
+            request_input(0),
+            (prev_tx_requested, request_meta(FAKE_TXHASH_a63dbe)),
+            (prev_tx_requested, request_input(0, FAKE_TXHASH_a63dbe)),
+            (prev_tx_requested, request_output(0, FAKE_TXHASH_a63dbe)),
+            (prev_tx_requested, request_output(1, FAKE_TXHASH_a63dbe)),
+            request_input(0),
+            request_output(0),
+            request_output(1),
+            request_finished(),
+        ]
+
     with client:
-        tt = client.features.model == "T"
-        client.set_expected_responses(
-            [
-                request_input(0),
-                request_output(0),
-                messages.ButtonRequest(code=B.ConfirmOutput),
-                (tt, messages.ButtonRequest(code=B.ConfirmOutput)),
-                request_output(1),
-                messages.ButtonRequest(code=B.SignTx),
-                (tt, messages.ButtonRequest(code=B.SignTx)),
-                request_input(0),
-                request_meta(FAKE_TXHASH_a63dbe),
-                request_input(0, FAKE_TXHASH_a63dbe),
-                request_output(0, FAKE_TXHASH_a63dbe),
-                request_output(1, FAKE_TXHASH_a63dbe),
-                request_input(0),
-                request_output(0),
-                request_output(1),
-                request_finished(),
-            ]
-        )
+        client.set_expected_responses(expected_responses(True))
         signatures, serialized_tx = btc.sign_tx(
             client, "Bgold", [inp1], [out1, out2], prev_txes=TX_API
         )
@@ -300,30 +303,15 @@ def test_send_btg_multisig_change(client: Client):
     )
     out2.address_n[2] = H_(1)
 
+    # The T1 remembers the previous output verified in the first signing, as
+    # the redeem script and so the scriptPubKey are the same.
     with client:
-        client.set_expected_responses(
-            [
-                request_input(0),
-                request_output(0),
-                messages.ButtonRequest(code=B.ConfirmOutput),
-                (tt, messages.ButtonRequest(code=B.ConfirmOutput)),
-                request_output(1),
-                messages.ButtonRequest(code=B.SignTx),
-                (tt, messages.ButtonRequest(code=B.SignTx)),
-                request_input(0),
-                request_meta(FAKE_TXHASH_a63dbe),
-                request_input(0, FAKE_TXHASH_a63dbe),
-                request_output(0, FAKE_TXHASH_a63dbe),
-                request_output(1, FAKE_TXHASH_a63dbe),
-                request_input(0),
-                request_output(0),
-                request_output(1),
-                request_finished(),
-            ]
-        )
+        client.set_expected_responses(expected_responses(tt))
         signatures, serialized_tx = btc.sign_tx(
             client, "Bgold", [inp1], [out1, out2], prev_txes=TX_API
         )
+    if not tt:
+        assert client.debug.state().signing_prevtxs_reused == 1
 
     assert (
         signatures[0].hex()
@@ -472,54 +460,41 @@ def test_send_multisig_1(client: Client):
         script_type=messages.OutputScriptType.PAYTOADDRESS,
     )
 
+    tt = client.features.model == "T"
+
+    def expected_responses(prev_tx_requested: bool):
+        return [
+            request_input(0),
+            request_output(0),
+            messages.ButtonRequest(code=B.ConfirmOutput),
+            (tt, messages.ButtonRequest(code=B.ConfirmOutput)),
+            messages.ButtonRequest(code=B.SignTx),
+            (tt, messages.ButtonRequest(code=B.SignTx)),
+            request_input(0),
+            (prev_tx_requested, request_meta(FAKE_TXHASH_7f1f6b)),
+            (prev_tx_requested, request_input(0, FAKE_TXHASH_7f1f6b)),
+            (prev_tx_requested, request_output(0, FAKE_TXHASH_7f1f6b)),
+            (prev_tx_requested, request_output(1, FAKE_TXHASH_7f1f6b)),
+            request_input(0),
+            request_output(0),
+            request_input(0),
+            request_finished(),
+        ]
+
     with client:
-        tt = client.features.model == "T"
-        client.set_expected_responses(
-            [
-                request_input(0),
-                request_output(0),
-                messages.ButtonRequest(code=B.ConfirmOutput),
-                (tt, messages.ButtonRequest(code=B.ConfirmOutput)),
-                messages.ButtonRequest(code=B.SignTx),
-                (tt, messages.ButtonRequest(code=B.SignTx)),
-                request_input(0),
-                request_meta(FAKE_TXHASH_7f1f6b),
-                request_input(0, FAKE_TXHASH_7f1f6b),
-                request_output(0, FAKE_TXHASH_7f1f6b),
-                request_output(1, FAKE_TXHASH_7f1f6b),
-                request_input(0),
-                request_output(0),
-                request_input(0),
-                request_finished(),
-            ]
-        )
+        client.set_expected_responses(expected_responses(True))
         signatures, _ = btc.sign_tx(client, "Bgold", [inp1], [out1], prev_txes=TX_API)
         # store signature
         inp1.multisig.signatures[0] = signatures[0]
-        # sign with third key
+        # sign with third key, the T1 remembers the previous output verified
+        # in the first signing, as the redeem script is the same
         inp1.address_n[2] = H_(3)
-        client.set_expected_responses(
-            [
-                request_input(0),
-                request_output(0),
-                messages.ButtonRequest(code=B.ConfirmOutput),
-                (tt, messages.ButtonRequest(code=B.ConfirmOutput)),
-                messages.ButtonRequest(code=B.SignTx),
-                (tt, messages.ButtonRequest(code=B.SignTx)),
-                request_input(0),
-                request_meta(FAKE_TXHASH_7f1f6b),
-                request_input(0, FAKE_TXHASH_7f1f6b),
-                request_output(0, FAKE_TXHASH_7f1f6b),
-                request_output(1, FAKE_TXHASH_7f1f6b),
-                request_input(0),
-                request_output(0),
-                request_input(0),
-                request_finished(),
-            ]
-        )
+        client.set_expected_responses(expected_responses(tt))
         _, serialized_tx = btc.sign_tx(
             client, "Bgold", [inp1], [out1], prev_txes=TX_API
         )
+    if not tt:
+        assert client.debug.state().signing_prevtxs_reused == 1
 
     assert (
         tx_hash(serialized_tx).hex()
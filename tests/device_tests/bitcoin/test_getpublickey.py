@@ -171,3 +171,48 @@ def test_script_type(client: Client, script_type, xpub, xpub_ignored_magic):
         ignore_xpub_magic=True,
     )
     assert res.xpub == xpub_ignored_magic
+
+
+@pytest.mark.skip_t2
+def test_get_public_node_multiple(client: Client):
+    vectors = [v for v in VECTORS_BITCOIN if v[0] == "Bitcoin"]
+    paths = [path for _, _, path, _ in vectors]
+    xpubs = [xpub for _, _, _, xpub in vectors]
+    assert btc.get_public_node_multiple(client, paths, coin_name="Bitcoin") == xpubs
+    # answered from the session's cache the second time
+    assert btc.get_public_node_multiple(client, paths, coin_name="Bitcoin") == xpubs
+    for path, xpub in zip(paths, xpubs):
+        assert btc.get_public_node(client, path, coin_name="Bitcoin").xpub == xpub
+
+
+@pytest.mark.skip_t2
+@pytest.mark.parametrize("script_type, xpub, xpub_ignored_magic", VECTORS_SCRIPT_TYPES)
+def test_script_type_multiple(client: Client, script_type, xpub, xpub_ignored_magic):
+    paths = [parse_path("m/44h/0h/0")]
+    xpubs = btc.get_public_node_multiple(
+        client, paths, coin_name="Bitcoin", script_type=script_type
+    )
+    assert xpubs == [xpub]
+    xpubs = btc.get_public_node_multiple(
+        client,
+        paths,
+        coin_name="Bitcoin",
+        script_type=script_type,
+        ignore_xpub_magic=True,
+    )
+    assert xpubs == [xpub_ignored_magic]
+
+
+@pytest.mark.skip_t2
+@pytest.mark.setup_client(passphrase=True)
+def test_cache_session(client: Client):
+    path = parse_path("m/44h/0h/0h")
+    client.use_passphrase("")
+    xpub = btc.get_public_node(client, path, coin_name="Bitcoin").xpub
+    assert btc.get_public_node(client, path, coin_name="Bitcoin").xpub == xpub
+
+    # a new session with another passphrase must not see the cached key
+    client.use_passphrase("TREZOR")
+    client.init_device(new_session=True)
+    hidden = btc.get_public_node(client, path, coin_name="Bitcoin").xpub
+    assert hidden != xpub
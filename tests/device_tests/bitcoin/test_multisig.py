@@ -81,27 +81,28 @@ def test_2_of_3(client: Client):
         script_type=messages.OutputScriptType.PAYTOADDRESS,
     )
 
-    # Expected responses are the same for both two signings
     tt = client.features.model == "T"
-    expected_responses = [
-        request_input(0),
-        request_output(0),
-        messages.ButtonRequest(code=B.ConfirmOutput),
-        (tt, messages.ButtonRequest(code=B.ConfirmOutput)),
-        messages.ButtonRequest(code=B.SignTx),
-        (tt, messages.ButtonRequest(code=B.SignTx)),
-        request_input(0),
-        request_meta(TXHASH_6b07c1),
-        request_input(0, TXHASH_6b07c1),
-        request_output(0, TXHASH_6b07c1),
-        request_input(0),
-        request_output(0),
-        request_output(0),
-        request_finished(),
-    ]
+
+    def expected_responses(prev_tx_requested: bool):
+        return [
+            request_input(0),
+            request_output(0),
+            messages.ButtonRequest(code=B.ConfirmOutput),
+            (tt, messages.ButtonRequest(code=B.ConfirmOutput)),
+            messages.ButtonRequest(code=B.SignTx),
+            (tt, messages.ButtonRequest(code=B.SignTx)),
+            request_input(0),
+            (prev_tx_requested, request_meta(TXHASH_6b07c1)),
+            (prev_tx_requested, request_input(0, TXHASH_6b07c1)),
+            (prev_tx_requested, request_output(0, TXHASH_6b07c1)),
+            request_input(0),
+            request_output(0),
+            request_output(0),
+            request_finished(),
+        ]
 
     with client:
-        client.set_expected_responses(expected_responses)
+        client.set_expected_responses(expected_responses(True))
 
         # Now we have first signature
         signatures1, _ = btc.sign_tx(
@@ -137,8 +138,10 @@ def test_2_of_3(client: Client):
         multisig=multisig,
     )
 
+    # The T1 remembers the previous output verified in the first signing, as
+    # the redeem script and so the scriptPubKey are the same.
     with client:
-        client.set_expected_responses(expected_responses)
+        client.set_expected_responses(expected_responses(tt))
         signatures2, serialized_tx = btc.sign_tx(
             client, "Testnet", [inp3], [out1], prev_txes=TX_API_TESTNET
         )
@@ -147,6 +150,8 @@ def test_2_of_3(client: Client):
         signatures2[0].hex()
         == "304502210089153ad97c0d69656cd9bd9eb2056552acaec91365dd7ab31250f3f707123baa02200f884de63041d73bd20fbe8804c6036968d8149b7f46963a82b561cd8211ab08"
     )
+    if not tt:
+        assert client.debug.state().signing_prevtxs_reused == 1
 
     assert_tx_matches(
         serialized_tx,
@@ -136,6 +136,114 @@ def test_one_one_fee(client: Client):
     )
 
 
+@pytest.mark.skip_t2
+def test_one_one_fee_resubmit(client: Client):
+    # The previous transaction was verified when the first transaction was
+    # signed and is not requested again when it is resubmitted with a higher
+    # fee.
+    inp1 = messages.TxInputType(
+        address_n=parse_path("m/44h/0h/5h/0/9"),  # 1H2CRJBrDMhkvCGZMW7T4oQwYbL8eVuh7p
+        amount=63_988,
+        prev_hash=TXHASH_0dac36,
+        prev_index=0,
+    )
+
+    for amount, prev_tx_requests in (
+        (
+            50_248,
+            [
+                request_meta(TXHASH_0dac36),
+                request_input(0, TXHASH_0dac36),
+                request_output(0, TXHASH_0dac36),
+                request_output(1, TXHASH_0dac36),
+            ],
+        ),
+        (50_000, []),
+    ):
+        out1 = messages.TxOutputType(
+            address="13Hbso8zgV5Wmqn3uA7h3QVtmPzs47wcJ7",
+            amount=amount,
+            script_type=messages.OutputScriptType.PAYTOADDRESS,
+        )
+
+        with client:
+            client.set_expected_responses(
+                [
+                    request_input(0),
+                    request_output(0),
+                    messages.ButtonRequest(code=B.ConfirmOutput),
+                    messages.ButtonRequest(code=B.SignTx),
+                    request_input(0),
+                    *prev_tx_requests,
+                    request_input(0),
+                    request_output(0),
+                    request_output(0),
+                    request_finished(),
+                ]
+            )
+            btc.sign_tx(client, "Bitcoin", [inp1], [out1], prev_txes=TX_CACHE_MAINNET)
+
+    assert client.debug.state().signing_prevtxs_reused == 1
+
+    # A different amount of the same outpoint is verified again.
+    inp1.amount = 63_989
+    with pytest.raises(TrezorFailure, match="Invalid amount specified"):
+        btc.sign_tx(client, "Bitcoin", [inp1], [out1], prev_txes=TX_CACHE_MAINNET)
+
+
+@pytest.mark.skip_t2
+def test_prevtx_cache_session(client: Client):
+    # The same transaction is signed three times. The second signing reuses
+    # the previous output verified by the first one, ending the session
+    # forgets it again.
+    inp1 = messages.TxInputType(
+        address_n=parse_path("m/44h/0h/5h/0/9"),  # 1H2CRJBrDMhkvCGZMW7T4oQwYbL8eVuh7p
+        amount=63_988,
+        prev_hash=TXHASH_0dac36,
+        prev_index=0,
+    )
+    out1 = messages.TxOutputType(
+        address="13Hbso8zgV5Wmqn3uA7h3QVtmPzs47wcJ7",
+        amount=50_248,
+        script_type=messages.OutputScriptType.PAYTOADDRESS,
+    )
+
+    def sign(prev_tx_requested: bool) -> bytes:
+        with client:
+            client.set_expected_responses(
+                [
+                    request_input(0),
+                    request_output(0),
+                    messages.ButtonRequest(code=B.ConfirmOutput),
+                    messages.ButtonRequest(code=B.SignTx),
+                    request_input(0),
+                    (prev_tx_requested, request_meta(TXHASH_0dac36)),
+                    (prev_tx_requested, request_input(0, TXHASH_0dac36)),
+                    (prev_tx_requested, request_output(0, TXHASH_0dac36)),
+                    (prev_tx_requested, request_output(1, TXHASH_0dac36)),
+                    request_input(0),
+                    request_output(0),
+                    request_output(0),
+                    request_finished(),
+                ]
+            )
+            _, serialized_tx = btc.sign_tx(
+                client, "Bitcoin", [inp1], [out1], prev_txes=TX_CACHE_MAINNET
+            )
+        return serialized_tx
+
+    first = sign(prev_tx_requested=True)
+    assert client.debug.state().signing_prevtxs_reused == 0
+
+    assert sign(prev_tx_requested=False) == first
+    assert client.debug.state().signing_prevtxs_reused == 1
+
+    client.end_session()
+    client.init_device()
+    assert sign(prev_tx_requested=True) == first
+    assert client.debug.state().signing_prevtxs_reused == 0
+
+
 def test_testnet_one_two_fee(client: Client):
     # input tx: e5040e1bc1ae7667ffb9e5248e90b2fb93cd9150234151ce90e14ab2f5933bcd
 
@@ -435,9 +435,13 @@ def test_attack_mixed_inputs(client: Client):
     inp2.amount = FAKE_AMOUNT
 
     if client.features.model == "1":
-        # T1 fails as soon as it encounters the fake amount.
+        # T1 fails as soon as it encounters the fake amount. It remembers the
+        # unchanged first previous output from the first signing.
         expected_responses = (
-            expected_responses[:4] + expected_responses[5:15] + [messages.Failure()]
+            expected_responses[:4]
+            + expected_responses[5:9]
+            + expected_responses[13:15]
+            + [messages.Failure()]
         )
     else:
         expected_responses = (
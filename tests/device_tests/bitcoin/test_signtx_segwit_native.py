@@ -116,6 +116,60 @@ def test_send_p2sh(client: Client):
     )
 
 
+class AddressPollingClient:
+    """Asks for an unrelated address before every TxAck, like a wallet
+    refreshing its receive address while a transaction is being signed."""
+
+    def __init__(self, client: Client) -> None:
+        self.client = client
+        self.polls = 0
+
+    def __getattr__(self, name):
+        return getattr(self.client, name)
+
+    def call(self, msg):
+        if isinstance(msg, messages.TxAck):
+            btc.get_address(self.client, "Testnet", parse_path("m/84h/1h/0h/0/5"))
+            self.polls += 1
+        return self.client.call(msg)
+
+
+@pytest.mark.skip_t2
+def test_send_p2sh_get_address_between_acks(client: Client):
+    # Same transaction as test_send_p2sh. The key derived for the input in the
+    # first phase must not be reused for signing once GetAddress derived
+    # another one in between.
+    inp1 = messages.TxInputType(
+        address_n=parse_path("m/49h/1h/0h/1/0"),
+        # 2N1LGaGg836mqSQqiuUBLfcyGBhyZbremDX
+        amount=123_456_789,
+        prev_hash=TXHASH_20912f,
+        prev_index=0,
+        script_type=messages.InputScriptType.SPENDP2SHWITNESS,
+    )
+    out1 = messages.TxOutputType(
+        address="tb1qqzv60m9ajw8drqulta4ld4gfx0rdh82un5s65s",
+        amount=12_300_000,
+        script_type=messages.OutputScriptType.PAYTOADDRESS,
+    )
+    out2 = messages.TxOutputType(
+        address="2N1LGaGg836mqSQqiuUBLfcyGBhyZbremDX",
+        script_type=messages.OutputScriptType.PAYTOADDRESS,
+        amount=123_456_789 - 11_000 - 12_300_000,
+    )
+    polling = AddressPollingClient(client)
+    _, serialized_tx = btc.sign_tx(
+        polling, "Testnet", [inp1], [out1, out2], prev_txes=TX_API_TESTNET
+    )
+
+    assert polling.polls > 0
+    assert_tx_matches(
+        serialized_tx,
+        hash_link="https://tbtc1.trezor.io/api/tx/09144602765ce3dd8f4329445b20e3684e948709c5cdcaf12da3bb079c99448a",
+        tx_hex="0100000000010137c361fb8f2d9056ba8c98c5611930fcb48cacfdd0fe2e0449d83eea982f91200000000017160014d16b8c0680c61fc6ed2e407455715055e41052f5ffffffff02e0aebb00000000001600140099a7ecbd938ed1839f5f6bf6d50933c6db9d5c3df39f060000000017a91458b53ea7f832e8f096e896b8713a8c6df0e892ca8702483045022100bd3d8b8ad35c094e01f6282277300e575f1021678fc63ec3f9945d6e35670da3022052e26ef0dd5f3741c9d5939d1dec5464c15ab5f2c85245e70a622df250d4eb7c012103e7bfe10708f715e8538c92d46ca50db6f657bbc455b7494e6a0303ccdb868b7900000000",
+    )
+
+
 def test_send_p2sh_change(client: Client):
     # input tx: 20912f98ea3ed849042efed0fdac8cb4fc301961c5988cba56902d8ffb61c337
 
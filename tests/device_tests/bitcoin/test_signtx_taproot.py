@@ -60,6 +60,9 @@ TXHASH_ec5194 = bytes.fromhex(
 TXHASH_c96621 = bytes.fromhex(
     "c96621a96668f7dd505c4deb9ee2b2038503a5daa4888242560e9b640cca8819"
 )
+TXHASH_1010b2 = bytes.fromhex(
+    "1010b25957a30110377a33bd3b0bd39045b3cc488d0e534d1ea5ec238812c0fc"
+)
 
 
 def test_send_p2tr(client: Client):
@@ -165,6 +168,61 @@ def test_send_two_with_change(client: Client):
     )
 
 
+def test_send_two_same_path(client: Client):
+    # Signing tweaks the key in the secure element, the second input must not
+    # be signed with the key left tweaked by the first one.
+    inp1 = messages.TxInputType(
+        # tb1pswrqtykue8r89t9u4rprjs0gt4qzkdfuursfnvqaa3f2yql07zmq8s8a5u
+        address_n=parse_path("m/86h/1h/0h/0/0"),
+        amount=6_800,
+        prev_hash=TXHASH_c96621,
+        prev_index=0,
+        script_type=messages.InputScriptType.SPENDTAPROOT,
+    )
+    inp2 = messages.TxInputType(
+        # tb1pswrqtykue8r89t9u4rprjs0gt4qzkdfuursfnvqaa3f2yql07zmq8s8a5u
+        address_n=parse_path("m/86h/1h/0h/0/0"),
+        amount=6_800,
+        prev_hash=TXHASH_1010b2,
+        prev_index=0,
+        script_type=messages.InputScriptType.SPENDTAPROOT,
+    )
+    out1 = messages.TxOutputType(
+        # 84'/1'/1'/0/0
+        address="tb1q7r9yvcdgcl6wmtta58yxf29a8kc96jkyxl7y88",
+        amount=6_800 + 6_800 - 200,
+        script_type=messages.OutputScriptType.PAYTOADDRESS,
+    )
+    with client:
+        tt = client.features.model == "T"
+        client.set_expected_responses(
+            [
+                request_input(0),
+                request_input(1),
+                request_output(0),
+                messages.ButtonRequest(code=B.ConfirmOutput),
+                (tt, messages.ButtonRequest(code=B.ConfirmOutput)),
+                messages.ButtonRequest(code=B.SignTx),
+                (tt, messages.ButtonRequest(code=B.SignTx)),
+                request_input(0),
+                request_input(1),
+                request_output(0),
+                request_input(0),
+                request_input(1),
+                request_finished(),
+            ]
+        )
+        _, serialized_tx = btc.sign_tx(
+            client, "Testnet", [inp1, inp2], [out1], prev_txes=TX_API
+        )
+
+    assert_tx_matches(
+        serialized_tx,
+        hash_link="https://tbtc1.trezor.io/api/tx/6167ee6870175254b09a44fedb41b9346ac1f431a8c5a2137c652e1e14f53a37",
+        tx_hex="010000000001021988ca0c649b0e56428288a4daa5038503b2e29eeb4d5c50ddf76866a92166c90000000000fffffffffcc0128823eca51e4d530e8d48ccb34590d30b3bbd337a371001a35759b210100000000000ffffffff015834000000000000160014f0ca4661a8c7f4edad7da1c864a8bd3db05d4ac40140464cb5b0356ebf303532139bb920cfa1dcb73f609ba4e836e746956420dee6116ace7745c215788490d59acadb04889787f94f135e24faba4f90d502257688090140a546c1653536fcd0b0fefb5f87ca47ec43b24c1eeb12dfcbc19cc2a0f48e1ce8e1771715ac62f747cf2cb20e73787d1f95f23797b113e4aa2cb8ebad0fd20ba000000000",
+    )
+
+
 def test_send_mixed(client: Client):
     inp1 = messages.TxInputType(
         # 2MutHjgAXkqo3jxX2DZWorLAckAnwTxSM9V
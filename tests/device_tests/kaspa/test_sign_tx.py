@@ -0,0 +1,204 @@
+# This file is part of the Trezor project.
+#
+# Copyright (C) 2012-2022 SatoshiLabs and contributors
+#
+# This library is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License version 3
+# as published by the Free Software Foundation.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the License along with this library.
+# If not, see <https://www.gnu.org/licenses/lgpl-3.0.html>.
+
+import hashlib
+from typing import List
+
+import pytest
+
+from trezorlib import kaspa, messages
+from trezorlib.debuglink import TrezorClientDebugLink as Client
+from trezorlib.exceptions import TrezorFailure
+from trezorlib.tools import parse_path
+
+pytestmark = [
+    pytest.mark.altcoin,
+    pytest.mark.kaspa,
+    pytest.mark.skip_t2,
+]
+
+# ecdsa signatures are deterministic, so the device computed sighashes can be
+# compared with the ones built here and signed with the old KaspaSignTx flow
+SCHEMA = "ecdsa"
+PATH = parse_path("m/44h/111111h/0h/0/0")
+PATH_CHANGE = parse_path("m/44h/111111h/0h/0/1")
+CHARSET = "qpzry9x8gf2tvdw0s3jn54khce6mua7l"
+
+PREV_HASH_1 = bytes.fromhex(
+    "b9dfbd7cd04fbe5c6e7e98bb27a3e2d11c3a6b4e1fa4e2b4e1d6f9e0c3a2b1a0"
+)
+PREV_HASH_2 = bytes.fromhex(
+    "0aa1b2c3d4e5f60718293a4b5c6d7e8f90a1b2c3d4e5f60718293a4b5c6d7e8f"
+)
+
+
+def signing_hash(data: bytes) -> bytes:
+    return hashlib.blake2b(data, digest_size=32, key=b"TransactionSigningHash").digest()
+
+
+def le(value: int, size: int) -> bytes:
+    return value.to_bytes(size, "little")
+
+
+def address_to_script(address: str) -> bytes:
+    data = [CHARSET.index(c) for c in address.split(":")[1][:-8]]
+    acc, bits, payload = 0, 0, bytearray()
+    for d in data:
+        acc = (acc << 5) | d
+        bits += 5
+        if bits >= 8:
+            bits -= 8
+            payload.append((acc >> bits) & 0xFF)
+    assert payload[0] == 1 and len(payload) == 34
+    # OP_DATA_33 <key> OP_CHECKSIGECDSA
+    return b"\x21" + bytes(payload[1:]) + b"\xab"
+
+
+def script_public_key(script: bytes) -> bytes:
+    return le(0, 2) + le(len(script), 8) + script
+
+
+def sighash_preimages(
+    inputs: List[messages.KaspaTxAckInput],
+    outputs: List[messages.KaspaTxAckOutput],
+    input_script: bytes,
+) -> List[bytes]:
+    prev_outputs = signing_hash(
+        b"".join(i.prev_hash + le(i.prev_index, 4) for i in inputs)
+    )
+    sequences = signing_hash(b"".join(le(i.sequence or 0, 8) for i in inputs))
+    sig_op_counts = signing_hash(b"".join(le(i.sig_op_count or 1, 1) for i in inputs))
+    outputs_hash = signing_hash(
+        b"".join(
+            le(o.amount, 8) + script_public_key(address_to_script(o.address))
+            for o in outputs
+        )
+    )
+    preimages = []
+    for i in inputs:
+        preimages.append(
+            le(0, 2)
+            + prev_outputs
+            + sequences
+            + sig_op_counts
+            + i.prev_hash
+            + le(i.prev_index, 4)
+            + script_public_key(input_script)
+            + le(i.amount, 8)
+            + le(i.sequence or 0, 8)
+            + le(i.sig_op_count or 1, 1)
+            + outputs_hash
+            + le(0, 8)  # lock time
+            + bytes(20)  # native subnetwork
+            + bytes(8)  # gas
+            + bytes(32)  # payload hash
+            + b"\x01"  # SIGHASH_ALL
+        )
+    return preimages
+
+
+def make_tx(client: Client):
+    inputs = [
+        messages.KaspaTxAckInput(
+            address_n=PATH, prev_hash=PREV_HASH_1, prev_index=0, amount=150_000_000
+        ),
+        messages.KaspaTxAckInput(
+            address_n=PATH, prev_hash=PREV_HASH_2, prev_index=3, amount=50_000_000
+        ),
+    ]
+    destination = kaspa.get_address(client, PATH_CHANGE, address_schema=SCHEMA)
+    outputs = [
+        messages.KaspaTxAckOutput(amount=120_000_000, address=destination),
+        messages.KaspaTxAckOutput(
+            amount=79_990_000,
+            address=kaspa.get_address(client, PATH, address_schema=SCHEMA),
+        ),
+    ]
+    return inputs, outputs
+
+
+def test_sign_tx(client: Client):
+    inputs, outputs = make_tx(client)
+    signatures = kaspa.sign_transaction(client, inputs, outputs, schema=SCHEMA)
+    assert len(signatures) == 2
+
+    # the same sighashes built on the host and signed one by one
+    script = address_to_script(kaspa.get_address(client, PATH, address_schema=SCHEMA))
+    preimages = sighash_preimages(inputs, outputs, script)
+    expected = kaspa.sign_tx(
+        client, [PATH], "-".join(p.hex() for p in preimages), schema=SCHEMA
+    )
+    assert signatures == expected
+    assert signatures[0] != signatures[1]
+
+
+def test_invalid_counts(client: Client):
+    inputs, outputs = make_tx(client)
+    with pytest.raises(TrezorFailure, match="Invalid input count"):
+        kaspa.sign_transaction(client, [], outputs, schema=SCHEMA)
+    with pytest.raises(TrezorFailure, match="Invalid output count"):
+        kaspa.sign_transaction(client, inputs, [], schema=SCHEMA)
+
+
+def test_input_instead_of_output(client: Client):
+    inputs, outputs = make_tx(client)
+    # an input sent where the device asks for an output aborts the signing
+    with pytest.raises(TrezorFailure, match="Not in Kaspa signing mode"):
+        kaspa.sign_transaction(client, inputs, [inputs[0]], schema=SCHEMA)
+
+    # so does an input more than was declared
+    resp = client.call(
+        messages.KaspaSignTxInit(
+            inputs_count=1, outputs_count=len(outputs), schema=SCHEMA
+        )
+    )
+    assert resp.request_type == messages.KaspaRequestType.TXINPUT
+    resp = client.call(inputs[0])
+    assert resp.request_type == messages.KaspaRequestType.TXOUTPUT
+    with pytest.raises(TrezorFailure, match="Not in Kaspa signing mode"):
+        client.call(inputs[1])
+
+    # nothing is left of the aborted session
+    with pytest.raises(TrezorFailure, match="Not in Kaspa signing mode"):
+        client.call(outputs[0])
+
+
+def test_amount_changed_during_signing(client: Client):
+    inputs, outputs = make_tx(client)
+    inputs = inputs[:1]
+    outputs = [
+        messages.KaspaTxAckOutput(amount=149_990_000, address=outputs[0].address)
+    ]
+    changed = messages.KaspaTxAckInput(
+        address_n=PATH,
+        prev_hash=inputs[0].prev_hash,
+        prev_index=inputs[0].prev_index,
+        amount=inputs[0].amount + 1,
+    )
+
+    resp = client.call(
+        messages.KaspaSignTxInit(inputs_count=1, outputs_count=1, schema=SCHEMA)
+    )
+    assert resp.request_type == messages.KaspaRequestType.TXINPUT
+    resp = client.call(inputs[0])
+    assert resp.request_type == messages.KaspaRequestType.TXOUTPUT
+    # the user confirms the output and a fee of 0.0001 KAS
+    resp = client.call(outputs[0])
+    assert resp.request_type == messages.KaspaRequestType.TXINPUT
+    assert resp.request_index == 0
+    # and the input is worth more when it is sent to be signed
+    with pytest.raises(TrezorFailure, match="Transaction has changed during signing"):
+        client.call(changed)
@@ -16,7 +16,7 @@
 
 import pytest
 
-from trezorlib import debuglink, device, messages, misc
+from trezorlib import btc, debuglink, device, messages, misc
 from trezorlib.debuglink import TrezorClientDebugLink as Client
 from trezorlib.tools import parse_path
 from trezorlib.transport import udp
@@ -56,6 +56,40 @@ def test_pin(client: Client):
     assert isinstance(resp, messages.Address)
 
 
+@pytest.mark.skip_t2
+@pytest.mark.setup_client(mnemonic=MNEMONIC12)
+def test_profile(client: Client):
+    client.ensure_unlocked()
+    client.debug.get_profile(reset=True)
+    btc.get_address(client, "Bitcoin", parse_path("m/44h/0h/0h/0/0"))
+
+    profile = client.debug.get_profile(reset=True)
+    assert not profile.more
+    entries = {
+        e.section: e
+        for e in profile.entries
+        if e.message_type == messages.MessageType.GetAddress
+    }
+    for section in (
+        messages.DebugLinkProfileSection.DECODE,
+        messages.DebugLinkProfileSection.ENCODE,
+        messages.DebugLinkProfileSection.HASH,
+    ):
+        assert section in entries
+    for e in entries.values():
+        assert e.count > 0
+        assert sum(e.histogram) == e.count
+        assert len(e.histogram) <= 16
+        if profile.cycles_per_us:
+            assert 0 < e.max_cycles <= e.total_cycles
+
+    # the histograms were cleared by the previous read
+    profile = client.debug.get_profile()
+    assert all(
+        e.message_type != messages.MessageType.GetAddress for e in profile.entries
+    )
+
+
 @pytest.mark.skip_t1
 def test_softlock_instability(client: Client):
     def load_device():
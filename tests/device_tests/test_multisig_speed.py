@@ -0,0 +1,82 @@
+# This file is part of the Trezor project.
+#
+# Copyright (C) 2012-2019 SatoshiLabs and contributors
+#
+# This library is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License version 3
+# as published by the Free Software Foundation.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the License along with this library.
+# If not, see <https://www.gnu.org/licenses/lgpl-3.0.html>.
+
+
+import time
+
+import pytest
+
+from trezorlib import btc, device, messages
+from trezorlib.debuglink import TrezorClientDebugLink as Client
+from trezorlib.messages import SafetyCheckLevel
+from trezorlib.tools import parse_path
+
+pytestmark = [
+    pytest.mark.skip_t2,
+    pytest.mark.multisig,
+    pytest.mark.flaky(max_runs=5),
+]
+
+COSIGNERS = 15
+ADDRESSES = 10
+
+
+def _multisig(nodes, address_n) -> messages.MultisigRedeemScriptType:
+    return messages.MultisigRedeemScriptType(
+        nodes=nodes,
+        signatures=[b""] * COSIGNERS,
+        address_n=address_n,
+        m=COSIGNERS,
+    )
+
+
+def _get_addresses(client: Client, multisigs) -> float:
+    start = time.time()
+    for multisig in multisigs:
+        btc.get_address(
+            client,
+            "Bitcoin",
+            parse_path("m/48h/0h/0h/2h") + multisig.address_n,
+            multisig=multisig,
+            script_type=messages.InputScriptType.SPENDWITNESS,
+        )
+    return time.time() - start
+
+
+def test_cosigner_cache(client: Client):
+    # disable safety checks to access non-standard paths
+    device.apply_settings(client, safety_checks=SafetyCheckLevel.PromptTemporarily)
+
+    nodes = [
+        btc.get_public_node(
+            client, parse_path(f"m/48h/0h/{i}h/2h"), coin_name="Bitcoin"
+        ).node
+        for i in range(COSIGNERS)
+    ]
+
+    # every address on a new branch, nothing to reuse across addresses
+    nocache = [_multisig(nodes, [x, 0]) for x in range(1, ADDRESSES + 1)]
+    # the same branch for all addresses, like the inputs of a transaction
+    cache = [_multisig(nodes, [0, x]) for x in range(ADDRESSES)]
+
+    nocache_time = _get_addresses(client, nocache)
+    cache_time = _get_addresses(client, cache)
+    print("COSIGNERS", COSIGNERS, "ADDRESSES", ADDRESSES)
+    print("NOCACHE TIME", nocache_time)
+    print("CACHED TIME", cache_time)
+
+    # one public derivation per cosigner instead of two
+    assert cache_time <= nocache_time * 0.75
@@ -0,0 +1,80 @@
+# This file is part of the Trezor project.
+#
+# Copyright (C) 2012-2019 SatoshiLabs and contributors
+#
+# This library is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License version 3
+# as published by the Free Software Foundation.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the License along with this library.
+# If not, see <https://www.gnu.org/licenses/lgpl-3.0.html>.
+
+import pytest
+
+from trezorlib import btc, ethereum, messages
+from trezorlib.debuglink import TrezorClientDebugLink as Client
+from trezorlib.tools import parse_path
+
+pytestmark = pytest.mark.skip_t2
+
+TOGGLES = 20
+# address QR codes are encoded as version 11
+QR_SIDE = 4 * 11 + 17
+
+
+def _show(client: Client, get_address, toggles: int):
+    def input_flow():
+        yield
+        # address -> QR code -> address ..., ending on the QR code screen
+        for _ in range(2 * toggles + 1):
+            client.debug.press_no()
+        client.debug.press_yes()
+
+    with client:
+        client.set_input_flow(input_flow)
+        get_address()
+
+
+def _check(client: Client, get_address):
+    _show(client, get_address, TOGGLES)
+    state = client.debug.state()
+
+    # the QR code was encoded once and drawn a column at a time, every
+    # further toggle was redrawn from the cache
+    assert state.address_qr_encodes == 1
+    assert state.address_qr_columns == QR_SIDE
+
+    # a new address dialog starts over
+    _show(client, get_address, 0)
+    state = client.debug.state()
+    assert state.address_qr_encodes == 1
+    assert state.address_qr_columns == QR_SIDE
+
+
+def test_qrcode_bech32m(client: Client):
+    def get_address():
+        return btc.get_address(
+            client,
+            "Bitcoin",
+            parse_path("m/86h/0h/0h/0/0"),
+            script_type=messages.InputScriptType.SPENDTAPROOT,
+            show_display=True,
+        )
+
+    _check(client, get_address)
+
+
+@pytest.mark.altcoin
+@pytest.mark.ethereum
+def test_qrcode_ethereum(client: Client):
+    def get_address():
+        return ethereum.get_address(
+            client, parse_path("m/44h/60h/0h/0/0"), show_display=True
+        )
+
+    _check(client, get_address)
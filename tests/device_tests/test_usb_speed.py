@@ -0,0 +1,57 @@
+# This file is part of the Trezor project.
+#
+# Copyright (C) 2012-2019 SatoshiLabs and contributors
+#
+# This library is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License version 3
+# as published by the Free Software Foundation.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the License along with this library.
+# If not, see <https://www.gnu.org/licenses/lgpl-3.0.html>.
+
+import time
+
+import pytest
+
+from trezorlib.debuglink import TrezorClientDebugLink as Client
+
+pytestmark = [
+    pytest.mark.skip_t2,
+    pytest.mark.flaky(max_runs=5),
+]
+
+PINGS = 50
+MESSAGE = "x" * 255
+# header, length prefixes and payload split into 64-byte reports
+PACKETS_PER_PING = 5
+
+
+def test_ping_throughput(client: Client):
+    before = client.debug.state()
+
+    start = time.time()
+    for _ in range(PINGS):
+        assert client.ping(MESSAGE) == MESSAGE
+    delay = time.time() - start
+
+    after = client.debug.state()
+    packets_out = after.usb_packets_out - before.usb_packets_out
+    packets_in = after.usb_packets_in - before.usb_packets_in
+    print(
+        "PACKETS IN",
+        packets_in,
+        "PACKETS OUT",
+        packets_out,
+        "PACKETS/S",
+        packets_out / delay,
+        "DEVICE PACKETS/S",
+        after.usb_packets_out_per_sec,
+    )
+
+    assert packets_out >= PINGS * PACKETS_PER_PING
+    assert packets_in >= PINGS * PACKETS_PER_PING
@@ -0,0 +1,45 @@
+import os
+import time
+
+from trezorlib import messages
+
+from ..emulators import EmulatorWrapper
+from ..upgrade_tests import legacy_only
+
+# seconds of waiting on the button to measure
+IDLE_TIME = 3
+# share of one host core the waiting emulator may use
+MAX_CPU_LOAD = 0.1
+
+
+def cpu_seconds(pid: int) -> float:
+    with open(f"/proc/{pid}/stat") as f:
+        # the command name in field 2 may contain spaces
+        fields = f.read().rsplit(")", 1)[1].split()
+    # utime and stime are fields 14 and 15
+    utime, stime = int(fields[11]), int(fields[12])
+    return (utime + stime) / os.sysconf("SC_CLK_TCK")
+
+
+@legacy_only
+def test_idle_cpu_waiting_for_button():
+    with EmulatorWrapper("legacy") as emu:
+        assert emu.process is not None
+        client = emu.client
+
+        resp = client.call_raw(messages.Ping(message="idle", button_protection=True))
+        assert isinstance(resp, messages.ButtonRequest)
+        client._raw_write(messages.ButtonAck())
+
+        start_cpu = cpu_seconds(emu.process.pid)
+        start = time.monotonic()
+        time.sleep(IDLE_TIME)
+        load = (cpu_seconds(emu.process.pid) - start_cpu) / (time.monotonic() - start)
+        print("CPU LOAD", load)
+
+        client.debug.press_yes()
+        resp = client._raw_read()
+        assert isinstance(resp, messages.Success)
+        assert resp.message == "idle"
+
+        assert load <= MAX_CPU_LOAD